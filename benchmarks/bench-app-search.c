@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "bench.h"
+
+#include "gtk-list-models/gtkfilterlistmodel.h"
+#include "util.h"
+
+#include <gio/gdesktopappinfo.h>
+
+/*
+ * Search over a synthetic set of apps the way the app grid does it:
+ * match single app infos and refilter a whole list model while the
+ * user types.
+ */
+
+#define N_APPS 1000
+
+static const char *words[] = {
+  "Calls", "Chats", "Clocks", "Contacts", "Calendar", "Camera", "Maps",
+  "Music", "Notes", "Photos", "Podcasts", "Settings", "Software", "Terminal",
+  "Weather", "Web", "Files", "Text", "Editor", "Viewer", "Player", "Recorder",
+  "Monitor", "Manager", "Browser", "Mail", "Feeds", "Books", "Games", "Tasks",
+};
+
+/* What gets typed into the search entry */
+static const char *search_terms[] = { "w", "we", "wea", "weat", "weath", "weathe", "weather" };
+
+typedef struct {
+  GListStore         *apps;
+  GtkFilterListModel *model;
+  const char         *search;
+} Fixture;
+
+
+static GAppInfo *
+make_app_info (guint i)
+{
+  g_autoptr (GKeyFile) keyfile = g_key_file_new ();
+  const char *word1 = words[i % G_N_ELEMENTS (words)];
+  const char *word2 = words[(i / G_N_ELEMENTS (words)) % G_N_ELEMENTS (words)];
+  g_autofree char *name = g_strdup_printf ("%s %s %u", word1, word2, i);
+  g_autofree char *comment = g_strdup_printf ("A %s for %s", word2, word1);
+  const char *keywords[] = { word1, word2, "phone", "mobile" };
+
+  g_key_file_set_string (keyfile, G_KEY_FILE_DESKTOP_GROUP, G_KEY_FILE_DESKTOP_KEY_TYPE,
+                         G_KEY_FILE_DESKTOP_TYPE_APPLICATION);
+  g_key_file_set_string (keyfile, G_KEY_FILE_DESKTOP_GROUP, G_KEY_FILE_DESKTOP_KEY_EXEC, "true");
+  g_key_file_set_string (keyfile, G_KEY_FILE_DESKTOP_GROUP, G_KEY_FILE_DESKTOP_KEY_NAME, name);
+  g_key_file_set_string (keyfile, G_KEY_FILE_DESKTOP_GROUP, G_KEY_FILE_DESKTOP_KEY_COMMENT,
+                         comment);
+  g_key_file_set_string_list (keyfile, G_KEY_FILE_DESKTOP_GROUP, "Keywords",
+                              keywords, G_N_ELEMENTS (keywords));
+
+  return G_APP_INFO (g_desktop_app_info_new_from_keyfile (keyfile));
+}
+
+
+static gboolean
+search_apps (gpointer item, gpointer data)
+{
+  Fixture *fixture = data;
+
+  if (fixture->search == NULL)
+    return TRUE;
+
+  return phosh_util_matches_app_info (G_APP_INFO (item), fixture->search);
+}
+
+
+static void
+run_matches_app_info (gpointer data)
+{
+  Fixture *fixture = data;
+
+  for (guint i = 0; i < N_APPS; i++) {
+    g_autoptr (GAppInfo) info = g_list_model_get_item (G_LIST_MODEL (fixture->apps), i);
+
+    phosh_util_matches_app_info (info, "weather");
+  }
+}
+
+
+static void
+run_refilter (gpointer data)
+{
+  Fixture *fixture = data;
+
+  for (guint i = 0; i < G_N_ELEMENTS (search_terms); i++) {
+    fixture->search = search_terms[i];
+    gtk_filter_list_model_refilter (fixture->model);
+    g_list_model_get_n_items (G_LIST_MODEL (fixture->model));
+  }
+}
+
+
+static void
+teardown_refilter (gpointer data)
+{
+  Fixture *fixture = data;
+
+  fixture->search = NULL;
+  gtk_filter_list_model_refilter (fixture->model);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  Fixture fixture = { 0 };
+  const PhoshBench benches[] = {
+    { "app-search/matches-app-info", N_APPS, NULL, run_matches_app_info, NULL },
+    { "app-search/refilter", N_APPS * G_N_ELEMENTS (search_terms),
+      NULL, run_refilter, teardown_refilter },
+  };
+
+  phosh_bench_init (&argc, &argv);
+
+  fixture.apps = g_list_store_new (G_TYPE_APP_INFO);
+  for (guint i = 0; i < N_APPS; i++) {
+    g_autoptr (GAppInfo) info = make_app_info (i);
+
+    g_list_store_append (fixture.apps, info);
+  }
+  fixture.model = gtk_filter_list_model_new (G_LIST_MODEL (fixture.apps),
+                                             search_apps,
+                                             &fixture,
+                                             NULL);
+
+  for (guint i = 0; i < G_N_ELEMENTS (benches); i++)
+    phosh_bench_run (&benches[i], &fixture);
+
+  g_object_unref (fixture.model);
+  g_object_unref (fixture.apps);
+
+  return 0;
+}
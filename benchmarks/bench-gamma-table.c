@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "bench.h"
+
+#include "monitor/gamma-table.h"
+
+/*
+ * Fill gamma tables as done on every night light temperature step.
+ */
+
+#define N_STEPS 100
+
+typedef struct {
+  guint32  ramp_size;
+  guint16 *table;
+} Fixture;
+
+
+static void
+run_fill (gpointer data)
+{
+  Fixture *fixture = data;
+
+  /* Sweep the range night light covers */
+  for (guint i = 0; i < N_STEPS; i++)
+    phosh_gamma_table_fill (fixture->table, fixture->ramp_size, 6500 - i * 30);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  const guint32 ramp_sizes[] = { 256, 1024, 4096 };
+
+  phosh_bench_init (&argc, &argv);
+
+  for (guint i = 0; i < G_N_ELEMENTS (ramp_sizes); i++) {
+    g_autofree char *name = g_strdup_printf ("gamma-table/fill-%u", ramp_sizes[i]);
+    g_autofree guint16 *table = g_new (guint16, ramp_sizes[i] * 3);
+    Fixture fixture = { ramp_sizes[i], table };
+    PhoshBench bench = { name, N_STEPS, NULL, run_fill, NULL };
+
+    phosh_bench_run (&bench, &fixture);
+  }
+
+  return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "bench.h"
+
+#include "notifications/notification-list.h"
+
+/*
+ * Notification storms: many notifications from a few chatty apps
+ * and a long tail of sources sending a single notification.
+ */
+
+#define N_NOTIFICATIONS 2000
+#define N_SOURCES 50
+
+typedef struct {
+  PhoshNotificationList *list;
+  PhoshNotification     *notifications[N_NOTIFICATIONS];
+  char                  *source_ids[N_NOTIFICATIONS];
+} Fixture;
+
+
+static void
+setup_storm (gpointer data)
+{
+  Fixture *fixture = data;
+  g_autoptr (GDateTime) now = g_date_time_new_now_local ();
+
+  fixture->list = phosh_notification_list_new ();
+
+  for (guint i = 0; i < N_NOTIFICATIONS; i++) {
+    g_autofree char *summary = g_strdup_printf ("Message %u", i);
+    /* Half of the notifications come from three sources */
+    guint source = (i % 2) ? i % 3 : i % N_SOURCES;
+
+    fixture->source_ids[i] = g_strdup_printf ("org.example.App%u", source);
+    fixture->notifications[i] = phosh_notification_new (i + 1,
+                                                        NULL,
+                                                        NULL,
+                                                        summary,
+                                                        "Lorem ipsum dolor sit amet",
+                                                        NULL,
+                                                        NULL,
+                                                        PHOSH_NOTIFICATION_URGENCY_NORMAL,
+                                                        NULL,
+                                                        FALSE,
+                                                        FALSE,
+                                                        "im.received",
+                                                        NULL,
+                                                        now);
+  }
+}
+
+
+static void
+run_storm (gpointer data)
+{
+  Fixture *fixture = data;
+
+  for (guint i = 0; i < N_NOTIFICATIONS; i++)
+    phosh_notification_list_add (fixture->list, fixture->source_ids[i], fixture->notifications[i]);
+}
+
+
+static void
+teardown_storm (gpointer data)
+{
+  Fixture *fixture = data;
+
+  g_clear_object (&fixture->list);
+  for (guint i = 0; i < N_NOTIFICATIONS; i++) {
+    g_clear_object (&fixture->notifications[i]);
+    g_clear_pointer (&fixture->source_ids[i], g_free);
+  }
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  Fixture fixture = { 0 };
+  const PhoshBench bench = {
+    "notification-list/add-storm", N_NOTIFICATIONS, setup_storm, run_storm, teardown_storm
+  };
+
+  phosh_bench_init (&argc, &argv);
+
+  phosh_bench_run (&bench, &fixture);
+
+  return 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "bench.h"
+
+#include "screenshot-manager-priv.h"
+
+/*
+ * Compose the per monitor frames into a single screenshot like the
+ * screenshot manager does once all frames arrived: A portrait phone
+ * panel at scale 2 that is rotated to landscape and an external
+ * monitor at scale 1 next to it.
+ */
+
+typedef struct {
+  PhoshScreenshotFrame frames[2];
+  int                  width, height;
+  float                max_scale;
+} Fixture;
+
+
+static GdkPixbuf *
+make_frame_pixbuf (int width, int height)
+{
+  GdkPixbuf *pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, TRUE, 8, width, height);
+
+  gdk_pixbuf_fill (pixbuf, 0x3465a4ff);
+  return pixbuf;
+}
+
+
+static void
+run_composite (gpointer data)
+{
+  Fixture *fixture = data;
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+
+  pixbuf = phosh_screenshot_manager_composite (fixture->frames,
+                                               G_N_ELEMENTS (fixture->frames),
+                                               fixture->width,
+                                               fixture->height,
+                                               fixture->max_scale);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  Fixture fixture = {
+    .frames = {
+      /* 720x1440 panel, rotated to landscape at scale 2 */
+      { NULL, { 0, 0, 720, 360 }, 2.0, GDK_PIXBUF_ROTATE_CLOCKWISE },
+      /* 1920x1080 external monitor at scale 1 */
+      { NULL, { 720, 0, 1920, 1080 }, 1.0, GDK_PIXBUF_ROTATE_NONE },
+    },
+    .width = 720 + 1920,
+    .height = 1080,
+    .max_scale = 2.0,
+  };
+  const PhoshBench bench = { "screenshot/composite", 1, NULL, run_composite, NULL };
+
+  phosh_bench_init (&argc, &argv);
+
+  fixture.frames[0].pixbuf = make_frame_pixbuf (720, 1440);
+  fixture.frames[1].pixbuf = make_frame_pixbuf (1920, 1080);
+
+  phosh_bench_run (&bench, &fixture);
+
+  for (guint i = 0; i < G_N_ELEMENTS (fixture.frames); i++)
+    g_object_unref (fixture.frames[i].pixbuf);
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "bench.h"
+
+#include "search/search-result-batch.h"
+#include "search/search-result-meta.h"
+
+/*
+ * Deserialise search results as received from the search daemon in
+ * both the dict and the batch format.
+ */
+
+#define N_RESULTS 500
+
+typedef struct {
+  GPtrArray *results;
+  GPtrArray *base;
+  GVariant  *dicts;
+  GBytes    *full;
+  GBytes    *diff;
+} Fixture;
+
+
+static GPtrArray *
+make_results (guint start, guint n)
+{
+  GPtrArray *results = g_ptr_array_new_with_free_func ((GDestroyNotify) phosh_search_result_meta_unref);
+  g_autoptr (GIcon) icon = g_themed_icon_new ("text-x-generic");
+
+  for (guint i = start; i < start + n; i++) {
+    g_autofree char *id = g_strdup_printf ("file:///home/user/Documents/report-%u.odt", i);
+    g_autofree char *title = g_strdup_printf ("report-%u.odt", i);
+
+    g_ptr_array_add (results, phosh_search_result_meta_new (id, title, "~/Documents", icon, NULL));
+  }
+
+  return results;
+}
+
+
+static void
+run_deserialise (gpointer data)
+{
+  Fixture *fixture = data;
+  GVariantIter iter;
+  GVariant *child;
+
+  g_variant_iter_init (&iter, fixture->dicts);
+  while ((child = g_variant_iter_next_value (&iter))) {
+    phosh_search_result_meta_unref (phosh_search_result_meta_deserialise (child));
+    g_variant_unref (child);
+  }
+}
+
+
+static void
+run_decode_full (gpointer data)
+{
+  Fixture *fixture = data;
+  g_autoptr (GPtrArray) decoded = NULL;
+  g_autoptr (GError) err = NULL;
+  guint serial;
+
+  decoded = phosh_search_result_batch_decode (fixture->full, NULL, 0, &serial, &err);
+  g_assert_no_error (err);
+}
+
+
+static void
+run_decode_diff (gpointer data)
+{
+  Fixture *fixture = data;
+  g_autoptr (GPtrArray) decoded = NULL;
+  g_autoptr (GError) err = NULL;
+  guint serial;
+
+  decoded = phosh_search_result_batch_decode (fixture->diff, fixture->base, 1, &serial, &err);
+  g_assert_no_error (err);
+}
+
+
+static void
+run_encode_full (gpointer data)
+{
+  Fixture *fixture = data;
+
+  g_bytes_unref (phosh_search_result_batch_encode (NULL, 0, fixture->results, 2));
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  Fixture fixture = { 0 };
+  GVariantBuilder builder;
+  const PhoshBench benches[] = {
+    { "search-results/deserialise-dict", N_RESULTS, NULL, run_deserialise, NULL },
+    { "search-results/decode-batch", N_RESULTS, NULL, run_decode_full, NULL },
+    { "search-results/decode-batch-diff", N_RESULTS, NULL, run_decode_diff, NULL },
+    { "search-results/encode-batch", N_RESULTS, NULL, run_encode_full, NULL },
+  };
+
+  phosh_bench_init (&argc, &argv);
+
+  /* Typing another character drops some results and adds a few */
+  fixture.base = make_results (0, N_RESULTS);
+  fixture.results = make_results (N_RESULTS / 10, N_RESULTS);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("aa{sv}"));
+  for (guint i = 0; i < fixture.results->len; i++) {
+    PhoshSearchResultMeta *meta = g_ptr_array_index (fixture.results, i);
+
+    g_variant_builder_add_value (&builder, phosh_search_result_meta_serialise (meta));
+  }
+  fixture.dicts = g_variant_ref_sink (g_variant_builder_end (&builder));
+  fixture.full = phosh_search_result_batch_encode (NULL, 0, fixture.results, 2);
+  fixture.diff = phosh_search_result_batch_encode (fixture.base, 1, fixture.results, 2);
+
+  for (guint i = 0; i < G_N_ELEMENTS (benches); i++)
+    phosh_bench_run (&benches[i], &fixture);
+
+  g_bytes_unref (fixture.diff);
+  g_bytes_unref (fixture.full);
+  g_variant_unref (fixture.dicts);
+  g_ptr_array_unref (fixture.results);
+  g_ptr_array_unref (fixture.base);
+
+  return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "bench.h"
+
+#include "notifications/timestamp-label.h"
+#include "notifications/timestamp-label-priv.h"
+
+/*
+ * Timestamp labels get updated for every notification in the list
+ * when the minute changes.
+ */
+
+#define N_LABELS 200
+
+typedef struct {
+  GDateTime *now;
+  GDateTime *timestamps[N_LABELS];
+  GtkWidget *labels[N_LABELS];
+} Fixture;
+
+
+static void
+run_time_diff (gpointer data)
+{
+  Fixture *fixture = data;
+
+  for (guint i = 0; i < N_LABELS; i++) {
+    g_autofree char *str = phosh_time_diff_in_words (fixture->timestamps[i], fixture->now);
+  }
+}
+
+
+static void
+run_set_timestamp (gpointer data)
+{
+  Fixture *fixture = data;
+
+  for (guint i = 0; i < N_LABELS; i++) {
+    phosh_timestamp_label_set_timestamp (PHOSH_TIMESTAMP_LABEL (fixture->labels[i]),
+                                         fixture->timestamps[i]);
+  }
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  Fixture fixture = { 0 };
+  const PhoshBench diff_bench = {
+    "timestamp-label/time-diff-in-words", N_LABELS, NULL, run_time_diff, NULL
+  };
+  const PhoshBench set_bench = {
+    "timestamp-label/set-timestamp", N_LABELS, NULL, run_set_timestamp, NULL
+  };
+  gboolean have_display;
+
+  phosh_bench_init (&argc, &argv);
+  have_display = gtk_init_check (&argc, &argv);
+
+  fixture.now = g_date_time_new_now_local ();
+  /* Spread from seconds to weeks ago */
+  for (guint i = 0; i < N_LABELS; i++)
+    fixture.timestamps[i] = g_date_time_add_seconds (fixture.now, -(gdouble) i * i * 30);
+
+  phosh_bench_run (&diff_bench, &fixture);
+
+  if (have_display) {
+    for (guint i = 0; i < N_LABELS; i++)
+      fixture.labels[i] = g_object_ref_sink (GTK_WIDGET (phosh_timestamp_label_new ()));
+
+    phosh_bench_run (&set_bench, &fixture);
+
+    for (guint i = 0; i < N_LABELS; i++) {
+      gtk_widget_destroy (fixture.labels[i]);
+      g_object_unref (fixture.labels[i]);
+    }
+  } else {
+    phosh_bench_skip (set_bench.name, "No display");
+  }
+
+  for (guint i = 0; i < N_LABELS; i++)
+    g_date_time_unref (fixture.timestamps[i]);
+  g_date_time_unref (fixture.now);
+
+  return 0;
+}
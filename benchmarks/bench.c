@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * A minimal harness so benchmarks print comparable results: Each
+ * benchmark is run once to warm up and then `--samples` times. We
+ * print one JSON object per benchmark and line so results can be
+ * collected and compared across builds.
+ */
+
+#define DEFAULT_SAMPLES 10
+
+static int    n_samples = DEFAULT_SAMPLES;
+static char **filters;
+
+
+static gint64
+get_time_ns (void)
+{
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (gint64) ts.tv_sec * G_GINT64_CONSTANT (1000000000) + ts.tv_nsec;
+}
+
+
+static int
+compare_gint64 (gconstpointer a, gconstpointer b)
+{
+  gint64 x = *(const gint64 *) a;
+  gint64 y = *(const gint64 *) b;
+
+  return (x > y) - (x < y);
+}
+
+
+void
+phosh_bench_init (int *argc, char ***argv)
+{
+  g_autoptr (GOptionContext) opt_context = NULL;
+  g_autoptr (GError) err = NULL;
+  const GOptionEntry options [] = {
+    {"samples", 's', 0, G_OPTION_ARG_INT, &n_samples,
+     "Number of measured runs per benchmark", "N"},
+    {"filter", 'f', 0, G_OPTION_ARG_STRING_ARRAY, &filters,
+     "Only run benchmarks whose name contains FILTER", "FILTER"},
+    { NULL, 0, 0, G_OPTION_ARG_NONE, NULL, NULL, NULL }
+  };
+
+  opt_context = g_option_context_new ("- Run phosh benchmarks");
+  g_option_context_add_main_entries (opt_context, options, NULL);
+  if (!g_option_context_parse (opt_context, argc, argv, &err)) {
+    g_printerr ("%s\n", err->message);
+    exit (EXIT_FAILURE);
+  }
+
+  if (n_samples < 1)
+    n_samples = 1;
+}
+
+
+gboolean
+phosh_bench_enabled (const char *name)
+{
+  if (filters == NULL)
+    return TRUE;
+
+  for (int i = 0; filters[i]; i++) {
+    if (strstr (name, filters[i]))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+
+void
+phosh_bench_run (const PhoshBench *bench, gpointer data)
+{
+  g_autofree gint64 *times = NULL;
+  gint64 total = 0;
+  guint n_ops;
+
+  g_return_if_fail (bench->name && bench->run);
+
+  if (!phosh_bench_enabled (bench->name))
+    return;
+
+  n_ops = MAX (bench->n_ops, 1);
+  times = g_new0 (gint64, n_samples);
+
+  /* Warm up caches and lazily initialized state */
+  for (int i = -1; i < n_samples; i++) {
+    gint64 start;
+
+    if (bench->setup)
+      bench->setup (data);
+
+    start = get_time_ns ();
+    bench->run (data);
+    if (i >= 0)
+      times[i] = get_time_ns () - start;
+
+    if (bench->teardown)
+      bench->teardown (data);
+  }
+
+  for (int i = 0; i < n_samples; i++)
+    total += times[i];
+  qsort (times, n_samples, sizeof (gint64), compare_gint64);
+
+  printf ("{\"name\": \"%s\", \"samples\": %d, \"ops\": %u, "
+          "\"min_ns\": %" G_GINT64_FORMAT ", \"median_ns\": %" G_GINT64_FORMAT ", "
+          "\"mean_ns\": %" G_GINT64_FORMAT ", \"max_ns\": %" G_GINT64_FORMAT ", "
+          "\"ns_per_op\": %" G_GINT64_FORMAT "}\n",
+          bench->name,
+          n_samples,
+          n_ops,
+          times[0],
+          times[n_samples / 2],
+          total / n_samples,
+          times[n_samples - 1],
+          times[n_samples / 2] / n_ops);
+  fflush (stdout);
+}
+
+
+void
+phosh_bench_skip (const char *name, const char *reason)
+{
+  if (!phosh_bench_enabled (name))
+    return;
+
+  printf ("{\"name\": \"%s\", \"skipped\": \"%s\"}\n", name, reason);
+  fflush (stdout);
+}
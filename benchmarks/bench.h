@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef void (*PhoshBenchFunc) (gpointer data);
+
+/**
+ * PhoshBench:
+ * @name: The benchmark's name, e.g. `gamma-table/fill-1024`
+ * @n_ops: The number of operations a single run performs
+ * @setup: Optional function run before each run, not measured
+ * @run: The function to measure
+ * @teardown: Optional function run after each run, not measured
+ *
+ * A single benchmark.
+ */
+typedef struct {
+  const char     *name;
+  guint           n_ops;
+  PhoshBenchFunc  setup;
+  PhoshBenchFunc  run;
+  PhoshBenchFunc  teardown;
+} PhoshBench;
+
+void     phosh_bench_init    (int              *argc,
+                              char           ***argv);
+gboolean phosh_bench_enabled (const char       *name);
+void     phosh_bench_run     (const PhoshBench *bench,
+                              gpointer          data);
+void     phosh_bench_skip    (const char       *name,
+                              const char       *reason);
+
+G_END_DECLS
@@ -28,6 +28,7 @@ G_GNUC_BEGIN_IGNORE_DEPRECATIONS
 #include <libecal/libecal.h>
 G_GNUC_END_IGNORE_DEPRECATIONS
 
+#include "calendar-snapshot.h"
 #include "calendar-sources.h"
 
 #define BUS_NAME PHOSH_APP_ID ".CalendarServer"
@@ -40,6 +41,10 @@ static const gchar introspection_xml[] =
   "      <arg type='x' name='until' direction='in'/>"
   "      <arg type='b' name='force_reload' direction='in'/>"
   "    </method>"
+  "    <signal name='EventsChanged'>"
+  "      <arg type='a(ssxxa{sv})' name='added' direction='out'/>"
+  "      <arg type='as' name='removed' direction='out'/>"
+  "    </signal>"
   "    <signal name='EventsAddedOrUpdated'>"
   "      <arg type='a(ssxxa{sv})' name='events' direction='out'/>"
   "    </signal>"
@@ -87,11 +92,19 @@ create_event_id (const gchar *source_uid,
     NULL);
 }
 
+/* A single occurrence of a recurring event */
 typedef struct
 {
-  ECalClient *client;
-  GSList **pappointments; /* CalendarAppointment * */
-} CollectAppointmentsData;
+  time_t  start_time;
+  time_t  end_time;
+  gchar  *rid;
+} RecurInstance;
+
+typedef struct
+{
+  ICalTimezone *default_zone;
+  GArray       *instances; /* RecurInstance */
+} CollectInstancesData;
 
 typedef struct
 {
@@ -213,6 +226,22 @@ get_ical_end_time (ECalClient    *cal,
   return retval;
 }
 
+static const char *
+get_source_color (ECalClient *cal)
+{
+  ESource *source;
+
+  source = e_client_get_source (E_CLIENT (cal));
+  if (e_source_has_extension (source, E_SOURCE_EXTENSION_CALENDAR))
+    {
+      ESourceSelectable *ext = e_source_get_extension (source, E_SOURCE_EXTENSION_CALENDAR);
+
+      return e_source_selectable_get_color (ext);
+    }
+
+  return NULL;
+}
+
 static CalendarAppointment *
 calendar_appointment_new (ECalClient    *cal,
                           ECalComponent *comp)
@@ -221,7 +250,6 @@ calendar_appointment_new (ECalClient    *cal,
   ICalTimezone *default_zone;
   ICalComponent *ical;
   ECalComponentId *id;
-  ESource *source;
 
   default_zone = e_cal_client_get_default_timezone (cal);
   ical = e_cal_component_get_icalcomponent (comp);
@@ -235,16 +263,7 @@ calendar_appointment_new (ECalClient    *cal,
   appt->summary     = g_strdup (i_cal_component_get_summary (ical));
   appt->start_time  = get_ical_start_time (cal, ical, default_zone);
   appt->end_time    = get_ical_end_time (cal, ical, default_zone);
-
-  source = e_client_get_source (E_CLIENT (cal));
-  if (e_source_has_extension (source, E_SOURCE_EXTENSION_CALENDAR))
-    {
-      ESourceSelectable *ext = e_source_get_extension (source, E_SOURCE_EXTENSION_CALENDAR);
-      const char *color;
-
-      color = e_source_selectable_get_color (ext);
-      appt->color = g_strdup (color);
-    }
+  appt->color       = g_strdup (get_source_color (cal));
 
   e_cal_component_id_free (id);
 
@@ -285,23 +304,82 @@ generate_instances_cb (ICalComponent *icomp,
                        GCancellable *cancellable,
                        GError **error)
 {
-  CollectAppointmentsData *data = user_data;
-  CalendarAppointment *appointment;
-  ECalComponent *comp;
-  ICalTimezone *default_zone;
+  CollectInstancesData *data = user_data;
+  RecurInstance instance;
 
-  default_zone = e_cal_client_get_default_timezone (data->client);
-  comp = e_cal_component_new_from_icalcomponent (i_cal_component_clone (icomp));
+  /* Only record what differs between instances, the rest is shared
+   * via the RecurCacheEntry */
+  instance.start_time = timet_from_ical_time (instance_start, data->default_zone);
+  instance.end_time   = timet_from_ical_time (instance_end, data->default_zone);
+  instance.rid        = e_cal_util_component_get_recurid_as_string (icomp);
 
-  appointment             = calendar_appointment_new (data->client, comp);
-  appointment->start_time = timet_from_ical_time (instance_start, default_zone);
-  appointment->end_time   = timet_from_ical_time (instance_end, default_zone);
+  g_array_append_val (data->instances, instance);
 
-  *(data->pappointments) = g_slist_prepend (*(data->pappointments), appointment);
+  return TRUE;
+}
 
-  g_clear_object (&comp);
+static void
+recur_instance_clear (gpointer ptr)
+{
+  RecurInstance *instance = ptr;
 
-  return TRUE;
+  g_free (instance->rid);
+}
+
+/* The expanded instances of a recurring event. Keyed by source and
+ * component UID, valid as long as the component's revision doesn't
+ * change */
+typedef struct
+{
+  gchar  *source_uid;
+  gchar  *uid;
+  gchar  *revision;
+  gchar  *summary;
+  gchar  *color;
+  time_t  since; /* the time range the instances were expanded for */
+  time_t  until;
+  GArray *instances; /* RecurInstance */
+} RecurCacheEntry;
+
+static void
+recur_cache_entry_free (gpointer ptr)
+{
+  RecurCacheEntry *entry = ptr;
+
+  g_free (entry->source_uid);
+  g_free (entry->uid);
+  g_free (entry->revision);
+  g_free (entry->summary);
+  g_free (entry->color);
+  g_array_unref (entry->instances);
+  g_free (entry);
+}
+
+static gchar *
+get_component_revision (ICalComponent *icomp)
+{
+  ICalProperty *prop;
+  gchar *revision;
+
+  prop = i_cal_component_get_first_property (icomp, I_CAL_LASTMODIFIED_PROPERTY);
+  if (prop)
+    {
+      ICalTime *itt = i_cal_property_get_lastmodified (prop);
+      g_autofree gchar *last_modified = i_cal_time_as_ical_string (itt);
+
+      revision = g_strdup_printf ("%d-%s", i_cal_component_get_sequence (icomp), last_modified);
+      g_clear_object (&itt);
+      g_clear_object (&prop);
+    }
+  else
+    {
+      g_autofree gchar *ical = i_cal_component_as_ical_string (icomp);
+
+      /* No reliable revision so fall back to the contents */
+      revision = g_strdup_printf ("hash-%u", g_str_hash (ical));
+    }
+
+  return revision;
 }
 
 /* ---------------------------------------------------------------------------------------------------- */
@@ -321,12 +399,73 @@ struct _App
 
   gchar *timezone_location;
 
-  GSList *notify_appointments; /* CalendarAppointment *, for EventsAdded */
-  GSList *notify_ids; /* gchar *, for EventsRemoved */
+  GSList *notify_appointments; /* CalendarAppointment *, staged for pending_added */
+  GSList *notify_ids; /* gchar *, staged for pending_removed */
+
+  /* Changes not yet sent out via EventsChanged */
+  GHashTable *pending_added; /* gchar * (event id) -> CalendarAppointment * */
+  GHashTable *pending_removed; /* gchar * (event id) */
+  guint flush_id;
 
-  GSList *live_views;
+  /* Events of the last session, served until the calendars caught up */
+  CalendarSnapshot *snapshot;
+  gchar *snapshot_path;
+  GHashTable *provisional; /* gchar * (event id) */
+  guint provisional_timeout_id;
+  guint snapshot_save_id;
+
+  GSList *views; /* WindowView * */
+  GHashTable *sent_events; /* gchar * (event id) -> SentEvent * */
+  GHashTable *recur_cache; /* gchar * (source and component UID) -> RecurCacheEntry * */
 };
 
+/* Each calendar's part of the time window is covered by one or more
+ * views. When the window slides we only add views for the time ranges
+ * that got added and drop the ones that left the window. Views are
+ * created asynchronously so slow calendars don't block the others.
+ */
+typedef struct
+{
+  App            *app;
+  ECalClient     *client;
+  ECalClientView *view; /* NULL until the view got set up */
+  GCancellable   *cancellable;
+  time_t          since;
+  time_t          until;
+  GHashTable     *reported; /* gchar * (component id) reported by this view */
+} WindowView;
+
+/* How long to collect changes before emitting EventsChanged */
+#define NOTIFY_COALESCE_TIMEOUT_MS 100
+
+/* When a calendar accumulated this many views we rather reload it */
+#define MAX_VIEWS_PER_CLIENT 8
+
+/* How long to wait for more changes before writing the snapshot */
+#define SNAPSHOT_SAVE_TIMEOUT_S 5
+/* Events from the snapshot that no calendar confirmed by then are dropped */
+#define SNAPSHOT_PROVISIONAL_TIMEOUT_S 60
+
+/* Events we told clients about, so we can remove them once they
+ * leave the window. Also what ends up in the snapshot. */
+typedef struct
+{
+  time_t  start_time;
+  time_t  end_time;
+  gchar  *summary;
+  gchar  *color;
+} SentEvent;
+
+static void
+sent_event_free (gpointer ptr)
+{
+  SentEvent *sent = ptr;
+
+  g_free (sent->summary);
+  g_free (sent->color);
+  g_free (sent);
+}
+
 static void
 app_update_timezone (App *app)
 {
@@ -342,137 +481,724 @@ app_update_timezone (App *app)
       g_free (app->timezone_location);
       app->timezone_location = g_steal_pointer (&location);
       print_debug ("Using timezone %s", app->timezone_location);
+      /* Instance times depend on the timezone */
+      g_hash_table_remove_all (app->recur_cache);
+    }
+}
+
+static gboolean
+app_event_in_window (App    *app,
+                     time_t  start_time,
+                     time_t  end_time)
+{
+  return (start_time >= app->since &&
+          start_time < app->until) ||
+         (start_time <= app->since &&
+          (end_time - 1) > app->since);
+}
+
+static void
+app_save_snapshot (App *app)
+{
+  g_autoptr (GArray) events = NULL;
+  g_autoptr (GError) err = NULL;
+  GHashTableIter iter;
+  gpointer key, value;
+
+  g_clear_handle_id (&app->snapshot_save_id, g_source_remove);
+
+  if (!app->since || !app->until)
+    return;
+
+  events = g_array_sized_new (FALSE, FALSE, sizeof (CalendarSnapshotEvent),
+                              g_hash_table_size (app->sent_events));
+  g_hash_table_iter_init (&iter, app->sent_events);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      SentEvent *sent = value;
+      CalendarSnapshotEvent event;
+
+      /* Don't carry over events no calendar confirmed */
+      if (g_hash_table_contains (app->provisional, key))
+        continue;
+
+      event.id = key;
+      event.summary = sent->summary;
+      event.color = sent->color;
+      event.start_time = sent->start_time;
+      event.end_time = sent->end_time;
+      g_array_append_val (events, event);
+    }
+
+  print_debug ("Saving snapshot with %u events", events->len);
+
+  if (!calendar_snapshot_save (app->snapshot_path, app->since, app->until, events, &err))
+    g_warning ("Failed to save event snapshot: %s", err->message);
+}
+
+static gboolean
+on_snapshot_save_timeout (gpointer user_data)
+{
+  App *app = user_data;
+
+  app->snapshot_save_id = 0;
+  app_save_snapshot (app);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+app_schedule_snapshot_save (App *app)
+{
+  if (app->snapshot_save_id)
+    return;
+
+  app->snapshot_save_id = g_timeout_add_seconds (SNAPSHOT_SAVE_TIMEOUT_S, on_snapshot_save_timeout, app);
+  g_source_set_name_by_id (app->snapshot_save_id, "[calendar-server] save snapshot");
+}
+
+/* Whether clients know about the event or will be told about it with
+ * the next flush. Events queued for removal aren't known anymore, queuing
+ * them again cancels the removal. */
+static gboolean
+app_event_is_known (App         *app,
+                    const gchar *id)
+{
+  if (g_hash_table_contains (app->pending_removed, id))
+    return FALSE;
+
+  return g_hash_table_contains (app->sent_events, id) ||
+         g_hash_table_contains (app->pending_added, id);
+}
+
+static void
+app_flush_events (App *app)
+{
+  GVariantBuilder added_builder, removed_builder;
+  g_autoptr (GVariant) added = NULL;
+  g_autoptr (GVariant) removed = NULL;
+  GHashTableIter iter;
+  gpointer key, value;
+  guint n_added = 0, n_removed = 0;
+
+  g_clear_handle_id (&app->flush_id, g_source_remove);
+
+  g_variant_builder_init (&added_builder, G_VARIANT_TYPE ("a(ssxxa{sv})"));
+  g_variant_builder_init (&removed_builder, G_VARIANT_TYPE ("as"));
+
+  g_hash_table_iter_init (&iter, app->pending_added);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      CalendarAppointment *appt = value;
+      time_t start_time = appt->start_time;
+      time_t end_time   = appt->end_time;
+      GVariantBuilder extras_builder;
+      SentEvent *sent;
+
+      if (!app_event_in_window (app, start_time, end_time))
+        {
+          /* An update moved it out of the window */
+          if (g_hash_table_remove (app->sent_events, appt->id))
+            {
+              g_variant_builder_add (&removed_builder, "s", appt->id);
+              n_removed++;
+            }
+          continue;
+        }
+
+      /* The a{sv} is used as an escape hatch in case we want to provide more
+       * information in the future without breaking ABI
+       */
+      g_variant_builder_init (&extras_builder, G_VARIANT_TYPE ("a{sv}"));
+      if (appt->color)
+        {
+          g_variant_builder_add (&extras_builder,
+                                 "{sv}",
+                                 "color",
+                                 g_variant_new_string (appt->color));
+        }
+      g_variant_builder_add (&added_builder,
+                             "(ssxxa{sv})",
+                             appt->id,
+                             appt->summary != NULL ? appt->summary : "",
+                             (gint64) start_time,
+                             (gint64) end_time,
+                             &extras_builder);
+      n_added++;
+
+      sent = g_new0 (SentEvent, 1);
+      sent->start_time = start_time;
+      sent->end_time = end_time;
+      sent->summary = g_strdup (appt->summary);
+      sent->color = g_strdup (appt->color);
+      g_hash_table_insert (app->sent_events, g_strdup (appt->id), sent);
+    }
+
+  g_hash_table_iter_init (&iter, app->pending_removed);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      g_variant_builder_add (&removed_builder, "s", key);
+      g_hash_table_remove (app->sent_events, key);
+      n_removed++;
+    }
+
+  g_hash_table_remove_all (app->pending_added);
+  g_hash_table_remove_all (app->pending_removed);
+
+  if (n_added == 0 && n_removed == 0)
+    {
+      g_variant_builder_clear (&added_builder);
+      g_variant_builder_clear (&removed_builder);
+      return;
+    }
+
+  added = g_variant_ref_sink (g_variant_builder_end (&added_builder));
+  removed = g_variant_ref_sink (g_variant_builder_end (&removed_builder));
+
+  print_debug ("Emitting EventsChanged with %u added and %u removed events", n_added, n_removed);
+
+  g_dbus_connection_emit_signal (app->connection,
+                                 NULL, /* destination_bus_name */
+                                 PHOSH_DBUS_PATH_PREFIX "/CalendarServer",
+                                 PHOSH_APP_ID ".CalendarServer",
+                                 "EventsChanged",
+                                 g_variant_new ("(@a(ssxxa{sv})@as)", added, removed),
+                                 NULL);
+
+  /* Keep clients that don't know about EventsChanged working */
+  if (n_removed)
+    {
+      g_dbus_connection_emit_signal (app->connection,
+                                     NULL, /* destination_bus_name */
+                                     PHOSH_DBUS_PATH_PREFIX "/CalendarServer",
+                                     PHOSH_APP_ID ".CalendarServer",
+                                     "EventsRemoved",
+                                     g_variant_new ("(@as)", removed),
+                                     NULL);
+    }
+
+  if (n_added)
+    {
+      g_dbus_connection_emit_signal (app->connection,
+                                     NULL, /* destination_bus_name */
+                                     PHOSH_DBUS_PATH_PREFIX "/CalendarServer",
+                                     PHOSH_APP_ID ".CalendarServer",
+                                     "EventsAddedOrUpdated",
+                                     g_variant_new ("(@a(ssxxa{sv}))", added),
+                                     NULL);
+    }
+
+  app_schedule_snapshot_save (app);
+}
+
+static gboolean
+on_flush_timeout (gpointer user_data)
+{
+  App *app = user_data;
+
+  app->flush_id = 0;
+  app_flush_events (app);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+app_schedule_flush (App *app)
+{
+  if (app->flush_id)
+    return;
+
+  app->flush_id = g_timeout_add (NOTIFY_COALESCE_TIMEOUT_MS, on_flush_timeout, app);
+  g_source_set_name_by_id (app->flush_id, "[calendar-server] flush events");
+}
+
+static void
+app_notify_events_added (App *app)
+{
+  GSList *events, *link;
+
+  /* Oldest first so the latest update of an event wins */
+  events = g_slist_reverse (app->notify_appointments);
+  app->notify_appointments = NULL;
+
+  print_debug ("Queuing %d added or updated events", g_slist_length (events));
+
+  if (!events)
+    return;
+
+  for (link = events; link; link = g_slist_next (link))
+    {
+      CalendarAppointment *appt = link->data;
+
+      /* A removed and re-added event is just an update */
+      g_hash_table_remove (app->pending_removed, appt->id);
+      g_hash_table_remove (app->provisional, appt->id);
+      g_hash_table_replace (app->pending_added, appt->id, appt);
+    }
+
+  g_slist_free (events);
+  app_schedule_flush (app);
+}
+
+static void
+app_notify_events_removed (App *app)
+{
+  GSList *ids, *link;
+
+  ids = app->notify_ids;
+  app->notify_ids = NULL;
+
+  print_debug ("Queuing %d removed events", g_slist_length (ids));
+
+  if (!ids)
+    return;
+
+  for (link = ids; link; link = g_slist_next (link))
+    {
+      gchar *id = link->data;
+
+      /* Events clients never saw don't need to be removed */
+      g_hash_table_remove (app->pending_added, id);
+      g_hash_table_remove (app->provisional, id);
+      if (g_hash_table_contains (app->sent_events, id))
+        g_hash_table_add (app->pending_removed, id);
+      else
+        g_free (id);
+    }
+
+  g_slist_free (ids);
+  app_schedule_flush (app);
+}
+
+/* Drop everything we know about a source's events, clients drop them on
+ * ClientDisappeared */
+static void
+app_forget_source_events (App         *app,
+                          const gchar *source_uid)
+{
+  g_autofree gchar *prefix = g_strconcat (source_uid, "\n", NULL);
+  GHashTable *tables[] = { app->pending_added, app->pending_removed, app->sent_events, app->provisional };
+  GHashTableIter iter;
+  gpointer key;
+
+  for (guint i = 0; i < G_N_ELEMENTS (tables); i++)
+    {
+      g_hash_table_iter_init (&iter, tables[i]);
+      while (g_hash_table_iter_next (&iter, &key, NULL))
+        {
+          if (g_str_has_prefix (key, prefix))
+            g_hash_table_iter_remove (&iter);
+        }
+    }
+}
+
+/* Drop the snapshot's events in the given range that no calendar
+ * confirmed. With a NULL source_uid drop all of them */
+static void
+app_drop_provisional_events (App         *app,
+                             const gchar *source_uid,
+                             time_t       since,
+                             time_t       until)
+{
+  g_autofree gchar *prefix = NULL;
+  GHashTableIter iter;
+  gpointer key;
+
+  if (source_uid)
+    prefix = g_strconcat (source_uid, "\n", NULL);
+
+  g_hash_table_iter_init (&iter, app->provisional);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    {
+      SentEvent *sent;
+
+      if (prefix && !g_str_has_prefix (key, prefix))
+        continue;
+
+      sent = g_hash_table_lookup (app->sent_events, key);
+      if (sent && (sent->start_time >= until || sent->end_time <= since))
+        continue;
+
+      app->notify_ids = g_slist_prepend (app->notify_ids, g_strdup (key));
+      g_hash_table_iter_remove (&iter);
+    }
+
+  if (app->notify_ids)
+    app_notify_events_removed (app);
+}
+
+static gboolean
+on_provisional_timeout (gpointer user_data)
+{
+  App *app = user_data;
+
+  app->provisional_timeout_id = 0;
+
+  print_debug ("Dropping %u unconfirmed snapshot events", g_hash_table_size (app->provisional));
+  app_drop_provisional_events (app, NULL, G_MININT64, G_MAXINT64);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Send out the events of the last session right away, the live data
+ * replaces them once the calendars loaded */
+static void
+app_serve_snapshot (App *app)
+{
+  g_autoptr (CalendarSnapshot) snapshot = g_steal_pointer (&app->snapshot);
+  gint64 since, until;
+  guint n_events, n_served = 0;
+
+  since = calendar_snapshot_get_since (snapshot);
+  until = calendar_snapshot_get_until (snapshot);
+  /* Events of a window that doesn't overlap ours are of no use */
+  if (until <= app->since || since >= app->until)
+    {
+      print_debug ("Snapshot's time range doesn't match, ignoring it");
+      return;
+    }
+
+  n_events = calendar_snapshot_get_n_events (snapshot);
+  for (guint i = 0; i < n_events; i++)
+    {
+      CalendarSnapshotEvent event;
+      CalendarAppointment *appt;
+
+      calendar_snapshot_get_event (snapshot, i, &event);
+      if (!app_event_in_window (app, event.start_time, event.end_time) ||
+          app_event_is_known (app, event.id))
+        continue;
+
+      appt = g_new0 (CalendarAppointment, 1);
+      appt->id = g_strdup (event.id);
+      appt->summary = g_strdup (event.summary);
+      appt->color = g_strdup (event.color);
+      appt->start_time = event.start_time;
+      appt->end_time = event.end_time;
+
+      g_hash_table_replace (app->pending_added, appt->id, appt);
+      g_hash_table_add (app->provisional, g_strdup (event.id));
+      n_served++;
+    }
+
+  print_debug ("Serving %u of %u events from snapshot", n_served, n_events);
+
+  if (!n_served)
+    return;
+
+  app_flush_events (app);
+  app->provisional_timeout_id = g_timeout_add_seconds (SNAPSHOT_PROVISIONAL_TIMEOUT_S,
+                                                       on_provisional_timeout,
+                                                       app);
+  g_source_set_name_by_id (app->provisional_timeout_id, "[calendar-server] provisional events");
+}
+
+/* Remove events from clients that are no longer part of the window */
+static void
+app_remove_events_outside_window (App *app)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+
+  g_hash_table_iter_init (&iter, app->sent_events);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      SentEvent *sent = value;
+
+      if (!app_event_in_window (app, sent->start_time, sent->end_time))
+        app->notify_ids = g_slist_prepend (app->notify_ids, g_strdup (key));
+    }
+
+  if (app->notify_ids)
+    app_notify_events_removed (app);
+}
+
+static void
+app_queue_instance (App             *app,
+                    RecurCacheEntry *entry,
+                    RecurInstance   *instance)
+{
+  CalendarAppointment *appt;
+
+  appt = g_new0 (CalendarAppointment, 1);
+  appt->id = create_event_id (entry->source_uid, entry->uid, instance->rid);
+  appt->summary = g_strdup (entry->summary);
+  appt->color = g_strdup (entry->color);
+  appt->start_time = instance->start_time;
+  appt->end_time = instance->end_time;
+
+  app->notify_appointments = g_slist_prepend (app->notify_appointments, appt);
+}
+
+/* Queue removal of the instances of @entry in the given time range
+ * we told clients about that aren't part of @keep */
+static void
+app_queue_vanished_instances (App             *app,
+                              RecurCacheEntry *entry,
+                              RecurCacheEntry *keep,
+                              time_t           since,
+                              time_t           until)
+{
+  g_autoptr (GHashTable) kept = g_hash_table_new (g_str_hash, g_str_equal);
+
+  for (guint i = 0; keep && i < keep->instances->len; i++)
+    {
+      RecurInstance *instance = &g_array_index (keep->instances, RecurInstance, i);
+
+      if (instance->rid)
+        g_hash_table_add (kept, instance->rid);
+    }
+
+  for (guint i = 0; i < entry->instances->len; i++)
+    {
+      RecurInstance *instance = &g_array_index (entry->instances, RecurInstance, i);
+      g_autofree gchar *id = NULL;
+
+      if (instance->rid && g_hash_table_contains (kept, instance->rid))
+        continue;
+
+      /* Only @keep's range got expanded again */
+      if (instance->start_time >= until ||
+          (instance->end_time <= since && instance->start_time < since))
+        continue;
+
+      id = create_event_id (entry->source_uid, entry->uid, instance->rid);
+      if (app_event_is_known (app, id))
+        app->notify_ids = g_slist_prepend (app->notify_ids, g_steal_pointer (&id));
+    }
+}
+
+static void
+recur_cache_entry_expand (RecurCacheEntry *entry,
+                          ECalClient      *cal_client,
+                          ICalComponent   *icomp,
+                          time_t           since,
+                          time_t           until)
+{
+  g_autoptr (GHashTable) rids = NULL;
+  g_autoptr (GArray) instances = NULL;
+  CollectInstancesData data;
+
+  instances = g_array_new (FALSE, FALSE, sizeof (RecurInstance));
+  data.default_zone = e_cal_client_get_default_timezone (cal_client);
+  data.instances = instances;
+
+  e_cal_client_generate_instances_for_object_sync (cal_client, icomp, since, until, NULL,
+                                                   generate_instances_cb, &data);
+
+  /* Instances overlapping the range boundaries can be generated twice */
+  rids = g_hash_table_new (g_str_hash, g_str_equal);
+  for (guint i = 0; i < entry->instances->len; i++)
+    {
+      RecurInstance *instance = &g_array_index (entry->instances, RecurInstance, i);
+
+      if (instance->rid)
+        g_hash_table_add (rids, instance->rid);
+    }
+
+  for (guint i = 0; i < instances->len; i++)
+    {
+      RecurInstance *instance = &g_array_index (instances, RecurInstance, i);
+
+      if (instance->rid && g_hash_table_contains (rids, instance->rid))
+        {
+          g_free (instance->rid);
+          continue;
+        }
+
+      /* Ownership of the rid moves to the entry */
+      g_array_append_val (entry->instances, *instance);
+      if (instance->rid)
+        g_hash_table_add (rids, instance->rid);
     }
 }
 
+/* Expand the instances of a recurring event in the given time range.
+ * As long as the component doesn't change we only expand time ranges
+ * we didn't look at yet and only queue instances clients don't know
+ * about. */
 static void
-app_notify_events_added (App *app)
+app_expand_recurrences (App           *app,
+                        ECalClient    *cal_client,
+                        ICalComponent *icomp,
+                        time_t         since,
+                        time_t         until)
 {
-  GVariantBuilder builder;
-  GSList *events, *link;
-
-  events = g_slist_reverse (app->notify_appointments);
-  app->notify_appointments = NULL;
-
-  print_debug ("Emitting EventsAddedOrUpdated with %d events", g_slist_length (events));
+  const gchar *source_uid;
+  g_autofree gchar *key = NULL;
+  g_autofree gchar *revision = NULL;
+  RecurCacheEntry *entry;
+  gboolean only_new = FALSE;
 
-  if (!events)
+  if (since >= until)
     return;
 
-  /* The a{sv} is used as an escape hatch in case we want to provide more
-   * information in the future without breaking ABI
-   */
-  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ssxxa{sv})"));
-  for (link = events; link; link = g_slist_next (link))
+  source_uid = e_source_get_uid (e_client_get_source (E_CLIENT (cal_client)));
+  key = create_event_id (source_uid, i_cal_component_get_uid (icomp), NULL);
+  revision = get_component_revision (icomp);
+
+  entry = g_hash_table_lookup (app->recur_cache, key);
+  if (entry && g_strcmp0 (entry->revision, revision) == 0)
     {
-      CalendarAppointment *appt = link->data;
-      time_t start_time = appt->start_time;
-      time_t end_time   = appt->end_time;
-      GVariantBuilder extras_builder;
+      only_new = TRUE;
+      if (since < entry->since)
+        {
+          recur_cache_entry_expand (entry, cal_client, icomp, since, entry->since);
+          entry->since = since;
+        }
+      if (until > entry->until)
+        {
+          recur_cache_entry_expand (entry, cal_client, icomp, entry->until, until);
+          entry->until = until;
+        }
+    }
+  else
+    {
+      RecurCacheEntry *old = entry;
+
+      print_debug ("Expanding recurrences of '%s'", key);
 
-      if ((start_time >= app->since &&
-           start_time < app->until) ||
-          (start_time <= app->since &&
-          (end_time - 1) > app->since))
+      /* Other views might have reported the old revision in other parts
+       * of the window. Expand those too so their instances get updated
+       * and the vanished ones removed. */
+      if (old)
         {
-          g_variant_builder_init (&extras_builder, G_VARIANT_TYPE ("a{sv}"));
-          if (appt->color)
-            {
-              g_variant_builder_add (&extras_builder,
-                                     "{sv}",
-                                     "color",
-                                     g_variant_new_string (appt->color));
-            }
-          g_variant_builder_add (&builder,
-                                 "(ssxxa{sv})",
-                                 appt->id,
-                                 appt->summary != NULL ? appt->summary : "",
-                                 (gint64) start_time,
-                                 (gint64) end_time,
-                                 &extras_builder);
+          since = MIN (since, old->since);
+          until = MAX (until, old->until);
         }
+
+      entry = g_new0 (RecurCacheEntry, 1);
+      entry->source_uid = g_strdup (source_uid);
+      entry->uid = g_strdup (i_cal_component_get_uid (icomp));
+      entry->revision = g_steal_pointer (&revision);
+      entry->summary = g_strdup (i_cal_component_get_summary (icomp));
+      entry->color = g_strdup (get_source_color (cal_client));
+      entry->since = since;
+      entry->until = until;
+      entry->instances = g_array_new (FALSE, FALSE, sizeof (RecurInstance));
+      g_array_set_clear_func (entry->instances, recur_instance_clear);
+
+      recur_cache_entry_expand (entry, cal_client, icomp, since, until);
+
+      if (old)
+        app_queue_vanished_instances (app, old, entry, since, until);
+
+      /* Frees old */
+      g_hash_table_insert (app->recur_cache, g_steal_pointer (&key), entry);
     }
 
-  g_dbus_connection_emit_signal (app->connection,
-                                 NULL, /* destination_bus_name */
-                                 PHOSH_DBUS_PATH_PREFIX "/CalendarServer",
-                                 PHOSH_APP_ID ".CalendarServer",
-                                 "EventsAddedOrUpdated",
-                                 g_variant_new ("(a(ssxxa{sv}))", &builder),
-                                 NULL);
+  for (guint i = 0; i < entry->instances->len; i++)
+    {
+      RecurInstance *instance = &g_array_index (entry->instances, RecurInstance, i);
+
+      if (instance->start_time >= until ||
+          (instance->end_time <= since && instance->start_time < since))
+        continue;
 
-  g_variant_builder_clear (&builder);
+      if (only_new)
+        {
+          g_autofree gchar *id = create_event_id (entry->source_uid, entry->uid, instance->rid);
+
+          if (app_event_is_known (app, id))
+            continue;
+        }
 
-  g_slist_free_full (events, calendar_appointment_free);
+      app_queue_instance (app, entry, instance);
+    }
 }
 
+/* A recurring event got removed as a whole */
 static void
-app_notify_events_removed (App *app)
+app_remove_recurrences (App         *app,
+                        const gchar *source_uid,
+                        const gchar *uid)
 {
-  GVariantBuilder builder;
-  GSList *ids, *link;
+  g_autofree gchar *key = create_event_id (source_uid, uid, NULL);
+  RecurCacheEntry *entry;
 
-  ids = app->notify_ids;
-  app->notify_ids = NULL;
+  entry = g_hash_table_lookup (app->recur_cache, key);
+  if (!entry)
+    return;
 
-  print_debug ("Emitting EventsRemoved with %d ids", g_slist_length (ids));
+  app_queue_vanished_instances (app, entry, NULL, entry->since, entry->until);
+  g_hash_table_remove (app->recur_cache, key);
+}
 
-  if (!ids)
-    return;
+/* Drop instances that left the window */
+static void
+app_prune_recur_cache (App *app)
+{
+  GHashTableIter iter;
+  gpointer value;
 
-  g_variant_builder_init (&builder, G_VARIANT_TYPE ("as"));
-  for (link = ids; link; link = g_slist_next (link))
+  g_hash_table_iter_init (&iter, app->recur_cache);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
     {
-      const gchar *id = link->data;
+      RecurCacheEntry *entry = value;
 
-      g_variant_builder_add (&builder, "s", id);
-    }
+      entry->since = MAX (entry->since, app->since);
+      entry->until = MIN (entry->until, app->until);
+      if (entry->since >= entry->until)
+        {
+          g_hash_table_iter_remove (&iter);
+          continue;
+        }
 
-  g_dbus_connection_emit_signal (app->connection,
-                                 NULL, /* destination_bus_name */
-                                 PHOSH_DBUS_PATH_PREFIX "/CalendarServer",
-                                 PHOSH_APP_ID ".CalendarServer",
-                                 "EventsRemoved",
-                                 g_variant_new ("(as)", &builder),
-                                 NULL);
-  g_variant_builder_clear (&builder);
+      for (guint i = entry->instances->len; i > 0; i--)
+        {
+          RecurInstance *instance = &g_array_index (entry->instances, RecurInstance, i - 1);
+
+          if (!app_event_in_window (app, instance->start_time, instance->end_time))
+            g_array_remove_index_fast (entry->instances, i - 1);
+        }
+    }
+}
 
-  g_slist_free_full (ids, g_free);
+static gboolean
+recur_cache_entry_is_for_source (gpointer key,
+                                 gpointer value,
+                                 gpointer user_data)
+{
+  RecurCacheEntry *entry = value;
 
-  return;
+  return g_strcmp0 (entry->source_uid, user_data) == 0;
 }
 
 static void
 app_process_added_modified_objects (App *app,
-                                    ECalClientView *view,
+                                    WindowView *wv,
                                     GSList *objects) /* ICalComponent * */
 {
   ECalClient *cal_client;
+  const gchar *source_uid;
   GSList *link;
   gboolean expand_recurrences;
 
-  cal_client = e_cal_client_view_ref_client (view);
+  cal_client = e_cal_client_view_ref_client (wv->view);
   expand_recurrences = e_cal_client_get_source_type (cal_client) == E_CAL_CLIENT_SOURCE_TYPE_EVENTS;
+  source_uid = e_source_get_uid (e_client_get_source (E_CLIENT (cal_client)));
 
   for (link = objects; link; link = g_slist_next (link))
     {
       ECalComponent *comp;
       ICalComponent *icomp = link->data;
+      g_autofree gchar *rid = NULL;
 
       if (!icomp || !i_cal_component_get_uid (icomp))
         continue;
 
+      rid = e_cal_util_component_get_recurid_as_string (icomp);
+      g_hash_table_add (wv->reported,
+                        create_event_id (source_uid, i_cal_component_get_uid (icomp), rid));
+
       if (expand_recurrences &&
           !e_cal_util_component_is_instance (icomp) &&
           e_cal_util_component_has_recurrences (icomp))
         {
-          CollectAppointmentsData data;
-
-          data.client = cal_client;
-          data.pappointments = &app->notify_appointments;
-
-          e_cal_client_generate_instances_for_object_sync (cal_client, icomp, app->since, app->until, NULL,
-                                                           generate_instances_cb, &data);
+          /* Other views take care of the rest of the window */
+          app_expand_recurrences (app, cal_client, icomp,
+                                  MAX (wv->since, app->since),
+                                  MIN (wv->until, app->until));
         }
       else
         {
@@ -488,6 +1214,9 @@ app_process_added_modified_objects (App *app,
 
   g_clear_object (&cal_client);
 
+  if (app->notify_ids)
+    app_notify_events_removed (app);
+
   if (app->notify_appointments)
     app_notify_events_added (app);
 }
@@ -497,14 +1226,14 @@ on_objects_added (ECalClientView *view,
                   GSList         *objects,
                   gpointer        user_data)
 {
-  App *app = user_data;
+  WindowView *wv = user_data;
   ECalClient *client;
 
   client = e_cal_client_view_ref_client (view);
   print_debug ("%s (%d) for calendar '%s'", G_STRFUNC, g_slist_length (objects), e_source_get_uid (e_client_get_source (E_CLIENT (client))));
   g_clear_object (&client);
 
-  app_process_added_modified_objects (app, view, objects);
+  app_process_added_modified_objects (wv->app, wv, objects);
 }
 
 static void
@@ -512,14 +1241,57 @@ on_objects_modified (ECalClientView *view,
                      GSList         *objects,
                      gpointer        user_data)
 {
-  App *app = user_data;
+  WindowView *wv = user_data;
   ECalClient *client;
 
   client = e_cal_client_view_ref_client (view);
   print_debug ("%s (%d) for calendar '%s'", G_STRFUNC, g_slist_length (objects), e_source_get_uid (e_client_get_source (E_CLIENT (client))));
   g_clear_object (&client);
 
-  app_process_added_modified_objects (app, view, objects);
+  app_process_added_modified_objects (wv->app, wv, objects);
+}
+
+static void app_stop_client_views (App *app, const gchar *source_uid);
+static WindowView *app_start_view (App *app, ECalClient *cal_client, time_t since, time_t until);
+
+static gboolean
+app_is_reported_by_other_view (App         *app,
+                               WindowView  *wv,
+                               const gchar *key)
+{
+  for (GSList *link = app->views; link; link = g_slist_next (link))
+    {
+      WindowView *other = link->data;
+
+      if (other != wv &&
+          other->client == wv->client &&
+          g_hash_table_contains (other->reported, key))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* A view that only covers part of the window failed. The other views
+ * leave a hole so query the whole window again. */
+static gboolean
+app_reload_client_on_failure (App        *app,
+                              WindowView *wv)
+{
+  g_autoptr (ECalClient) cal_client = NULL;
+  g_autofree gchar *source_uid = NULL;
+
+  if (wv->since <= app->since && wv->until >= app->until)
+    return FALSE;
+
+  cal_client = g_object_ref (wv->client);
+  source_uid = g_strdup (e_source_get_uid (e_client_get_source (E_CLIENT (cal_client))));
+  print_debug ("Partial view failed, reloading all events for calendar '%s'", source_uid);
+
+  app_stop_client_views (app, source_uid);
+  app_start_view (app, cal_client, app->since, app->until);
+
+  return TRUE;
 }
 
 static void
@@ -527,7 +1299,8 @@ on_objects_removed (ECalClientView *view,
                     GSList         *uids,
                     gpointer        user_data)
 {
-  App *app = user_data;
+  WindowView *wv = user_data;
+  App *app = wv->app;
   ECalClient *client;
   GSList *link;
   const gchar *source_uid;
@@ -540,14 +1313,23 @@ on_objects_removed (ECalClientView *view,
   for (link = uids; link; link = g_slist_next (link))
     {
       ECalComponentId *id = link->data;
+      g_autofree gchar *key = NULL;
 
       if (!id)
         continue;
 
-      app->notify_ids = g_slist_prepend (app->notify_ids,
-                                         create_event_id (source_uid,
-                                         e_cal_component_id_get_uid (id),
-                                         e_cal_component_id_get_rid (id)));
+      key = create_event_id (source_uid,
+                             e_cal_component_id_get_uid (id),
+                             e_cal_component_id_get_rid (id));
+      g_hash_table_remove (wv->reported, key);
+      /* The event only left this view's part of the window */
+      if (app_is_reported_by_other_view (app, wv, key))
+        continue;
+
+      if (!e_cal_component_id_get_rid (id) || !*e_cal_component_id_get_rid (id))
+        app_remove_recurrences (app, source_uid, e_cal_component_id_get_uid (id));
+
+      app->notify_ids = g_slist_prepend (app->notify_ids, g_steal_pointer (&key));
     }
 
   g_clear_object (&client);
@@ -556,27 +1338,168 @@ on_objects_removed (ECalClientView *view,
     app_notify_events_removed (app);
 }
 
+static void
+on_view_complete (ECalClientView *view,
+                  const GError   *error,
+                  gpointer        user_data)
+{
+  WindowView *wv = user_data;
+  App *app = wv->app;
+
+  if (error)
+    {
+      g_warning ("View for calendar '%s' failed: %s",
+                 e_source_get_uid (e_client_get_source (E_CLIENT (wv->client))),
+                 error->message);
+      app_reload_client_on_failure (app, wv);
+      return;
+    }
+
+  if (!g_hash_table_size (app->provisional))
+    return;
+
+  /* Everything this view knows about is loaded now */
+  app_drop_provisional_events (app,
+                               e_source_get_uid (e_client_get_source (E_CLIENT (wv->client))),
+                               wv->since,
+                               wv->until);
+}
+
 static gboolean
 app_has_calendars (App *app)
 {
-  return app->live_views != NULL;
+  return app->views != NULL;
+}
+
+static void
+window_view_free (WindowView *wv)
+{
+  g_cancellable_cancel (wv->cancellable);
+  g_clear_object (&wv->cancellable);
+
+  if (wv->view)
+    {
+      e_cal_client_view_stop (wv->view, NULL);
+
+      g_signal_handlers_disconnect_by_func (wv->view, on_objects_added, wv);
+      g_signal_handlers_disconnect_by_func (wv->view, on_objects_modified, wv);
+      g_signal_handlers_disconnect_by_func (wv->view, on_objects_removed, wv);
+      g_signal_handlers_disconnect_by_func (wv->view, on_view_complete, wv);
+      g_clear_object (&wv->view);
+    }
+
+  g_clear_object (&wv->client);
+  g_clear_pointer (&wv->reported, g_hash_table_destroy);
+  g_free (wv);
+}
+
+static gboolean
+window_view_is_for_source (WindowView  *wv,
+                           const gchar *source_uid)
+{
+  return g_strcmp0 (source_uid, e_source_get_uid (e_client_get_source (E_CLIENT (wv->client)))) == 0;
 }
 
-static ECalClientView *
+static void
+app_notify_has_calendars (App *app)
+{
+  GVariantBuilder dict_builder;
+
+  g_variant_builder_init (&dict_builder, G_VARIANT_TYPE ("a{sv}"));
+  g_variant_builder_add (&dict_builder, "{sv}", "HasCalendars",
+                         g_variant_new_boolean (app_has_calendars (app)));
+
+  g_dbus_connection_emit_signal (app->connection,
+                                 NULL,
+                                 PHOSH_DBUS_PATH_PREFIX "/CalendarServer",
+                                 "org.freedesktop.DBus.Properties",
+                                 "PropertiesChanged",
+                                 g_variant_new ("(sa{sv}as)",
+                                                PHOSH_APP_ID ".CalendarServer",
+                                                &dict_builder,
+                                                NULL),
+                                 NULL);
+  g_variant_builder_clear (&dict_builder);
+}
+
+static void
+app_stop_view (App *app,
+               WindowView *wv)
+{
+  app->views = g_slist_remove (app->views, wv);
+  window_view_free (wv);
+}
+
+static void
+on_get_view_ready (GObject      *source_object,
+                   GAsyncResult *res,
+                   gpointer      user_data)
+{
+  ECalClient *cal_client = E_CAL_CLIENT (source_object);
+  g_autoptr (GError) error = NULL;
+  ECalClientView *view = NULL;
+  WindowView *wv;
+  App *app;
+
+  if (!e_cal_client_get_view_finish (cal_client, res, &view, &error))
+    {
+      if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        return;
+
+      wv = user_data;
+      app = wv->app;
+      g_warning ("Error setting up live-query on calendar '%s': %s",
+                 e_source_get_uid (e_client_get_source (E_CLIENT (cal_client))),
+                 error ? error->message : "Unknown error");
+      if (app_reload_client_on_failure (app, wv))
+        return;
+
+      app_stop_view (app, wv);
+      if (!app_has_calendars (app))
+        app_notify_has_calendars (app);
+      return;
+    }
+
+  wv = user_data;
+  wv->view = view;
+
+  print_debug ("View ready for calendar '%s'", e_source_get_uid (e_client_get_source (E_CLIENT (cal_client))));
+
+  g_signal_connect (view,
+                    "objects-added",
+                    G_CALLBACK (on_objects_added),
+                    wv);
+  g_signal_connect (view,
+                    "objects-modified",
+                    G_CALLBACK (on_objects_modified),
+                    wv);
+  g_signal_connect (view,
+                    "objects-removed",
+                    G_CALLBACK (on_objects_removed),
+                    wv);
+  g_signal_connect (view,
+                    "complete",
+                    G_CALLBACK (on_view_complete),
+                    wv);
+  e_cal_client_view_start (view, NULL);
+}
+
+static WindowView *
 app_start_view (App *app,
-                ECalClient *cal_client)
+                ECalClient *cal_client,
+                time_t since,
+                time_t until)
 {
   g_autofree char *since_iso8601 = NULL;
   g_autofree char *until_iso8601 = NULL;
   g_autofree char *query = NULL;
   const gchar *tz_location;
-  ECalClientView *view = NULL;
-  g_autoptr (GError) error = NULL;
+  WindowView *wv;
 
-  if (app->since <= 0 || app->since >= app->until)
+  if (since <= 0 || since >= until)
     return NULL;
 
-  if (!app->since || !app->until)
+  if (!since || !until)
     {
       print_debug ("Skipping load of events, no time interval set yet");
       return NULL;
@@ -585,8 +1508,8 @@ app_start_view (App *app,
   /* timezone could have changed */
   app_update_timezone (app);
 
-  since_iso8601 = isodate_from_time_t (app->since);
-  until_iso8601 = isodate_from_time_t (app->until);
+  since_iso8601 = isodate_from_time_t (since);
+  until_iso8601 = isodate_from_time_t (until);
   tz_location = i_cal_timezone_get_location (app->zone);
 
   print_debug ("Loading events since %s until %s for calendar '%s'",
@@ -603,95 +1526,140 @@ app_start_view (App *app,
   if (app->zone)
     e_cal_client_set_default_timezone (cal_client, app->zone);
 
-  if (!e_cal_client_get_view_sync (cal_client, query, &view, NULL /* cancellable */, &error))
-    {
-      g_warning ("Error setting up live-query '%s' on calendar: %s\n", query, error ? error->message : "Unknown error");
-      view = NULL;
-    }
-  else
+  wv = g_new0 (WindowView, 1);
+  wv->app = app;
+  wv->client = g_object_ref (cal_client);
+  wv->cancellable = g_cancellable_new ();
+  wv->since = since;
+  wv->until = until;
+  wv->reported = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  app->views = g_slist_prepend (app->views, wv);
+
+  e_cal_client_get_view (cal_client, query, wv->cancellable, on_get_view_ready, wv);
+
+  return wv;
+}
+
+static void
+app_stop_client_views (App *app,
+                       const gchar *source_uid)
+{
+  GSList *link = app->views;
+
+  while (link)
     {
-      g_signal_connect (view,
-                        "objects-added",
-                        G_CALLBACK (on_objects_added),
-                        app);
-      g_signal_connect (view,
-                        "objects-modified",
-                        G_CALLBACK (on_objects_modified),
-                        app);
-      g_signal_connect (view,
-                        "objects-removed",
-                        G_CALLBACK (on_objects_removed),
-                        app);
-      e_cal_client_view_start (view, NULL);
+      WindowView *wv = link->data;
+
+      link = g_slist_next (link);
+      if (window_view_is_for_source (wv, source_uid))
+        app_stop_view (app, wv);
     }
-  return view;
 }
 
-static void
-app_stop_view (App *app,
-               ECalClientView *view)
+static guint
+app_count_client_views (App *app,
+                        const gchar *source_uid)
 {
-      e_cal_client_view_stop (view, NULL);
+  guint count = 0;
 
-      g_signal_handlers_disconnect_by_func (view, on_objects_added, app);
-      g_signal_handlers_disconnect_by_func (view, on_objects_modified, app);
-      g_signal_handlers_disconnect_by_func (view, on_objects_removed, app);
+  for (GSList *link = app->views; link; link = g_slist_next (link))
+    {
+      if (window_view_is_for_source (link->data, source_uid))
+        count++;
+    }
+
+  return count;
 }
 
+/* Load the time ranges that got added to the window for the given client */
 static void
-app_notify_has_calendars (App *app)
+app_extend_client_views (App *app,
+                         ECalClient *cal_client,
+                         time_t old_since,
+                         time_t old_until)
 {
-  GVariantBuilder dict_builder;
+  const gchar *source_uid;
+  guint count, needed = 0;
 
-  g_variant_builder_init (&dict_builder, G_VARIANT_TYPE ("a{sv}"));
-  g_variant_builder_add (&dict_builder, "{sv}", "HasCalendars",
-                         g_variant_new_boolean (app_has_calendars (app)));
+  source_uid = e_source_get_uid (e_client_get_source (E_CLIENT (cal_client)));
+  count = app_count_client_views (app, source_uid);
 
-  g_dbus_connection_emit_signal (app->connection,
-                                 NULL,
-                                 PHOSH_DBUS_PATH_PREFIX "/CalendarServer",
-                                 "org.freedesktop.DBus.Properties",
-                                 "PropertiesChanged",
-                                 g_variant_new ("(sa{sv}as)",
-                                                PHOSH_APP_ID ".CalendarServer",
-                                                &dict_builder,
-                                                NULL),
-                                 NULL);
-  g_variant_builder_clear (&dict_builder);
+  if (app->since < old_since)
+    needed++;
+  if (app->until > old_until)
+    needed++;
+
+  if (count == 0 || count + needed > MAX_VIEWS_PER_CLIENT)
+    {
+      print_debug ("Reloading all events for calendar '%s'", source_uid);
+      app_stop_client_views (app, source_uid);
+      app_start_view (app, cal_client, app->since, app->until);
+      return;
+    }
+
+  if (app->since < old_since)
+    app_start_view (app, cal_client, app->since, old_since);
+  if (app->until > old_until)
+    app_start_view (app, cal_client, old_until, app->until);
 }
 
 static void
-app_update_views (App *app)
+app_update_views (App *app,
+                  time_t old_since,
+                  time_t old_until,
+                  gboolean force_reload)
 {
   GSList *link, *clients;
   gboolean had_views, has_views;
+  gboolean overlaps;
 
-  had_views = app->live_views != NULL;
+  had_views = app->views != NULL;
+  overlaps = old_since < old_until && app->since < old_until && app->until > old_since;
 
-  for (link = app->live_views; link; link = g_slist_next (link))
+  if (force_reload || !overlaps)
+    {
+      g_slist_free_full (app->views, (GDestroyNotify) window_view_free);
+      app->views = NULL;
+      g_hash_table_remove_all (app->recur_cache);
+    }
+  else
     {
-      app_stop_view (app, link->data);
+      /* Drop views that only cover time ranges outside of the window */
+      link = app->views;
+      while (link)
+        {
+          WindowView *wv = link->data;
+
+          link = g_slist_next (link);
+          if (wv->until <= app->since || wv->since >= app->until)
+            app_stop_view (app, wv);
+        }
     }
 
-  g_slist_free_full (app->live_views, g_object_unref);
-  app->live_views = NULL;
+  app_remove_events_outside_window (app);
+  app_prune_recur_cache (app);
 
   clients = calendar_sources_ref_clients (app->sources);
 
   for (link = clients; link; link = g_slist_next (link))
     {
       ECalClient *cal_client = link->data;
-      ECalClientView *view;
 
       if (!cal_client)
         continue;
 
-      view = app_start_view (app, cal_client);
-      if (view)
-        app->live_views = g_slist_prepend (app->live_views, view);
+      if (app->views == NULL || force_reload || !overlaps)
+        {
+          if (!app_count_client_views (app, e_source_get_uid (e_client_get_source (E_CLIENT (cal_client)))))
+            app_start_view (app, cal_client, app->since, app->until);
+        }
+      else
+        {
+          app_extend_client_views (app, cal_client, old_since, old_until);
+        }
     }
 
-  has_views = app->live_views != NULL;
+  has_views = app->views != NULL;
 
   if (has_views != had_views)
     app_notify_has_calendars (app);
@@ -705,40 +1673,19 @@ on_client_appeared_cb (CalendarSources *sources,
                        gpointer user_data)
 {
   App *app = user_data;
-  ECalClientView *view;
-  GSList *link;
   const gchar *source_uid;
 
   source_uid = e_source_get_uid (e_client_get_source (E_CLIENT (client)));
 
   print_debug ("Client appeared '%s'", source_uid);
 
-  for (link = app->live_views; link; link = g_slist_next (link))
-    {
-      ECalClientView *v = link->data;
-      ECalClient *cal_client;
-      ESource *source;
-
-      cal_client = e_cal_client_view_ref_client (v);
-      source = e_client_get_source (E_CLIENT (cal_client));
-
-      if (g_strcmp0 (source_uid, e_source_get_uid (source)) == 0)
-        {
-          g_clear_object (&cal_client);
-          return;
-        }
-
-      g_clear_object (&cal_client);
-    }
-
-  view = app_start_view (app, client);
+  if (app_count_client_views (app, source_uid))
+    return;
 
-  if (view)
+  if (app_start_view (app, client, app->since, app->until))
     {
-      app->live_views = g_slist_prepend (app->live_views, view);
-
       /* It's the first view, notify that it has calendars now */
-      if (!g_slist_next (app->live_views))
+      if (!g_slist_next (app->views))
         app_notify_has_calendars (app);
     }
 }
@@ -749,55 +1696,51 @@ on_client_disappeared_cb (CalendarSources *sources,
                           gpointer user_data)
 {
   App *app = user_data;
-  GSList *link;
 
   print_debug ("Client disappeared '%s'", source_uid);
 
-  for (link = app->live_views; link; link = g_slist_next (link))
-    {
-      ECalClientView *view = link->data;
-      ECalClient *cal_client;
-      ESource *source;
-
-      cal_client = e_cal_client_view_ref_client (view);
-      source = e_client_get_source (E_CLIENT (cal_client));
-
-      if (g_strcmp0 (source_uid, e_source_get_uid (source)) == 0)
-        {
-          g_clear_object (&cal_client);
-          app_stop_view (app, view);
-          app->live_views = g_slist_remove (app->live_views, view);
-          g_object_unref (view);
-
-          print_debug ("Emitting ClientDisappeared for '%s'", source_uid);
+  if (!app_count_client_views (app, source_uid))
+    return;
 
-          g_dbus_connection_emit_signal (app->connection,
-                                         NULL, /* destination_bus_name */
-                                         PHOSH_DBUS_PATH_PREFIX "/CalendarServer",
-                                         PHOSH_APP_ID ".CalendarServer",
-                                         "ClientDisappeared",
-                                         g_variant_new ("(s)", source_uid),
-                                         NULL);
+  app_stop_client_views (app, source_uid);
+  g_hash_table_foreach_remove (app->recur_cache, recur_cache_entry_is_for_source, (gpointer) source_uid);
+  app_forget_source_events (app, source_uid);
+  app_schedule_snapshot_save (app);
 
-          /* It was the last view, notify that it doesn't have calendars now */
-          if (!app->live_views)
-            app_notify_has_calendars (app);
+  print_debug ("Emitting ClientDisappeared for '%s'", source_uid);
 
-          break;
-        }
+  g_dbus_connection_emit_signal (app->connection,
+                                 NULL, /* destination_bus_name */
+                                 PHOSH_DBUS_PATH_PREFIX "/CalendarServer",
+                                 PHOSH_APP_ID ".CalendarServer",
+                                 "ClientDisappeared",
+                                 g_variant_new ("(s)", source_uid),
+                                 NULL);
 
-      g_clear_object (&cal_client);
-    }
+  /* It was the last view, notify that it doesn't have calendars now */
+  if (!app->views)
+    app_notify_has_calendars (app);
 }
 
 static App *
 app_new (GDBusConnection *connection)
 {
+  g_autoptr (GError) error = NULL;
   App *app;
 
   app = g_new0 (App, 1);
   app->connection = g_object_ref (connection);
   app->sources = calendar_sources_get ();
+  app->sent_events = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, sent_event_free);
+  app->recur_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, recur_cache_entry_free);
+  /* The key is owned by the appointment */
+  app->pending_added = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, calendar_appointment_free);
+  app->pending_removed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  app->provisional = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  app->snapshot_path = calendar_snapshot_get_default_path ();
+  app->snapshot = calendar_snapshot_load (app->snapshot_path, &error);
+  if (!app->snapshot && !g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+    g_warning ("Failed to load event snapshot: %s", error->message);
   app->client_appeared_signal_id = g_signal_connect (app->sources,
                                                      "client-appeared",
                                                      G_CALLBACK (on_client_appeared_cb),
@@ -815,15 +1758,6 @@ app_new (GDBusConnection *connection)
 static void
 app_free (App *app)
 {
-  GSList *ll;
-
-  for (ll = app->live_views; ll != NULL; ll = g_slist_next (ll))
-    {
-      ECalClientView *view = E_CAL_CLIENT_VIEW (ll->data);
-
-      app_stop_view (app, view);
-    }
-
   g_signal_handler_disconnect (app->sources,
                                app->client_appeared_signal_id);
   g_signal_handler_disconnect (app->sources,
@@ -831,9 +1765,20 @@ app_free (App *app)
 
   g_free (app->timezone_location);
 
-  g_slist_free_full (app->live_views, g_object_unref);
+  g_clear_handle_id (&app->flush_id, g_source_remove);
+  g_clear_handle_id (&app->provisional_timeout_id, g_source_remove);
+  if (app->snapshot_save_id)
+    app_save_snapshot (app);
+  g_clear_pointer (&app->snapshot, calendar_snapshot_free);
+  g_free (app->snapshot_path);
+  g_slist_free_full (app->views, (GDestroyNotify) window_view_free);
   g_slist_free_full (app->notify_appointments, calendar_appointment_free);
   g_slist_free_full (app->notify_ids, g_free);
+  g_hash_table_destroy (app->sent_events);
+  g_hash_table_destroy (app->recur_cache);
+  g_hash_table_destroy (app->pending_added);
+  g_hash_table_destroy (app->pending_removed);
+  g_hash_table_destroy (app->provisional);
 
   g_object_unref (app->connection);
   g_object_unref (app->sources);
@@ -861,6 +1806,8 @@ handle_method_call (GDBusConnection       *connection,
       gint64 until;
       gboolean force_reload = FALSE;
       gboolean window_changed = FALSE;
+      time_t old_since = app->since;
+      time_t old_until = app->until;
 
       g_variant_get (parameters,
                      "(xxb)",
@@ -914,7 +1861,10 @@ handle_method_call (GDBusConnection       *connection,
       g_dbus_method_invocation_return_value (invocation, NULL);
 
       if (window_changed || force_reload)
-        app_update_views (app);
+        app_update_views (app, old_since, old_until, force_reload);
+
+      if (app->snapshot)
+        app_serve_snapshot (app);
     }
   else
     {
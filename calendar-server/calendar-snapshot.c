@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "phosh-config.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <glib/gstdio.h>
+
+#include "calendar-snapshot.h"
+
+/*
+ * A snapshot of the events in the current time window so we can serve
+ * them right away after login while evolution-data-server is still
+ * starting up. The file is meant to be mapped directly: a fixed size
+ * header followed by fixed size records and a table of NUL terminated
+ * strings the records point into. It's a per user cache so we use
+ * native byte order and just discard snapshots that don't match.
+ */
+
+#define SNAPSHOT_MAGIC   0x53435350 /* "PSCS" */
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_NO_STRING G_MAXUINT32
+
+typedef struct
+{
+  guint32 magic;
+  guint32 version;
+  gint64  since;
+  gint64  until;
+  guint32 n_events;
+  guint32 strings_len;
+} SnapshotHeader;
+
+typedef struct
+{
+  gint64  start_time;
+  gint64  end_time;
+  guint32 id;
+  guint32 summary;
+  guint32 color;
+  guint32 reserved;
+} SnapshotRecord;
+
+G_STATIC_ASSERT (sizeof (SnapshotHeader) == 32);
+G_STATIC_ASSERT (sizeof (SnapshotRecord) == 32);
+
+struct _CalendarSnapshot
+{
+  GMappedFile          *file;
+  const SnapshotHeader *header;
+  const SnapshotRecord *records;
+  const gchar          *strings;
+};
+
+gchar *
+calendar_snapshot_get_default_path (void)
+{
+  return g_build_filename (g_get_user_cache_dir (),
+                           "phosh",
+                           "calendar-server",
+                           "events.snapshot",
+                           NULL);
+}
+
+static gboolean
+snapshot_string_valid (const SnapshotHeader *header,
+                       guint32               offset,
+                       gboolean              optional)
+{
+  if (offset == SNAPSHOT_NO_STRING)
+    return optional;
+
+  return offset < header->strings_len;
+}
+
+CalendarSnapshot *
+calendar_snapshot_load (const gchar  *path,
+                        GError      **error)
+{
+  g_autoptr (GMappedFile) file = NULL;
+  const SnapshotHeader *header;
+  const SnapshotRecord *records;
+  const gchar *contents, *strings;
+  CalendarSnapshot *snapshot;
+  gsize size;
+
+  file = g_mapped_file_new (path, FALSE, error);
+  if (!file)
+    return NULL;
+
+  contents = g_mapped_file_get_contents (file);
+  size = g_mapped_file_get_length (file);
+  header = (const SnapshotHeader *) contents;
+
+  if (size < sizeof (SnapshotHeader) ||
+      header->magic != SNAPSHOT_MAGIC ||
+      header->version != SNAPSHOT_VERSION ||
+      header->n_events > (size - sizeof (SnapshotHeader)) / sizeof (SnapshotRecord) ||
+      size != sizeof (SnapshotHeader) + header->n_events * sizeof (SnapshotRecord) + header->strings_len ||
+      header->since > header->until)
+    {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "Invalid or outdated snapshot '%s'", path);
+      return NULL;
+    }
+
+  records = (const SnapshotRecord *) (contents + sizeof (SnapshotHeader));
+  strings = (const gchar *) (records + header->n_events);
+
+  if (header->strings_len && strings[header->strings_len - 1] != '\0')
+    {
+      g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "Unterminated strings in snapshot '%s'", path);
+      return NULL;
+    }
+
+  for (guint i = 0; i < header->n_events; i++)
+    {
+      if (!snapshot_string_valid (header, records[i].id, FALSE) ||
+          !snapshot_string_valid (header, records[i].summary, FALSE) ||
+          !snapshot_string_valid (header, records[i].color, TRUE))
+        {
+          g_set_error (error, G_FILE_ERROR, G_FILE_ERROR_INVAL, "Invalid event %u in snapshot '%s'", i, path);
+          return NULL;
+        }
+    }
+
+  snapshot = g_new0 (CalendarSnapshot, 1);
+  snapshot->file = g_steal_pointer (&file);
+  snapshot->header = header;
+  snapshot->records = records;
+  snapshot->strings = strings;
+
+  return snapshot;
+}
+
+void
+calendar_snapshot_free (CalendarSnapshot *snapshot)
+{
+  g_mapped_file_unref (snapshot->file);
+  g_free (snapshot);
+}
+
+gint64
+calendar_snapshot_get_since (CalendarSnapshot *snapshot)
+{
+  return snapshot->header->since;
+}
+
+gint64
+calendar_snapshot_get_until (CalendarSnapshot *snapshot)
+{
+  return snapshot->header->until;
+}
+
+guint
+calendar_snapshot_get_n_events (CalendarSnapshot *snapshot)
+{
+  return snapshot->header->n_events;
+}
+
+void
+calendar_snapshot_get_event (CalendarSnapshot      *snapshot,
+                             guint                  index,
+                             CalendarSnapshotEvent *event)
+{
+  const SnapshotRecord *record;
+
+  g_return_if_fail (index < snapshot->header->n_events);
+
+  record = &snapshot->records[index];
+  event->id = snapshot->strings + record->id;
+  event->summary = snapshot->strings + record->summary;
+  event->color = record->color == SNAPSHOT_NO_STRING ? NULL : snapshot->strings + record->color;
+  event->start_time = record->start_time;
+  event->end_time = record->end_time;
+}
+
+static guint32
+snapshot_intern_string (GString     *strings,
+                        GHashTable  *offsets,
+                        const gchar *str)
+{
+  gpointer offset;
+
+  if (str == NULL)
+    return SNAPSHOT_NO_STRING;
+
+  if (g_hash_table_lookup_extended (offsets, str, NULL, &offset))
+    return GPOINTER_TO_UINT (offset);
+
+  offset = GUINT_TO_POINTER (strings->len);
+  g_string_append_len (strings, str, strlen (str) + 1);
+  g_hash_table_insert (offsets, (gpointer) str, offset);
+
+  return GPOINTER_TO_UINT (offset);
+}
+
+gboolean
+calendar_snapshot_save (const gchar  *path,
+                        gint64        since,
+                        gint64        until,
+                        GArray       *events,
+                        GError      **error)
+{
+  g_autoptr (GHashTable) offsets = g_hash_table_new (g_str_hash, g_str_equal);
+  g_autoptr (GByteArray) data = g_byte_array_new ();
+  g_autoptr (GString) strings = g_string_new (NULL);
+  g_autofree gchar *dir = NULL;
+  SnapshotHeader header = { 0 };
+
+  for (guint i = 0; i < events->len; i++)
+    {
+      CalendarSnapshotEvent *event = &g_array_index (events, CalendarSnapshotEvent, i);
+      SnapshotRecord record = { 0 };
+
+      record.start_time = event->start_time;
+      record.end_time = event->end_time;
+      record.id = snapshot_intern_string (strings, offsets, event->id);
+      record.summary = snapshot_intern_string (strings, offsets, event->summary ?: "");
+      record.color = snapshot_intern_string (strings, offsets, event->color);
+
+      g_byte_array_append (data, (const guint8 *) &record, sizeof (record));
+    }
+
+  header.magic = SNAPSHOT_MAGIC;
+  header.version = SNAPSHOT_VERSION;
+  header.since = since;
+  header.until = until;
+  header.n_events = events->len;
+  header.strings_len = strings->len;
+
+  g_byte_array_prepend (data, (const guint8 *) &header, sizeof (header));
+  g_byte_array_append (data, (const guint8 *) strings->str, strings->len);
+
+  dir = g_path_get_dirname (path);
+  if (g_mkdir_with_parents (dir, 0700) < 0)
+    {
+      int saved_errno = errno;
+
+      g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (saved_errno),
+                   "Failed to create '%s': %s", dir, g_strerror (saved_errno));
+      return FALSE;
+    }
+
+  return g_file_set_contents_full (path,
+                                   (const gchar *) data->data,
+                                   data->len,
+                                   G_FILE_SET_CONTENTS_CONSISTENT,
+                                   0600,
+                                   error);
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef __CALENDAR_SNAPSHOT_H__
+#define __CALENDAR_SNAPSHOT_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _CalendarSnapshot CalendarSnapshot;
+
+/* An event as stored in the snapshot. Strings point into the mapped
+ * snapshot and are valid as long as the snapshot is. */
+typedef struct
+{
+  const gchar *id;
+  const gchar *summary;
+  const gchar *color; /* may be NULL */
+  gint64       start_time;
+  gint64       end_time;
+} CalendarSnapshotEvent;
+
+gchar            *calendar_snapshot_get_default_path (void);
+
+CalendarSnapshot *calendar_snapshot_load             (const gchar            *path,
+                                                      GError                **error);
+void              calendar_snapshot_free             (CalendarSnapshot       *snapshot);
+gint64            calendar_snapshot_get_since        (CalendarSnapshot       *snapshot);
+gint64            calendar_snapshot_get_until        (CalendarSnapshot       *snapshot);
+guint             calendar_snapshot_get_n_events     (CalendarSnapshot       *snapshot);
+void              calendar_snapshot_get_event        (CalendarSnapshot       *snapshot,
+                                                      guint                   index,
+                                                      CalendarSnapshotEvent  *event);
+
+gboolean          calendar_snapshot_save             (const gchar            *path,
+                                                      gint64                  since,
+                                                      gint64                  until,
+                                                      GArray                 *events, /* CalendarSnapshotEvent */
+                                                      GError                **error);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (CalendarSnapshot, calendar_snapshot_free)
+
+G_END_DECLS
+
+#endif /* __CALENDAR_SNAPSHOT_H__ */
@@ -138,6 +138,20 @@ on_primary_monitor_changed (PhoshScalingQuickSetting *self, GParamSpec *pspec, P
 }
 
 
+static void
+on_apply_monitor_config_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  g_autoptr (GError) err = NULL;
+
+  if (!phosh_monitor_manager_apply_monitor_config_finish (PHOSH_MONITOR_MANAGER (source_object),
+                                                          res,
+                                                          &err)) {
+    /* The monitor manager already warned */
+    g_debug ("Failed to set monitor scale: %s", err->message);
+  }
+}
+
+
 static void
 set_scale (PhoshScalingQuickSetting *self, double scale)
 {
@@ -151,7 +165,10 @@ set_scale (PhoshScalingQuickSetting *self, double scale)
   g_debug ("Setting monior scale to %f", scale);
 
   phosh_monitor_manager_set_monitor_scale (monitor_manager, self->monitor, scale);
-  phosh_monitor_manager_apply_monitor_config (monitor_manager);
+  phosh_monitor_manager_apply_monitor_config_async (monitor_manager,
+                                                    NULL,
+                                                    on_apply_monitor_config_done,
+                                                    NULL);
 }
 
 
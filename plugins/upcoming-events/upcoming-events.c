@@ -168,19 +168,43 @@ update_event_lists_visibility (PhoshUpcomingEvents *self)
 
 #define EVENT_FORMAT "(&s&sxx@a{sv})"
 
+/*
+ * The calendar server batches up changes so we get a single signal per
+ * sync. Merge the sorted new and updated events with the untouched ones
+ * and apply the result with a single splice.
+ */
 static void
-on_events_added_or_updated (PhoshUpcomingEvents *self, GVariant *events)
+on_events_changed (PhoshUpcomingEvents *self, GVariant *added, GStrv removed)
 {
+  g_autoptr (GHashTable) touched = g_hash_table_new (NULL, NULL);
+  g_autoptr (GPtrArray) incoming = g_ptr_array_new_with_free_func (g_object_unref);
+  g_autoptr (GPtrArray) current = g_ptr_array_new_with_free_func (g_object_unref);
+  g_autoptr (GPtrArray) merged = g_ptr_array_new_with_free_func (g_object_unref);
   GVariantIter iter;
   gint64 begin, end;
   const char *id, *summary;
   GVariant *extra_dict;
   gboolean changed = FALSE;
+  guint n_items, first, last_old, last_new, j = 0;
+
+  /* Removed and updated events leave their current position */
+  for (int i = 0; removed && removed[i]; i++) {
+    PhoshCalendarEvent *event = g_hash_table_lookup (self->event_ids, removed[i]);
 
-  g_variant_iter_init (&iter, events);
+    if (!event)
+      continue;
+
+    /* Only used for identity, the store still holds a ref */
+    g_hash_table_add (touched, event);
+    g_hash_table_remove (self->event_ids, removed[i]);
+  }
+
+  g_variant_iter_init (&iter, added);
   while (g_variant_iter_next (&iter, EVENT_FORMAT, &id, &summary, &begin, &end, &extra_dict)) {
     PhoshCalendarEvent *event;
     g_auto (GVariantDict) dict = G_VARIANT_DICT_INIT (extra_dict);
+    g_autoptr (GDateTime) begin_dt = g_date_time_new_from_unix_local (begin);
+    g_autoptr (GDateTime) end_dt = g_date_time_new_from_unix_local (end);
     const char *color;
 
     if (g_variant_dict_lookup (&dict, "color", "&s", &color) == FALSE)
@@ -190,65 +214,83 @@ on_events_added_or_updated (PhoshUpcomingEvents *self, GVariant *events)
     if (event) {
       g_object_set (event,
                     "summary", summary,
-                    "begin", g_date_time_new_from_unix_local (begin),
-                    "end", g_date_time_new_from_unix_local (end),
+                    "begin", begin_dt,
+                    "end", end_dt,
                     "color", color,
                     NULL);
+      g_hash_table_add (touched, event);
+      g_ptr_array_add (incoming, g_object_ref (event));
       changed = TRUE;
       continue;
     }
 
-    event = phosh_calendar_event_new (id,
-                                      summary,
-                                      g_date_time_new_from_unix_local (begin),
-                                      g_date_time_new_from_unix_local (end),
-                                      color);
+    event = phosh_calendar_event_new (id, summary, begin_dt, end_dt, color);
     g_hash_table_insert (self->event_ids, g_strdup (id), g_object_ref (event));
-    g_list_store_insert_sorted (self->events,
-                                g_steal_pointer (&event),
-                                calendar_event_begin_compare,
-                                NULL);
+    g_ptr_array_add (incoming, event);
   }
 
-  update_event_lists_visibility (self);
-
-  if (changed == FALSE)
+  if (incoming->len == 0 && g_hash_table_size (touched) == 0)
     return;
 
-  /* Changed events might be tz change so refilter days */
-  for (int i = 0; i < self->event_lists->len; i++)
-    phosh_event_list_set_today (g_ptr_array_index (self->event_lists, i), self->since);
-}
+  g_ptr_array_sort_values_with_data (incoming, calendar_event_begin_compare, NULL);
 
-#undef EVENT_FORMAT
+  n_items = g_list_model_get_n_items (G_LIST_MODEL (self->events));
+  for (guint i = 0; i < n_items; i++)
+    g_ptr_array_add (current, g_list_model_get_item (G_LIST_MODEL (self->events), i));
 
-static void
-on_events_removed (PhoshUpcomingEvents *self, GStrv ids)
-{
-  int removed = 0;
+  for (guint i = 0; i < current->len; i++) {
+    PhoshCalendarEvent *event = g_ptr_array_index (current, i);
 
-  for (int i = 0; i < g_strv_length (ids); i++) {
-    const char *id = ids[i];
-    PhoshCalendarEvent *event;
-    guint pos;
-
-    event = g_hash_table_lookup (self->event_ids, id);
-    if (!event)
+    if (g_hash_table_contains (touched, event))
       continue;
 
-    if (g_list_store_find (self->events, event, &pos)) {
-      g_list_store_remove (self->events, pos);
-      removed++;
-    } else {
-      g_warning ("Found %s in hash but not in list", id);
+    while (j < incoming->len &&
+           calendar_event_begin_compare (g_ptr_array_index (incoming, j), event, NULL) < 0) {
+      g_ptr_array_add (merged, g_object_ref (g_ptr_array_index (incoming, j)));
+      j++;
     }
+    g_ptr_array_add (merged, g_object_ref (event));
+  }
+  for (; j < incoming->len; j++)
+    g_ptr_array_add (merged, g_object_ref (g_ptr_array_index (incoming, j)));
+
+  /* Only replace the range that actually changed */
+  first = 0;
+  while (first < current->len && first < merged->len &&
+         current->pdata[first] == merged->pdata[first])
+    first++;
+
+  last_old = current->len;
+  last_new = merged->len;
+  while (last_old > first && last_new > first &&
+         current->pdata[last_old - 1] == merged->pdata[last_new - 1]) {
+    last_old--;
+    last_new--;
+  }
+
+  g_debug ("Got %u new or updated and %d removed events, replacing %u items",
+           incoming->len, removed ? g_strv_length (removed) : 0, last_old - first);
 
-    g_hash_table_remove (self->event_ids, id);
+  if (first < last_old || first < last_new) {
+    g_list_store_splice (self->events,
+                         first,
+                         last_old - first,
+                         merged->pdata + first,
+                         last_new - first);
   }
 
-  g_debug ("Removed %d events of %d", removed, g_strv_length (ids));
+  update_event_lists_visibility (self);
+
+  if (changed == FALSE)
+    return;
+
+  /* Changed events might be tz change so refilter days */
+  for (int i = 0; i < self->event_lists->len; i++)
+    phosh_event_list_set_today (g_ptr_array_index (self->event_lists, i), self->since);
 }
 
+#undef EVENT_FORMAT
+
 
 static void setup_date_change_timeout (PhoshUpcomingEvents *self);
 
@@ -396,10 +438,8 @@ on_proxy_new_for_bus_finish (GObject      *source_object,
 
   g_debug ("CalendarServer initialized");
   g_object_connect (self->proxy,
-                    "swapped-object-signal::events-added-or-updated",
-                    G_CALLBACK (on_events_added_or_updated), self,
-                    "swapped-object-signal::events-removed",
-                    G_CALLBACK (on_events_removed), self,
+                    "swapped-object-signal::events-changed",
+                    G_CALLBACK (on_events_changed), self,
                     "swapped-object-signal::client-disappeared",
                     G_CALLBACK (on_client_disappeared), self,
                     NULL);
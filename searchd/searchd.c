@@ -22,6 +22,7 @@
 #include <glib-unix.h>
 
 #include <search-source.h>
+#include <search-result-batch.h>
 #include <search-result-meta.h>
 
 #define GROUP_NAME "Shell Search Provider"
@@ -38,6 +39,44 @@
  */
 
 
+/* The results last sent to the client as batch */
+typedef struct {
+  guint      serial;
+  /* element-type: Phosh.SearchResultMeta */
+  GPtrArray *results;
+} SentResults;
+
+
+static void
+sent_results_free (SentResults *sent)
+{
+  g_ptr_array_unref (sent->results);
+  g_free (sent);
+}
+
+
+/* A client that selected a results format */
+typedef struct {
+  char                     *sender;
+  guint                     watch_id;
+  GDBusConnection          *connection;
+  PhoshSearchResultsFormat  format;
+  /* key: char * (object path), value: SentResults * */
+  GHashTable               *sent_results;
+} SearchClient;
+
+
+static void
+search_client_free (SearchClient *client)
+{
+  g_clear_handle_id (&client->watch_id, g_bus_unwatch_name);
+  g_clear_object (&client->connection);
+  g_clear_pointer (&client->sent_results, g_hash_table_destroy);
+  g_free (client->sender);
+  g_free (client);
+}
+
+
 typedef struct _PhoshSearchApplicationPrivate PhoshSearchApplicationPrivate;
 struct _PhoshSearchApplicationPrivate {
   PhoshDBusSearch *object;
@@ -53,6 +92,10 @@ struct _PhoshSearchApplicationPrivate {
   GHashTable   *last_results;
   gboolean      doing_subsearch;
 
+  /* key: char * (unique bus name), value: SearchClient * */
+  GHashTable   *clients;
+  guint         batch_serial;
+
   char         *query;
   GStrv         query_parts;
 
@@ -80,6 +123,7 @@ phosh_search_application_finalize (GObject *object)
   g_clear_object (&priv->cancellable);
   g_clear_object (&priv->settings);
   g_clear_pointer (&priv->last_results, g_hash_table_destroy);
+  g_clear_pointer (&priv->clients, g_hash_table_destroy);
 
   g_clear_pointer (&priv->query, g_free);
   g_clear_pointer (&priv->query_parts, g_strfreev);
@@ -246,6 +290,8 @@ activate_result (PhoshDBusSearch       *interface,
 }
 
 
+static SearchClient *ensure_client (PhoshSearchApplication *self, GDBusMethodInvocation *invocation);
+
 static gboolean
 get_sources (PhoshDBusSearch *interface, GDBusMethodInvocation *invocation, gpointer user_data)
 {
@@ -255,6 +301,9 @@ get_sources (PhoshDBusSearch *interface, GDBusMethodInvocation *invocation, gpoi
   g_autoptr (GVariant) result = NULL;
   g_autoptr (GList) list = NULL;
 
+  /* Subscribers fetch the sources first, track them so they get results */
+  ensure_client (self, invocation);
+
   list = priv->sources;
 
   g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(ssu)"));
@@ -282,6 +331,8 @@ get_last_results (PhoshDBusSearch *interface, GDBusMethodInvocation *invocation,
   GHashTableIter iter;
   gpointer key, value;
 
+  ensure_client (self, invocation);
+
   g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{saa{sv}}"));
 
   g_hash_table_iter_init (&iter, priv->last_results);
@@ -309,6 +360,185 @@ get_last_results (PhoshDBusSearch *interface, GDBusMethodInvocation *invocation,
 }
 
 
+static GVariant *
+encode_results_batch (GPtrArray *base, guint base_serial, GPtrArray *results, guint serial)
+{
+  g_autoptr (GBytes) batch = NULL;
+
+  batch = phosh_search_result_batch_encode (base, base_serial, results, serial);
+
+  return g_variant_new_from_bytes (G_VARIANT_TYPE_BYTESTRING, batch, TRUE);
+}
+
+
+static void
+on_client_vanished (GDBusConnection *connection, const char *name, gpointer user_data)
+{
+  PhoshSearchApplication *self = PHOSH_SEARCH_APPLICATION (user_data);
+  PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
+
+  g_debug ("Client %s vanished", name);
+  g_hash_table_remove (priv->clients, name);
+}
+
+
+static SearchClient *
+ensure_client (PhoshSearchApplication *self, GDBusMethodInvocation *invocation)
+{
+  PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
+  const char *sender = g_dbus_method_invocation_get_sender (invocation);
+  SearchClient *client;
+
+  client = g_hash_table_lookup (priv->clients, sender);
+  if (client)
+    return client;
+
+  client = g_new0 (SearchClient, 1);
+  client->sender = g_strdup (sender);
+  client->connection = g_object_ref (g_dbus_method_invocation_get_connection (invocation));
+  client->format = PHOSH_SEARCH_RESULTS_FORMAT_DICT;
+  client->sent_results = g_hash_table_new_full (g_str_hash,
+                                                g_str_equal,
+                                                g_free,
+                                                (GDestroyNotify) sent_results_free);
+  client->watch_id = g_bus_watch_name_on_connection (client->connection,
+                                                     sender,
+                                                     G_BUS_NAME_WATCHER_FLAGS_NONE,
+                                                     NULL,
+                                                     on_client_vanished,
+                                                     self,
+                                                     NULL);
+  g_hash_table_insert (priv->clients, client->sender, client);
+
+  return client;
+}
+
+
+static gboolean
+set_results_format (PhoshDBusSearch       *interface,
+                    GDBusMethodInvocation *invocation,
+                    guint                  format,
+                    gpointer               user_data)
+{
+  PhoshSearchApplication *self = PHOSH_SEARCH_APPLICATION (user_data);
+  SearchClient *client;
+
+  if (format > PHOSH_SEARCH_RESULTS_FORMAT_BATCH) {
+    g_dbus_method_invocation_return_error (invocation,
+                                           G_DBUS_ERROR,
+                                           G_DBUS_ERROR_INVALID_ARGS,
+                                           "Unknown results format %u", format);
+    return TRUE;
+  }
+
+  client = ensure_client (self, invocation);
+  g_debug ("[SetResultsFormat] Using format %u for %s", format, client->sender);
+  client->format = format;
+  /* The client needs full batches first */
+  g_hash_table_remove_all (client->sent_results);
+
+  phosh_dbus_search_complete_set_results_format (interface, invocation);
+
+  return TRUE;
+}
+
+
+static gboolean
+get_source_results_batch (PhoshDBusSearch       *interface,
+                          GDBusMethodInvocation *invocation,
+                          const char            *source_id,
+                          gpointer               user_data)
+{
+  PhoshSearchApplication *self = PHOSH_SEARCH_APPLICATION (user_data);
+  g_autoptr (GPtrArray) empty = NULL;
+  SearchClient *client;
+  SentResults *sent;
+  GVariant *batch;
+
+  client = ensure_client (self, invocation);
+  sent = g_hash_table_lookup (client->sent_results, source_id);
+  if (sent) {
+    batch = encode_results_batch (NULL, 0, sent->results, sent->serial);
+  } else {
+    empty = g_ptr_array_new ();
+    batch = encode_results_batch (NULL, 0, empty, 0);
+  }
+
+  phosh_dbus_search_complete_get_source_results_batch (interface, invocation, batch);
+
+  return TRUE;
+}
+
+
+static void
+emit_results_batch (PhoshSearchApplication *self,
+                    SearchClient           *client,
+                    const char             *bus_path,
+                    GPtrArray              *metas,
+                    guint                   serial)
+{
+  PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
+  g_autoptr (GError) err = NULL;
+  SentResults *sent;
+  GVariant *batch;
+
+  sent = g_hash_table_lookup (client->sent_results, bus_path);
+  if (sent) {
+    batch = encode_results_batch (sent->results, sent->serial, metas, serial);
+    g_ptr_array_unref (sent->results);
+  } else {
+    batch = encode_results_batch (NULL, 0, metas, serial);
+    sent = g_new0 (SentResults, 1);
+    g_hash_table_insert (client->sent_results, g_strdup (bus_path), sent);
+  }
+  sent->serial = serial;
+  sent->results = g_ptr_array_ref (metas);
+
+  /* Only the client that asked for batches gets them */
+  if (!g_dbus_connection_emit_signal (client->connection,
+                                      client->sender,
+                                      g_dbus_interface_skeleton_get_object_path (
+                                        G_DBUS_INTERFACE_SKELETON (priv->object)),
+                                      "mobi.phosh.Shell.Search",
+                                      "SourceResultsBatch",
+                                      g_variant_new ("(s@ay)", bus_path, batch),
+                                      &err)) {
+    g_warning ("Failed to send results batch to %s: %s", client->sender, err->message);
+  }
+}
+
+
+static void
+emit_results (PhoshSearchApplication *self,
+              const char             *bus_path,
+              GPtrArray              *metas,
+              GVariant               *result)
+{
+  PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
+  gboolean all_batch = g_hash_table_size (priv->clients) > 0;
+  GHashTableIter iter;
+  SearchClient *client;
+  guint serial;
+
+  /* Clients agreed on a format so serials are shared */
+  serial = ++priv->batch_serial;
+
+  g_hash_table_iter_init (&iter, priv->clients);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&client)) {
+    if (client->format == PHOSH_SEARCH_RESULTS_FORMAT_BATCH)
+      emit_results_batch (self, client, bus_path, metas, serial);
+    else
+      all_batch = FALSE;
+  }
+
+  /* Keep broadcasting for clients that didn't select a format (or never
+   * called us) unless every client opted into batches. Batch clients
+   * ignore the broadcast. */
+  if (!all_batch)
+    phosh_dbus_search_emit_source_results_changed (priv->object, bus_path, g_variant_ref (result));
+}
+
+
 static void
 got_metas (GObject *source, GAsyncResult *res, gpointer user_data)
 {
@@ -316,8 +546,8 @@ got_metas (GObject *source, GAsyncResult *res, gpointer user_data)
   PhoshSearchApplicationPrivate *priv = phosh_search_application_get_instance_private (self);
   g_autoptr (GError) error = NULL;
   g_autoptr (GVariant) result = NULL;
+  g_autoptr (GPtrArray) metas = NULL;
   GVariantBuilder builder;
-  GPtrArray *metas;
   char *bus_path;
 
   metas = phosh_search_provider_get_result_meta_finish (PHOSH_SEARCH_PROVIDER (source),
@@ -340,7 +570,7 @@ got_metas (GObject *source, GAsyncResult *res, gpointer user_data)
 
   result = g_variant_builder_end (&builder);
 
-  phosh_dbus_search_emit_source_results_changed (priv->object, bus_path, g_variant_ref (result));
+  emit_results (self, bus_path, metas, result);
 
   g_hash_table_insert (priv->last_results, bus_path, g_variant_ref (result));
 }
@@ -518,6 +748,8 @@ query (PhoshDBusSearch       *interface,
   g_auto (GStrv) parts = NULL;
   int len = 0;
 
+  ensure_client (self, invocation);
+
   striped = g_strstrip (g_strdup (query));
   parts = g_regex_split (priv->splitter, striped, 0);
 
@@ -837,6 +1069,10 @@ phosh_search_application_init (PhoshSearchApplication *self)
                                               g_str_equal,
                                               g_free,
                                               (GDestroyNotify) g_variant_unref);
+  priv->clients = g_hash_table_new_full (g_str_hash,
+                                         g_str_equal,
+                                         NULL,
+                                         (GDestroyNotify) search_client_free);
   priv->providers = g_hash_table_new_full (g_str_hash,
                                            g_str_equal,
                                            g_free,
@@ -863,6 +1099,8 @@ phosh_search_application_init (PhoshSearchApplication *self)
                     "object-signal::handle-get-sources", get_sources, self,
                     "object-signal::handle-query", query, self,
                     "object-signal::handle-get-last-results", get_last_results, self,
+                    "object-signal::handle-set-results-format", set_results_format, self,
+                    "object-signal::handle-get-source-results-batch", get_source_results_batch, self,
                     NULL);
 
   reload_providers (self);
@@ -775,3 +775,50 @@ phosh_activity_get_thumbnail_allocation (PhoshActivity *self, GtkAllocation *all
 
   *allocation = priv->allocation;
 }
+
+/**
+ * phosh_activity_get_thumbnail_bytes:
+ * @self: The activity
+ *
+ * Get the memory used by the activity's thumbnail.
+ *
+ * Returns: The thumbnail's size in bytes or `0` if there's no thumbnail
+ */
+gsize
+phosh_activity_get_thumbnail_bytes (PhoshActivity *self)
+{
+  PhoshActivityPrivate *priv;
+  guint width, height, stride;
+
+  g_return_val_if_fail (PHOSH_IS_ACTIVITY (self), 0);
+  priv = phosh_activity_get_instance_private (self);
+
+  if (priv->thumbnail == NULL)
+    return 0;
+
+  phosh_thumbnail_get_size (priv->thumbnail, &width, &height, &stride);
+  return (gsize) stride * height;
+}
+
+/**
+ * phosh_activity_clear_thumbnail:
+ * @self: The activity
+ *
+ * Drop the activity's thumbnail to release its memory.
+ */
+void
+phosh_activity_clear_thumbnail (PhoshActivity *self)
+{
+  PhoshActivityPrivate *priv;
+
+  g_return_if_fail (PHOSH_IS_ACTIVITY (self));
+  priv = phosh_activity_get_instance_private (self);
+
+  if (priv->thumbnail == NULL)
+    return;
+
+  g_clear_pointer (&priv->surface, cairo_surface_destroy);
+  g_clear_object (&priv->thumbnail);
+
+  gtk_widget_queue_draw (GTK_WIDGET (self));
+}
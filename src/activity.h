@@ -18,3 +18,5 @@ void        phosh_activity_set_thumbnail (PhoshActivity *self,
                                           PhoshThumbnail *thumbnail);
 void        phosh_activity_get_thumbnail_allocation (PhoshActivity *self,
                                                      GtkAllocation *allocation);
+gsize       phosh_activity_get_thumbnail_bytes (PhoshActivity *self);
+void        phosh_activity_clear_thumbnail (PhoshActivity *self);
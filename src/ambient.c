@@ -26,6 +26,13 @@
 #define KEY_AUTOMATIC_HC_THRESHOLD  "automatic-high-contrast-threshold"
 
 #define NUM_VALUES              3
+#define SAMPLE_INTERVAL_MS      1000
+/* Weight of a new reading in the moving average */
+#define LEVEL_AVG_ALPHA         0.5
+/* Readings within this fraction of the average are considered stable */
+#define LEVEL_STABLE_DELTA      0.1
+/* Hysteresis band around the threshold */
+#define LEVEL_HYSTERESIS        0.1
 
 /**
  * PhoshAmbient:
@@ -34,6 +41,12 @@
  *
  * #PhoshAmbient handles enabling and disabling the ambient detection
  * based and toggles related actions.
+ *
+ * Light level changes that would toggle high contrast are confirmed by
+ * sampling a moving average of the sensor readings. Sampling stops as
+ * soon as the readings are stable and no switch is pending, the next
+ * light level change restarts it. While the screen is blanked the
+ * sensor is released.
  */
 
 enum {
@@ -56,7 +69,9 @@ typedef struct _PhoshAmbient {
   gboolean                 use_hc;
 
   guint                    sample_id;
-  GArray                  *values;
+  guint                    n_confirm;
+  double                   level_avg;
+  gboolean                 have_level;
 
   PhoshFader              *fader;
   guint                    fader_id;
@@ -145,53 +160,108 @@ switch_theme (PhoshAmbient *self, gboolean use_hc)
 
 
 static gboolean
-on_ambient_light_level_sample (gpointer data)
+get_wants_hc (PhoshAmbient *self, double level)
 {
-  PhoshAmbient *self = PHOSH_AMBIENT (data);
-  double level, threshold;
-  double avg = 0.0;
-  gboolean use_hc;
+  double threshold;
 
-  level = phosh_dbus_sensor_proxy_get_light_level (PHOSH_DBUS_SENSOR_PROXY (self->sensor_proxy_manager));
-  g_array_append_val (self->values, level);
+  threshold = g_settings_get_uint (self->phosh_settings, KEY_AUTOMATIC_HC_THRESHOLD);
+  /* Use a bit of hysteresis to not switch too often around the threshold */
+  threshold *= self->use_hc ? 1.0 - LEVEL_HYSTERESIS : 1.0 + LEVEL_HYSTERESIS;
 
-  if (self->values->len < NUM_VALUES)
-    return G_SOURCE_CONTINUE;
+  return level > threshold;
+}
 
-  for (int i = 0; i < self->values->len; i++)
-    avg += g_array_index (self->values, double, i);
 
-  avg /= self->values->len;
-  threshold = g_settings_get_uint (self->phosh_settings, KEY_AUTOMATIC_HC_THRESHOLD);
-  use_hc = avg > threshold;
+/* Feeds a reading into the moving average, returns whether it was close to the average */
+static gboolean
+update_level_avg (PhoshAmbient *self, double level)
+{
+  gboolean stable;
 
-  g_debug ("Avg: %f Switching theme to hc: %d", avg, use_hc);
-  switch_theme (self, use_hc);
+  if (!self->have_level) {
+    self->level_avg = level;
+    self->have_level = TRUE;
+    return TRUE;
+  }
+
+  stable = ABS (level - self->level_avg) <= LEVEL_STABLE_DELTA * MAX (self->level_avg, 1.0);
+  self->level_avg = LEVEL_AVG_ALPHA * level + (1.0 - LEVEL_AVG_ALPHA) * self->level_avg;
+
+  return stable;
+}
+
+
+static void
+reset_sampling (PhoshAmbient *self)
+{
+  g_clear_handle_id (&self->sample_id, g_source_remove);
+  self->n_confirm = 0;
+  self->have_level = FALSE;
+}
+
+
+static gboolean on_ambient_light_level_sample (gpointer data);
+
+static void
+schedule_sample (PhoshAmbient *self)
+{
+  g_return_if_fail (self->sample_id == 0);
+
+  self->sample_id = g_timeout_add (SAMPLE_INTERVAL_MS, on_ambient_light_level_sample, self);
+  g_source_set_name_by_id (self->sample_id, "[phosh] ambient_sample");
+}
+
+
+static gboolean
+on_ambient_light_level_sample (gpointer data)
+{
+  PhoshAmbient *self = PHOSH_AMBIENT (data);
+  double level;
+  gboolean stable, pending;
 
-  g_array_set_size (self->values, 0);
   self->sample_id = 0;
+
+  level = phosh_dbus_sensor_proxy_get_light_level (PHOSH_DBUS_SENSOR_PROXY (self->sensor_proxy_manager));
+  stable = update_level_avg (self, level);
+
+  pending = get_wants_hc (self, self->level_avg) != self->use_hc;
+  if (pending) {
+    self->n_confirm++;
+    if (self->n_confirm >= NUM_VALUES) {
+      g_debug ("Avg: %f Switching theme to hc: %d", self->level_avg, !self->use_hc);
+      switch_theme (self, !self->use_hc);
+      self->n_confirm = 0;
+      pending = FALSE;
+    }
+  } else {
+    self->n_confirm = 0;
+  }
+
+  if (stable && !pending) {
+    /* Readings settled, the next level change restarts sampling */
+    g_debug ("Ambient light level stable at %f", self->level_avg);
+    return G_SOURCE_REMOVE;
+  }
+
+  schedule_sample (self);
   return G_SOURCE_REMOVE;
 }
 
 
 static void
 on_ambient_light_level_changed (PhoshAmbient            *self,
-                                GParamSpec              *pspec,
+                                double                   level,
                                 PhoshSensorProxyManager *sensor)
 {
-  double level, hyst, threshold;
   const char *unit;
-  gboolean wants_hc;
 
   if (!self->claimed)
     return;
 
-  /* Currently sampling, ignoring changes */
+  /* Currently sampling, the sampler picks up the new value */
   if (self->sample_id)
     return;
 
-  threshold = g_settings_get_uint (self->phosh_settings, KEY_AUTOMATIC_HC_THRESHOLD);
-  level = phosh_dbus_sensor_proxy_get_light_level (PHOSH_DBUS_SENSOR_PROXY (self->sensor_proxy_manager));
   unit = phosh_dbus_sensor_proxy_get_light_level_unit (PHOSH_DBUS_SENSOR_PROXY (self->sensor_proxy_manager));
 
   g_debug ("Ambient light changed: %f %s", level, unit);
@@ -202,21 +272,15 @@ on_ambient_light_level_changed (PhoshAmbient            *self,
     return;
   }
 
-  /* Use a bit of hysteresis to not switch too often around the threshold */
-  hyst = (self->use_hc) ? 0.9 : 1.1;
-  threshold *= hyst;
+  update_level_avg (self, level);
 
-  wants_hc = level > threshold;
   /* New value wouldn't change anything, nothing to do */
-  if (wants_hc == self->use_hc)
+  if (get_wants_hc (self, level) == self->use_hc)
     return;
 
   /* new value would change hc mode, sample to see if it should stick */
-  g_return_if_fail (self->sample_id == 0);
-  g_return_if_fail (self->values->len == 0);
-  g_array_append_val (self->values, level);
-  self->sample_id = g_timeout_add_seconds (1, on_ambient_light_level_sample, self);
-  g_source_set_name_by_id (self->sample_id, "[phosh] ambient_sample");
+  self->n_confirm = 0;
+  schedule_sample (self);
 }
 
 
@@ -227,6 +291,7 @@ on_ambient_claimed (PhoshSensorProxyManager *sensor_proxy_manager,
 {
   g_autoptr (GError) err = NULL;
   gboolean success;
+  double level;
 
   success = phosh_dbus_sensor_proxy_call_claim_light_finish (
     PHOSH_DBUS_SENSOR_PROXY (sensor_proxy_manager),
@@ -240,7 +305,8 @@ on_ambient_claimed (PhoshSensorProxyManager *sensor_proxy_manager,
   g_debug ("Claimed ambient sensor");
   self->claimed = TRUE;
 
-  on_ambient_light_level_changed (self, NULL, self->sensor_proxy_manager);
+  level = phosh_dbus_sensor_proxy_get_light_level (PHOSH_DBUS_SENSOR_PROXY (sensor_proxy_manager));
+  on_ambient_light_level_changed (self, level, sensor_proxy_manager);
 }
 
 
@@ -282,8 +348,7 @@ phosh_ambient_claim_light (PhoshAmbient *self, gboolean claim)
       (GAsyncReadyCallback)on_ambient_claimed,
       self);
   } else {
-    g_clear_handle_id (&self->sample_id, g_source_remove);
-    g_array_set_size (self->values, 0);
+    reset_sampling (self);
     phosh_dbus_sensor_proxy_call_release_light (
       PHOSH_DBUS_SENSOR_PROXY (self->sensor_proxy_manager),
       self->cancel,
@@ -298,13 +363,15 @@ on_automatic_high_contrast_changed (PhoshAmbient *self,
                                     GParamSpec   *pspec,
                                     GSettings    *settings)
 {
+  PhoshDBusSensorProxy *proxy = PHOSH_DBUS_SENSOR_PROXY (self->sensor_proxy_manager);
   gboolean enable;
 
   enable = g_settings_get_boolean (self->phosh_settings, KEY_AUTOMATIC_HC);
 
   if (enable) {
     if (self->claimed)
-      on_ambient_light_level_changed (self, NULL, self->sensor_proxy_manager);
+      on_ambient_light_level_changed (self, phosh_dbus_sensor_proxy_get_light_level (proxy),
+                                      self->sensor_proxy_manager);
     else
       phosh_ambient_claim_light (self, TRUE);
   } else {
@@ -358,7 +425,7 @@ phosh_ambient_constructed (GObject *object)
   G_OBJECT_CLASS (phosh_ambient_parent_class)->constructed (object);
 
   g_object_connect (self->sensor_proxy_manager,
-                    "swapped-signal::notify::light-level",
+                    "swapped-signal::light-level-changed",
                     on_ambient_light_level_changed,
                     self,
                     "swapped-signal::notify::has-ambient-light",
@@ -393,8 +460,7 @@ phosh_ambient_dispose (GObject *object)
   g_cancellable_cancel (self->cancel);
   g_clear_object (&self->cancel);
 
-  g_clear_handle_id (&self->sample_id, g_source_remove);
-  g_clear_pointer (&self->values, g_array_unref);
+  reset_sampling (self);
 
   if (self->sensor_proxy_manager) {
     g_signal_handlers_disconnect_by_data (self->sensor_proxy_manager, self);
@@ -441,8 +507,6 @@ phosh_ambient_init (PhoshAmbient *self)
 
   self->cancel = g_cancellable_new ();
 
-  self->values = g_array_new (FALSE, FALSE, sizeof(double));
-
   self->interface_settings = g_settings_new (INTERFACE_SETTINGS);
   self->phosh_settings = g_settings_new (PHOSH_SETTINGS);
 
@@ -6,13 +6,30 @@
  * Author: Alexander Mikhaylenko <alexm@gnome.org>
  */
 
+#define G_LOG_DOMAIN "phosh-animation"
+
 #include "phosh-config.h"
 
 #include "animation.h"
 #include <handy.h>
 
+/**
+ * PhoshAnimation:
+ *
+ * A simple animation
+ *
+ * Running animations are driven by a timeline per toplevel so all
+ * animations on a surface share a single frame clock tick callback.
+ * Easing curves are evaluated from precomputed lookup tables.
+ */
+
 G_DEFINE_BOXED_TYPE (PhoshAnimation, phosh_animation, phosh_animation_ref, phosh_animation_unref)
 
+#define N_ANIMATION_TYPES (PHOSH_ANIMATION_TYPE_EASE_OUT_BOUNCE + 1)
+#define EASING_LUT_SIZE   256
+
+typedef struct _PhoshAnimationTimeline PhoshAnimationTimeline;
+
 struct _PhoshAnimation
 {
   gatomicrefcount ref_count;
@@ -27,13 +44,29 @@ struct _PhoshAnimation
   PhoshAnimationType type;
 
   gint64 start_time;
-  guint tick_cb_id;
+  gint64 run_duration; /* differs from duration when started in a group */
+  gint64 last_frame_time;
+  guint  dropped_frames;
+  PhoshAnimationTimeline *timeline;
 
   PhoshAnimationValueCallback value_cb;
   PhoshAnimationDoneCallback done_cb;
   gpointer user_data;
 };
 
+struct _PhoshAnimationTimeline
+{
+  GtkWidget *toplevel;
+  guint      tick_cb_id;
+  gboolean   in_tick;
+  GPtrArray *animations;
+};
+
+static double easing_lut[N_ANIMATION_TYPES][EASING_LUT_SIZE + 1];
+static GList *timelines;
+static gboolean outputs_off;
+static GQuark timeline_quark;
+
 static void
 set_value (PhoshAnimation *self,
            double          value)
@@ -88,8 +121,8 @@ ease_out_quintic (double t)
 }
 
 
-static inline double
-interpolate (PhoshAnimationType type, double t)
+static double
+ease (PhoshAnimationType type, double t)
 {
   switch (type) {
   case PHOSH_ANIMATION_TYPE_EASE_OUT_CUBIC:
@@ -109,31 +142,171 @@ interpolate (PhoshAnimationType type, double t)
   }
 }
 
+
+static void
+init_easing_lut (void)
+{
+  static gsize initialized;
+
+  if (!g_once_init_enter (&initialized))
+    return;
+
+  for (int type = 0; type < N_ANIMATION_TYPES; type++) {
+    for (int i = 0; i <= EASING_LUT_SIZE; i++)
+      easing_lut[type][i] = ease (type, (double) i / EASING_LUT_SIZE);
+  }
+
+  g_once_init_leave (&initialized, 1);
+}
+
+
+static inline double
+interpolate (PhoshAnimationType type, double t)
+{
+  double pos = CLAMP (t, 0.0, 1.0) * EASING_LUT_SIZE;
+  guint i = (guint) pos;
+
+  if (i >= EASING_LUT_SIZE)
+    return easing_lut[type][EASING_LUT_SIZE];
+
+  return LERP (easing_lut[type][i], easing_lut[type][i + 1], pos - i);
+}
+
+
+static void
+timeline_free (PhoshAnimationTimeline *timeline)
+{
+  timelines = g_list_remove (timelines, timeline);
+  g_ptr_array_unref (timeline->animations);
+  g_free (timeline);
+}
+
+
+static void
+timeline_drop (PhoshAnimationTimeline *timeline)
+{
+  /* Frees the timeline */
+  g_object_set_qdata (G_OBJECT (timeline->toplevel), timeline_quark, NULL);
+}
+
+
+static void
+timeline_remove (PhoshAnimationTimeline *timeline, PhoshAnimation *animation)
+{
+  animation->timeline = NULL;
+  g_ptr_array_remove (timeline->animations, animation);
+
+  /* The tick callback cleans up itself */
+  if (timeline->animations->len || timeline->in_tick)
+    return;
+
+  gtk_widget_remove_tick_callback (timeline->toplevel, timeline->tick_cb_id);
+  timeline_drop (timeline);
+}
+
+
+static void
+finish (PhoshAnimation *self)
+{
+  g_signal_handlers_disconnect_by_func (self->widget, phosh_animation_stop, self);
+
+  if (self->dropped_frames)
+    g_debug ("Animation %p dropped %u frames", self, self->dropped_frames);
+
+  self->done_cb (self->user_data);
+}
+
+
 static gboolean
-tick_cb (GtkWidget       *widget,
-         GdkFrameClock   *frame_clock,
-         PhoshAnimation  *self)
+timeline_tick_cb (GtkWidget     *toplevel,
+                  GdkFrameClock *frame_clock,
+                  gpointer       user_data)
 {
-  gint64 frame_time = gdk_frame_clock_get_frame_time (frame_clock) / 1000;
-  double t = (double) (frame_time - self->start_time) / self->duration;
+  PhoshAnimationTimeline *timeline = user_data;
+  g_autoptr (GPtrArray) animations = NULL;
+  g_autoptr (GPtrArray) done = NULL;
+  gint64 frame_time = gdk_frame_clock_get_frame_time (frame_clock);
+  gint64 refresh_interval;
+
+  gdk_frame_clock_get_refresh_info (frame_clock, frame_time, &refresh_interval, NULL);
+
+  /* Callbacks might start or stop animations, so work on a copy */
+  animations = g_ptr_array_copy (timeline->animations, (GCopyFunc) phosh_animation_ref, NULL);
+  g_ptr_array_set_free_func (animations, (GDestroyNotify) phosh_animation_unref);
+  done = g_ptr_array_new_with_free_func ((GDestroyNotify) phosh_animation_unref);
+
+  timeline->in_tick = TRUE;
+
+  for (guint i = 0; i < animations->len; i++) {
+    PhoshAnimation *animation = g_ptr_array_index (animations, i);
+    double t;
+
+    /* Stopped by a previous callback */
+    if (animation->timeline != timeline)
+      continue;
+
+    if (animation->last_frame_time && refresh_interval > 0) {
+      gint64 delta = frame_time - animation->last_frame_time;
+
+      if (delta > refresh_interval * 3 / 2)
+        animation->dropped_frames += (delta + refresh_interval / 2) / refresh_interval - 1;
+    }
+    animation->last_frame_time = frame_time;
+
+    t = (double) (frame_time - animation->start_time) / (animation->run_duration * 1000);
+    if (t >= 1) {
+      timeline_remove (timeline, animation);
+      set_value (animation, animation->value_to);
+      g_ptr_array_add (done, phosh_animation_ref (animation));
+      continue;
+    }
+
+    set_value (animation, LERP (animation->value_from, animation->value_to,
+                                interpolate (animation->type, t)));
+  }
 
-  if (t >= 1) {
-    self->tick_cb_id = 0;
+  /* All animations finishing in this frame reached their final value */
+  for (guint i = 0; i < done->len; i++)
+    finish (g_ptr_array_index (done, i));
 
-    set_value (self, self->value_to);
+  timeline->in_tick = FALSE;
 
-    g_signal_handlers_disconnect_by_func (self->widget, phosh_animation_stop, self);
+  if (timeline->animations->len)
+    return G_SOURCE_CONTINUE;
+
+  timeline->tick_cb_id = 0;
+  timeline_drop (timeline);
+  return G_SOURCE_REMOVE;
+}
 
-    self->done_cb (self->user_data);
 
-    return G_SOURCE_REMOVE;
+static void
+timeline_add (PhoshAnimation *self)
+{
+  PhoshAnimationTimeline *timeline;
+  GtkWidget *toplevel = gtk_widget_get_toplevel (self->widget);
+
+  if (G_UNLIKELY (timeline_quark == 0))
+    timeline_quark = g_quark_from_static_string ("phosh-animation-timeline");
+
+  timeline = g_object_get_qdata (G_OBJECT (toplevel), timeline_quark);
+  if (timeline == NULL) {
+    timeline = g_new0 (PhoshAnimationTimeline, 1);
+    timeline->toplevel = toplevel;
+    timeline->animations = g_ptr_array_new ();
+    g_object_set_qdata_full (G_OBJECT (toplevel), timeline_quark, timeline,
+                             (GDestroyNotify) timeline_free);
+    timelines = g_list_prepend (timelines, timeline);
   }
 
-  set_value (self, LERP (self->value_from, self->value_to, interpolate (self->type, t)));
+  if (!timeline->tick_cb_id)
+    timeline->tick_cb_id = gtk_widget_add_tick_callback (toplevel, timeline_tick_cb, timeline, NULL);
 
-  return G_SOURCE_CONTINUE;
+  g_ptr_array_add (timeline->animations, self);
+  self->timeline = timeline;
 }
 
+
 static void
 phosh_animation_free (PhoshAnimation *self)
 {
@@ -215,14 +388,44 @@ phosh_animation_unref (PhoshAnimation *self)
     phosh_animation_free (self);
 }
 
+static gboolean
+phosh_animation_should_skip (PhoshAnimation *self)
+{
+  return PHOSH_ANIMATION_SLOWDOWN == 0 ||
+    outputs_off ||
+    !hdy_get_enable_animations (self->widget) ||
+    !gtk_widget_get_mapped (self->widget) ||
+    self->duration <= 0;
+}
+
+
+static void
+phosh_animation_start_at (PhoshAnimation *self, gint64 start_time, gint64 duration)
+{
+  if (self->timeline)
+    timeline_remove (self->timeline, self);
+  else
+    g_signal_connect_swapped (self->widget, "unmap",
+                              G_CALLBACK (phosh_animation_stop), self);
+
+  init_easing_lut ();
+
+  self->start_time = start_time;
+  self->run_duration = duration;
+  self->last_frame_time = 0;
+  self->dropped_frames = 0;
+  timeline_add (self);
+}
+
+
 void
 phosh_animation_start (PhoshAnimation *self)
 {
+  GdkFrameClock *frame_clock;
+
   g_return_if_fail (self != NULL);
 
-  if (!hdy_get_enable_animations (self->widget) ||
-      !gtk_widget_get_mapped (self->widget) ||
-      self->duration <= 0) {
+  if (phosh_animation_should_skip (self)) {
     set_value (self, self->value_to);
 
     self->done_cb (self->user_data);
@@ -230,14 +433,46 @@ phosh_animation_start (PhoshAnimation *self)
     return;
   }
 
-  if (self->tick_cb_id)
-    gtk_widget_remove_tick_callback (self->widget, self->tick_cb_id);
-  else
-    g_signal_connect_swapped (self->widget, "unmap",
-                              G_CALLBACK (phosh_animation_stop), self);
+  frame_clock = gtk_widget_get_frame_clock (self->widget);
+  phosh_animation_start_at (self, gdk_frame_clock_get_frame_time (frame_clock), self->duration);
+}
+
+/**
+ * phosh_animation_start_group:
+ * @animations:(array length=n_animations): The animations to start
+ * @n_animations: The number of animations
+ *
+ * Starts the given animations so they finish together: All
+ * animations share the start time and run for the longest duration
+ * of the group. Animations finishing in the same frame reach their
+ * final value before the first done callback is invoked. The
+ * animations keep their own duration for later runs.
+ */
+void
+phosh_animation_start_group (PhoshAnimation **animations, guint n_animations)
+{
+  GdkFrameClock *frame_clock = NULL;
+  gint64 duration = 0, start_time;
+
+  g_return_if_fail (animations != NULL || n_animations == 0);
 
-  self->start_time = gdk_frame_clock_get_frame_time (gtk_widget_get_frame_clock (self->widget)) / 1000;
-  self->tick_cb_id = gtk_widget_add_tick_callback (self->widget, (GtkTickCallback) tick_cb, self, NULL);
+  for (guint i = 0; i < n_animations; i++) {
+    duration = MAX (duration, animations[i]->duration);
+
+    if (frame_clock == NULL && !phosh_animation_should_skip (animations[i]))
+      frame_clock = gtk_widget_get_frame_clock (animations[i]->widget);
+  }
+
+  start_time = frame_clock ? gdk_frame_clock_get_frame_time (frame_clock) : g_get_monotonic_time ();
+
+  for (guint i = 0; i < n_animations; i++) {
+    PhoshAnimation *animation = animations[i];
+
+    if (phosh_animation_should_skip (animation))
+      phosh_animation_start (animation);
+    else
+      phosh_animation_start_at (animation, start_time, duration);
+  }
 }
 
 void
@@ -245,15 +480,68 @@ phosh_animation_stop (PhoshAnimation *self)
 {
   g_return_if_fail (self != NULL);
 
-  if (!self->tick_cb_id)
+  if (!self->timeline)
     return;
 
-  gtk_widget_remove_tick_callback (self->widget, self->tick_cb_id);
-  self->tick_cb_id = 0;
+  timeline_remove (self->timeline, self);
+  finish (self);
+}
 
-  g_signal_handlers_disconnect_by_func (self->widget, phosh_animation_stop, self);
+/**
+ * phosh_animation_get_dropped_frames:
+ * @self: The animation
+ *
+ * Gets the number of frames the animation missed since it was last
+ * started.
+ *
+ * Returns: The number of dropped frames
+ */
+guint
+phosh_animation_get_dropped_frames (PhoshAnimation *self)
+{
+  g_return_val_if_fail (self != NULL, 0);
 
-  self->done_cb (self->user_data);
+  return self->dropped_frames;
+}
+
+/**
+ * phosh_animation_set_outputs_off:
+ * @off: Whether the outputs are off
+ *
+ * Tells the animation framework whether the outputs are off. As long
+ * as they are, running animations are finished right away and new
+ * animations skip to their final value without ticking.
+ */
+void
+phosh_animation_set_outputs_off (gboolean off)
+{
+  g_autoptr (GPtrArray) animations = NULL;
+
+  if (outputs_off == off)
+    return;
+
+  outputs_off = off;
+  if (!off)
+    return;
+
+  animations = g_ptr_array_new_with_free_func ((GDestroyNotify) phosh_animation_unref);
+  for (GList *l = timelines; l; l = l->next) {
+    PhoshAnimationTimeline *timeline = l->data;
+
+    for (guint i = 0; i < timeline->animations->len; i++)
+      g_ptr_array_add (animations, phosh_animation_ref (g_ptr_array_index (timeline->animations, i)));
+  }
+
+  for (guint i = 0; i < animations->len; i++) {
+    PhoshAnimation *animation = g_ptr_array_index (animations, i);
+
+    if (!animation->timeline)
+      continue;
+
+    timeline_remove (animation->timeline, animation);
+    set_value (animation, animation->value_to);
+    finish (animation);
+  }
 }
 
 gdouble
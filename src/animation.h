@@ -50,7 +50,11 @@ PhoshAnimation *phosh_animation_ref       (PhoshAnimation *self);
 void            phosh_animation_unref     (PhoshAnimation *self);
 
 void            phosh_animation_start     (PhoshAnimation *self);
+void            phosh_animation_start_group (PhoshAnimation **animations,
+                                             guint            n_animations);
 void            phosh_animation_stop      (PhoshAnimation *self);
+guint           phosh_animation_get_dropped_frames (PhoshAnimation *self);
+void            phosh_animation_set_outputs_off (gboolean off);
 
 double          phosh_animation_get_value (PhoshAnimation *self);
 
@@ -20,6 +20,7 @@
 #include "app-list-model.h"
 #include "favorite-list-model.h"
 #include "shell-priv.h"
+#include "trace.h"
 #include "util.h"
 
 #include "gtk-list-models/gtksortlistmodel.h"
@@ -270,6 +271,20 @@ update_filter_adaptive_button (PhoshAppGrid *self)
 }
 
 
+static void
+refilter (PhoshAppGrid *self)
+{
+  PhoshAppGridPrivate *priv = phosh_app_grid_get_instance_private (self);
+  gint64 trace = PHOSH_TRACE_BEGIN ();
+
+  gtk_filter_list_model_refilter (priv->model);
+
+  PHOSH_TRACE_END (trace, "app-grid-refilter", "'%s': %u apps",
+                   priv->search_string ?: "",
+                   g_list_model_get_n_items (G_LIST_MODEL (priv->model)));
+}
+
+
 static void
 on_filter_setting_changed (PhoshAppGrid *self,
                            GParamSpec   *pspec,
@@ -291,7 +306,7 @@ on_filter_setting_changed (PhoshAppGrid *self,
   show = !!(priv->filter_mode & PHOSH_APP_FILTER_MODE_FLAGS_ADAPTIVE);
   gtk_widget_set_visible (priv->btn_adaptive, show);
 
-  gtk_filter_list_model_refilter (priv->model);
+  refilter (self);
 }
 
 
@@ -397,12 +412,10 @@ favorites_changed (GListModel   *list,
                    guint         added,
                    PhoshAppGrid *self)
 {
-  PhoshAppGridPrivate *priv = phosh_app_grid_get_instance_private (self);
-
   toggle_favorites_revealer (self);
 
   /* We don't show favorites in the main list, filter them out */
-  gtk_filter_list_model_refilter (priv->model);
+  refilter (self);
 }
 
 
@@ -544,7 +557,7 @@ do_search (gpointer data)
   }
 
   toggle_favorites_revealer (self);
-  gtk_filter_list_model_refilter (priv->model);
+  refilter (self);
 
   priv->debounce = 0;
 }
@@ -830,6 +843,6 @@ phosh_app_grid_set_filter_adaptive (PhoshAppGrid *self, gboolean enable)
   priv->filter_adaptive = enable;
   update_filter_adaptive_button (self);
 
-  gtk_filter_list_model_refilter (priv->model);
+  refilter (self);
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_FILTER_ADAPTIVE]);
 }
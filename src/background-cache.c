@@ -12,6 +12,7 @@
 
 #include "background-cache.h"
 #include "background-image.h"
+#include "memory-registry.h"
 #include "util.h"
 
 #include <gio/gio.h>
@@ -54,11 +55,30 @@ on_background_image_loaded (GObject *source_object, GAsyncResult *res, gpointer
 }
 
 
+static void
+get_memory_usage (gpointer owner, gsize *bytes, guint *n_entries)
+{
+  PhoshBackgroundCache *self = PHOSH_BACKGROUND_CACHE (owner);
+  GHashTableIter iter;
+  PhoshBackgroundImage *image;
+
+  g_hash_table_iter_init (&iter, self->background_images);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&image)) {
+    GdkPixbuf *pixbuf = phosh_background_image_get_pixbuf (image);
+
+    if (pixbuf)
+      *bytes += gdk_pixbuf_get_byte_length (pixbuf);
+  }
+  *n_entries = g_hash_table_size (self->background_images);
+}
+
+
 static void
 phosh_background_cache_finalize (GObject *object)
 {
   PhoshBackgroundCache *self = PHOSH_BACKGROUND_CACHE (object);
 
+  phosh_memory_registry_remove (phosh_memory_registry_get_default (), self);
   g_clear_pointer (&self->background_images, g_hash_table_destroy);
 
   G_OBJECT_CLASS (phosh_background_cache_parent_class)->finalize (object);
@@ -81,6 +101,14 @@ phosh_background_cache_init (PhoshBackgroundCache *self)
                                                    (GEqualFunc) g_file_equal,
                                                    g_object_unref,
                                                    g_object_unref);
+
+  /* Backgrounds keep a reference to the images they use */
+  phosh_memory_registry_add (phosh_memory_registry_get_default (),
+                             "background-cache",
+                             PHOSH_MEMORY_PRIORITY_CACHE,
+                             self,
+                             get_memory_usage,
+                             (PhoshMemoryShrinkFunc) phosh_background_cache_clear_all);
 }
 
 /**
@@ -19,6 +19,7 @@
 #include "background-image.h"
 #include "background-manager.h"
 #include "layersurface-priv.h"
+#include "memory-registry.h"
 #include "shell-priv.h"
 #include "top-panel.h"
 #include "util.h"
@@ -331,11 +332,25 @@ phosh_background_configured (PhoshLayerSurface *layer_surface)
 }
 
 
+static void
+get_memory_usage (gpointer owner, gsize *bytes, guint *n_entries)
+{
+  PhoshBackground *self = PHOSH_BACKGROUND (owner);
+
+  /* The unscaled image is accounted for by the cache */
+  if (self->pixbuf) {
+    *bytes = gdk_pixbuf_get_byte_length (self->pixbuf);
+    *n_entries = 1;
+  }
+}
+
+
 static void
 phosh_background_finalize (GObject *object)
 {
   PhoshBackground *self = PHOSH_BACKGROUND (object);
 
+  phosh_memory_registry_remove (phosh_memory_registry_get_default (), self);
   g_cancellable_cancel (self->cancel_load);
   g_clear_object (&self->cancel_load);
   g_clear_object (&self->pixbuf);
@@ -384,6 +399,12 @@ phosh_background_class_init (PhoshBackgroundClass *klass)
 static void
 phosh_background_init (PhoshBackground *self)
 {
+  phosh_memory_registry_add (phosh_memory_registry_get_default (),
+                             "background",
+                             PHOSH_MEMORY_PRIORITY_ACTIVE,
+                             self,
+                             get_memory_usage,
+                             NULL);
 }
 
 
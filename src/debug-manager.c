@@ -0,0 +1,413 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-debug-manager"
+
+#include "phosh-config.h"
+
+#include "debug-manager.h"
+#include "layersurface-priv.h"
+#include "memory-registry.h"
+#include "sensor-proxy-manager.h"
+#include "shell-priv.h"
+
+#include <gtk/gtk.h>
+
+/**
+ * PhoshDebugManager:
+ *
+ * Provides the mobi.phosh.Shell.Debug DBus interface
+ *
+ * The interface allows to inspect the shell at runtime, e.g. to
+ * get the frame statistics of the layer surfaces, the memory
+ * held by caches, the sensor event rates or the startup times.
+ */
+
+#define DEBUG_DBUS_NAME "mobi.phosh.Shell.Debug"
+#define DEBUG_DBUS_PATH PHOSH_DBUS_PATH_PREFIX "/Debug"
+
+enum {
+  PROP_0,
+  PROP_SENSOR_PROXY_MANAGER,
+  PROP_LAST_PROP
+};
+static GParamSpec *props[PROP_LAST_PROP];
+
+static void phosh_debug_manager_debug_iface_init (PhoshDBusDebugIface *iface);
+
+struct _PhoshDebugManager {
+  PhoshDBusDebugSkeleton   parent;
+
+  int                      dbus_name_id;
+  PhoshSensorProxyManager *sensor_proxy_manager;
+};
+
+static const char *sensor_names[] = {
+  [PHOSH_SENSOR_TYPE_ACCELEROMETER] = "accelerometer",
+  [PHOSH_SENSOR_TYPE_LIGHT] = "light",
+  [PHOSH_SENSOR_TYPE_PROXIMITY] = "proximity",
+};
+G_STATIC_ASSERT (G_N_ELEMENTS (sensor_names) == PHOSH_SENSOR_TYPE_LAST);
+
+G_DEFINE_TYPE_WITH_CODE (PhoshDebugManager,
+                         phosh_debug_manager,
+                         PHOSH_DBUS_TYPE_DEBUG_SKELETON,
+                         G_IMPLEMENT_INTERFACE (PHOSH_DBUS_TYPE_DEBUG,
+                                                phosh_debug_manager_debug_iface_init));
+
+
+static GList *
+get_layer_surfaces (void)
+{
+  g_autoptr (GList) toplevels = gtk_window_list_toplevels ();
+  GList *surfaces = NULL;
+
+  for (GList *l = toplevels; l; l = l->next) {
+    if (PHOSH_IS_LAYER_SURFACE (l->data))
+      surfaces = g_list_prepend (surfaces, l->data);
+  }
+
+  return g_list_reverse (surfaces);
+}
+
+
+static gboolean
+handle_get_frame_stats (PhoshDBusDebug        *object,
+                        GDBusMethodInvocation *invocation)
+{
+  g_autoptr (GList) surfaces = get_layer_surfaces ();
+  GVariantBuilder builder;
+
+  g_debug ("DBus call GetFrameStats");
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sa{sv})"));
+  for (GList *l = surfaces; l; l = l->next) {
+    PhoshLayerSurface *surface = PHOSH_LAYER_SURFACE (l->data);
+    PhoshLayerSurfaceFrameStats stats;
+    g_autofree char *namespace = NULL;
+    GVariantBuilder dict;
+
+    g_object_get (surface, "namespace", &namespace, NULL);
+    phosh_layer_surface_get_frame_stats (surface, &stats);
+
+    g_variant_builder_init (&dict, G_VARIANT_TYPE_VARDICT);
+    g_variant_builder_add (&dict, "{sv}", "frames", g_variant_new_uint64 (stats.frames));
+    g_variant_builder_add (&dict, "{sv}", "commits", g_variant_new_uint64 (stats.commits));
+    g_variant_builder_add (&dict, "{sv}", "missed-vblanks",
+                           g_variant_new_uint64 (stats.missed_vblanks));
+    g_variant_builder_add (&dict, "{sv}", "layout-time", g_variant_new_int64 (stats.layout_time));
+    g_variant_builder_add (&dict, "{sv}", "layout-time-max",
+                           g_variant_new_int64 (stats.layout_time_max));
+    g_variant_builder_add (&dict, "{sv}", "paint-time", g_variant_new_int64 (stats.paint_time));
+    g_variant_builder_add (&dict, "{sv}", "paint-time-max",
+                           g_variant_new_int64 (stats.paint_time_max));
+    g_variant_builder_add (&dict, "{sv}", "mapped",
+                           g_variant_new_boolean (gtk_widget_get_mapped (GTK_WIDGET (surface))));
+
+    g_variant_builder_add (&builder, "(sa{sv})", namespace ?: "", &dict);
+  }
+
+  phosh_dbus_debug_complete_get_frame_stats (object, invocation, g_variant_builder_end (&builder));
+
+  return TRUE;
+}
+
+
+static gboolean
+handle_reset_frame_stats (PhoshDBusDebug        *object,
+                          GDBusMethodInvocation *invocation)
+{
+  g_autoptr (GList) surfaces = get_layer_surfaces ();
+
+  g_debug ("DBus call ResetFrameStats");
+
+  for (GList *l = surfaces; l; l = l->next)
+    phosh_layer_surface_reset_frame_stats (PHOSH_LAYER_SURFACE (l->data));
+
+  phosh_dbus_debug_complete_reset_frame_stats (object, invocation);
+
+  return TRUE;
+}
+
+
+static gboolean
+handle_get_memory_usage (PhoshDBusDebug        *object,
+                         GDBusMethodInvocation *invocation)
+{
+  g_autoptr (GArray) usages = NULL;
+  GVariantBuilder builder;
+
+  g_debug ("DBus call GetMemoryUsage");
+
+  usages = phosh_memory_registry_get_usage (phosh_memory_registry_get_default ());
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sa{sv})"));
+  for (guint i = 0; i < usages->len; i++) {
+    PhoshMemoryUsage *usage = &g_array_index (usages, PhoshMemoryUsage, i);
+    GVariantBuilder dict;
+
+    g_variant_builder_init (&dict, G_VARIANT_TYPE_VARDICT);
+    g_variant_builder_add (&dict, "{sv}", "bytes", g_variant_new_uint64 (usage->bytes));
+    g_variant_builder_add (&dict, "{sv}", "entries", g_variant_new_uint32 (usage->n_entries));
+    g_variant_builder_add (&dict, "{sv}", "owners", g_variant_new_uint32 (usage->n_owners));
+    g_variant_builder_add (&dict, "{sv}", "priority",
+                           g_variant_new_string (phosh_memory_priority_to_string (usage->priority)));
+
+    g_variant_builder_add (&builder, "(sa{sv})", usage->name, &dict);
+  }
+
+  phosh_dbus_debug_complete_get_memory_usage (object, invocation, g_variant_builder_end (&builder));
+
+  return TRUE;
+}
+
+
+static gboolean
+handle_shrink_memory (PhoshDBusDebug        *object,
+                      GDBusMethodInvocation *invocation,
+                      const char            *arg_priority)
+{
+  PhoshMemoryPriority priority;
+
+  g_debug ("DBus call ShrinkMemory %s", arg_priority);
+
+  for (priority = PHOSH_MEMORY_PRIORITY_CACHE; priority <= PHOSH_MEMORY_PRIORITY_ACTIVE; priority++) {
+    if (g_str_equal (arg_priority, phosh_memory_priority_to_string (priority)))
+      break;
+  }
+
+  if (priority > PHOSH_MEMORY_PRIORITY_ACTIVE) {
+    g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                           G_DBUS_ERROR_INVALID_ARGS,
+                                           "Invalid priority '%s'", arg_priority);
+    return TRUE;
+  }
+
+  phosh_memory_registry_shrink (phosh_memory_registry_get_default (), priority);
+  phosh_dbus_debug_complete_shrink_memory (object, invocation);
+
+  return TRUE;
+}
+
+
+static gboolean
+handle_get_sensor_stats (PhoshDBusDebug        *object,
+                         GDBusMethodInvocation *invocation)
+{
+  PhoshDebugManager *self = PHOSH_DEBUG_MANAGER (object);
+  GVariantBuilder builder;
+
+  g_debug ("DBus call GetSensorStats");
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sa{sv})"));
+  for (PhoshSensorType type = 0; self->sensor_proxy_manager && type < PHOSH_SENSOR_TYPE_LAST; type++) {
+    guint64 n_readings, n_events;
+    gint64 last_reading;
+    GVariantBuilder dict;
+
+    last_reading = phosh_sensor_proxy_manager_get_counters (self->sensor_proxy_manager, type,
+                                                            &n_readings, &n_events);
+
+    g_variant_builder_init (&dict, G_VARIANT_TYPE_VARDICT);
+    g_variant_builder_add (&dict, "{sv}", "readings", g_variant_new_uint64 (n_readings));
+    g_variant_builder_add (&dict, "{sv}", "events", g_variant_new_uint64 (n_events));
+    g_variant_builder_add (&dict, "{sv}", "last-reading", g_variant_new_int64 (last_reading));
+
+    g_variant_builder_add (&builder, "(sa{sv})", sensor_names[type], &dict);
+  }
+
+  phosh_dbus_debug_complete_get_sensor_stats (object, invocation, g_variant_builder_end (&builder));
+
+  return TRUE;
+}
+
+
+static gboolean
+handle_get_startup_stats (PhoshDBusDebug        *object,
+                          GDBusMethodInvocation *invocation)
+{
+  PhoshShell *shell = phosh_shell_get_default ();
+  g_auto (GStrv) stages = NULL;
+  GVariantBuilder builder;
+
+  g_debug ("DBus call GetStartupStats");
+
+  stages = phosh_shell_get_startup_stages (shell);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sa{sv})"));
+  for (int i = 0; stages[i]; i++) {
+    gint64 time = phosh_shell_get_startup_stage_time (shell, stages[i]);
+    GVariantBuilder dict;
+
+    g_variant_builder_init (&dict, G_VARIANT_TYPE_VARDICT);
+    g_variant_builder_add (&dict, "{sv}", "done", g_variant_new_boolean (time >= 0));
+    g_variant_builder_add (&dict, "{sv}", "time", g_variant_new_int64 (time));
+
+    g_variant_builder_add (&builder, "(sa{sv})", stages[i], &dict);
+  }
+
+  phosh_dbus_debug_complete_get_startup_stats (object, invocation, g_variant_builder_end (&builder));
+
+  return TRUE;
+}
+
+
+static void
+phosh_debug_manager_debug_iface_init (PhoshDBusDebugIface *iface)
+{
+  iface->handle_get_frame_stats = handle_get_frame_stats;
+  iface->handle_reset_frame_stats = handle_reset_frame_stats;
+  iface->handle_get_memory_usage = handle_get_memory_usage;
+  iface->handle_shrink_memory = handle_shrink_memory;
+  iface->handle_get_sensor_stats = handle_get_sensor_stats;
+  iface->handle_get_startup_stats = handle_get_startup_stats;
+}
+
+
+static void
+on_name_acquired (GDBusConnection *connection,
+                  const char      *name,
+                  gpointer         user_data)
+{
+  g_debug ("Acquired name %s", name);
+}
+
+
+static void
+on_name_lost (GDBusConnection *connection,
+              const char      *name,
+              gpointer         user_data)
+{
+  g_debug ("Lost or failed to acquire name %s", name);
+}
+
+
+static void
+on_bus_acquired (GDBusConnection *connection,
+                 const char      *name,
+                 gpointer         user_data)
+{
+  PhoshDebugManager *self = PHOSH_DEBUG_MANAGER (user_data);
+  g_autoptr (GError) err = NULL;
+
+  if (!g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (self),
+                                         connection,
+                                         DEBUG_DBUS_PATH,
+                                         &err)) {
+    g_warning ("Failed to export on %s: %s", DEBUG_DBUS_NAME, err->message);
+  }
+}
+
+
+static void
+phosh_debug_manager_dispose (GObject *object)
+{
+  PhoshDebugManager *self = PHOSH_DEBUG_MANAGER (object);
+
+  if (g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (self)))
+    g_dbus_interface_skeleton_unexport (G_DBUS_INTERFACE_SKELETON (self));
+
+  g_clear_handle_id (&self->dbus_name_id, g_bus_unown_name);
+  g_clear_object (&self->sensor_proxy_manager);
+
+  G_OBJECT_CLASS (phosh_debug_manager_parent_class)->dispose (object);
+}
+
+
+static void
+phosh_debug_manager_set_property (GObject      *object,
+                                  guint         property_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  PhoshDebugManager *self = PHOSH_DEBUG_MANAGER (object);
+
+  switch (property_id) {
+  case PROP_SENSOR_PROXY_MANAGER:
+    self->sensor_proxy_manager = g_value_dup_object (value);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_debug_manager_get_property (GObject    *object,
+                                  guint       property_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  PhoshDebugManager *self = PHOSH_DEBUG_MANAGER (object);
+
+  switch (property_id) {
+  case PROP_SENSOR_PROXY_MANAGER:
+    g_value_set_object (value, self->sensor_proxy_manager);
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
+static void
+phosh_debug_manager_constructed (GObject *object)
+{
+  PhoshDebugManager *self = PHOSH_DEBUG_MANAGER (object);
+
+  G_OBJECT_CLASS (phosh_debug_manager_parent_class)->constructed (object);
+
+  self->dbus_name_id = g_bus_own_name (G_BUS_TYPE_SESSION,
+                                       DEBUG_DBUS_NAME,
+                                       G_BUS_NAME_OWNER_FLAGS_ALLOW_REPLACEMENT |
+                                       G_BUS_NAME_OWNER_FLAGS_REPLACE,
+                                       on_bus_acquired,
+                                       on_name_acquired,
+                                       on_name_lost,
+                                       self,
+                                       NULL);
+}
+
+
+static void
+phosh_debug_manager_class_init (PhoshDebugManagerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->get_property = phosh_debug_manager_get_property;
+  object_class->set_property = phosh_debug_manager_set_property;
+  object_class->constructed = phosh_debug_manager_constructed;
+  object_class->dispose = phosh_debug_manager_dispose;
+
+  /**
+   * PhoshDebugManager:sensor-proxy-manager:
+   *
+   * The sensor proxy manager to report sensor statistics for
+   */
+  props[PROP_SENSOR_PROXY_MANAGER] =
+    g_param_spec_object ("sensor-proxy-manager", "", "",
+                         PHOSH_TYPE_SENSOR_PROXY_MANAGER,
+                         G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
+}
+
+
+static void
+phosh_debug_manager_init (PhoshDebugManager *self)
+{
+}
+
+
+PhoshDebugManager *
+phosh_debug_manager_new (PhoshSensorProxyManager *sensor_proxy_manager)
+{
+  return g_object_new (PHOSH_TYPE_DEBUG_MANAGER,
+                       "sensor-proxy-manager", sensor_proxy_manager,
+                       NULL);
+}
@@ -24,6 +24,11 @@
  * See #PhoshTopPanel for a usage example. Note that you need to
  * update folded/unfolded margins on the #PhoshLayerSurface's
  * `configured` event to adjust it to the proper sizes.
+ *
+ * Drag events from the compositor are latched and the
+ * #PhoshDragSurface::dragged signal is emitted at most once per
+ * frame with the most recent margin so subclasses update their
+ * state and commit it once per frame even on high rate touch screens.
  */
 
 enum {
@@ -59,6 +64,16 @@ typedef struct _PhoshDragSurfacePrivate {
   PhoshDragSurfaceDragMode                 drag_mode;
   guint                                    drag_handle;
   guint                                    exclusive;
+
+  /* Latched drag state */
+  guint                                    drag_tick_id;
+  int                                      pending_margin;
+  gint64                                   pending_time;
+  /* Drag latency stats */
+  guint                                    n_drag_events;
+  guint                                    n_drag_frames;
+  gint64                                   latency_sum;
+  gint64                                   latency_max;
 } PhoshDragSurfacePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (PhoshDragSurface, phosh_drag_surface, PHOSH_TYPE_LAYER_SURFACE)
@@ -140,6 +155,82 @@ phosh_drag_surface_get_property (GObject    *object,
 }
 
 
+static void
+emit_dragged (PhoshDragSurface *self, GdkFrameClock *frame_clock)
+{
+  PhoshDragSurfacePrivate *priv = phosh_drag_surface_get_instance_private (self);
+  gint64 presentation_time = 0, latency;
+
+  if (frame_clock) {
+    gint64 frame_time = gdk_frame_clock_get_frame_time (frame_clock);
+
+    /* Predicted time the frame hits the screen */
+    gdk_frame_clock_get_refresh_info (frame_clock, frame_time, NULL, &presentation_time);
+    presentation_time = MAX (presentation_time, frame_time);
+  }
+  if (!presentation_time)
+    presentation_time = g_get_monotonic_time ();
+
+  latency = MAX (presentation_time - priv->pending_time, 0);
+  priv->latency_sum += latency;
+  priv->latency_max = MAX (priv->latency_max, latency);
+  priv->n_drag_frames++;
+
+  g_signal_emit (self, signals[SIGNAL_DRAGGED], 0, priv->pending_margin);
+}
+
+
+static gboolean
+on_drag_tick (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer unused)
+{
+  emit_dragged (PHOSH_DRAG_SURFACE (widget), frame_clock);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+on_drag_tick_removed (gpointer data)
+{
+  PhoshDragSurface *self = PHOSH_DRAG_SURFACE (data);
+  PhoshDragSurfacePrivate *priv = phosh_drag_surface_get_instance_private (self);
+
+  priv->drag_tick_id = 0;
+}
+
+
+static void
+flush_dragged (PhoshDragSurface *self)
+{
+  PhoshDragSurfacePrivate *priv = phosh_drag_surface_get_instance_private (self);
+
+  if (!priv->drag_tick_id)
+    return;
+
+  gtk_widget_remove_tick_callback (GTK_WIDGET (self), priv->drag_tick_id);
+  emit_dragged (self, NULL);
+}
+
+
+static void
+reset_drag_stats (PhoshDragSurface *self)
+{
+  PhoshDragSurfacePrivate *priv = phosh_drag_surface_get_instance_private (self);
+
+  if (priv->n_drag_frames) {
+    g_debug ("DragSurface %p: %u events in %u frames, latency avg %.1fms, max %.1fms",
+             self, priv->n_drag_events, priv->n_drag_frames,
+             priv->latency_sum / (1000.0 * priv->n_drag_frames),
+             priv->latency_max / 1000.0);
+  }
+
+  priv->n_drag_events = 0;
+  priv->n_drag_frames = 0;
+  priv->latency_sum = 0;
+  priv->latency_max = 0;
+}
+
+
 static void
 drag_surface_handle_drag_end (void                                    *data,
                               struct zphoc_draggable_layer_surface_v1 *drag_surface_,
@@ -152,6 +243,10 @@ drag_surface_handle_drag_end (void                                    *data,
 
   priv = phosh_drag_surface_get_instance_private (self);
 
+  /* Make sure subclasses see the last margin before the state change */
+  flush_dragged (self);
+  reset_drag_stats (self);
+
   if (state == priv->drag_state)
     return;
 
@@ -173,7 +268,19 @@ drag_surface_handle_dragged (void                                    *data,
 
   priv = phosh_drag_surface_get_instance_private (self);
 
-  g_signal_emit (self, signals[SIGNAL_DRAGGED], 0, margin);
+  /* Latch the margin and only keep the earliest pending event's time
+   * so we measure the latency of the oldest input in a frame */
+  if (!priv->drag_tick_id)
+    priv->pending_time = g_get_monotonic_time ();
+  priv->pending_margin = margin;
+  priv->n_drag_events++;
+
+  if (!priv->drag_tick_id) {
+    priv->drag_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (self),
+                                                       on_drag_tick,
+                                                       self,
+                                                       on_drag_tick_removed);
+  }
 
   if (priv->drag_state == PHOSH_DRAG_SURFACE_STATE_DRAGGED)
     return;
@@ -271,6 +378,8 @@ phosh_drag_surface_dispose (GObject *object)
   PhoshDragSurface *self = PHOSH_DRAG_SURFACE (object);
   PhoshDragSurfacePrivate *priv = phosh_drag_surface_get_instance_private (self);
 
+  if (priv->drag_tick_id)
+    gtk_widget_remove_tick_callback (GTK_WIDGET (self), priv->drag_tick_id);
   g_clear_pointer (&priv->drag_surface, zphoc_draggable_layer_surface_v1_destroy);
 
   G_OBJECT_CLASS (phosh_drag_surface_parent_class)->dispose (object);
@@ -250,19 +250,46 @@ phosh_fader_hide (PhoshFader *self)
 {
   g_return_if_fail (PHOSH_IS_FADER (self));
 
-  if (self->fade_out_time == 0) {
-    gtk_widget_destroy (GTK_WIDGET (self));
-    return;
-  }
+  phosh_fader_hide_group (&self, 1);
+}
 
-  self->fadeout = phosh_animation_new (GTK_WIDGET (self),
-                                       0.0,
-                                       1.0,
-                                       self->fade_out_time * PHOSH_ANIMATION_SLOWDOWN,
-                                       self->fade_out_type,
-                                       (PhoshAnimationValueCallback) fadeout_value_cb,
-                                       (PhoshAnimationDoneCallback) fadeout_done_cb,
-                                       self);
+/**
+ * phosh_fader_hide_group:
+ * @faders:(array length=n_faders): The faders to hide
+ * @n_faders: The number of faders
+ *
+ * Fades out the given faders so they finish together, e.g. when
+ * faders on several monitors should disappear at once. Each fader
+ * gets destroyed once faded out.
+ */
+void
+phosh_fader_hide_group (PhoshFader **faders, guint n_faders)
+{
+  g_autoptr (GPtrArray) animations = g_ptr_array_new ();
+
+  g_return_if_fail (faders != NULL || n_faders == 0);
+
+  for (guint i = 0; i < n_faders; i++) {
+    PhoshFader *self = faders[i];
+
+    g_return_if_fail (PHOSH_IS_FADER (self));
+
+    if (self->fade_out_time == 0) {
+      gtk_widget_destroy (GTK_WIDGET (self));
+      continue;
+    }
+
+    g_clear_pointer (&self->fadeout, phosh_animation_unref);
+    self->fadeout = phosh_animation_new (GTK_WIDGET (self),
+                                         0.0,
+                                         1.0,
+                                         self->fade_out_time * PHOSH_ANIMATION_SLOWDOWN,
+                                         self->fade_out_type,
+                                         (PhoshAnimationValueCallback) fadeout_value_cb,
+                                         (PhoshAnimationDoneCallback) fadeout_done_cb,
+                                         self);
+    g_ptr_array_add (animations, self->fadeout);
+  }
 
-  phosh_animation_start (self->fadeout);
+  phosh_animation_start_group ((PhoshAnimation **) animations->pdata, animations->len);
 }
@@ -17,5 +17,7 @@ G_DECLARE_FINAL_TYPE (PhoshFader, phosh_fader, PHOSH, FADER, PhoshLayerSurface)
 
 PhoshFader      *phosh_fader_new                                (PhoshMonitor *monitor);
 void             phosh_fader_hide                               (PhoshFader   *self);
+void             phosh_fader_hide_group                         (PhoshFader  **faders,
+                                                                 guint         n_faders);
 
 G_END_DECLS
@@ -18,6 +18,7 @@
 #include "osk-manager.h"
 #include "style-manager.h"
 #include "feedback-manager.h"
+#include "trace.h"
 #include "util.h"
 
 #include <handy.h>
@@ -67,6 +68,7 @@ struct _PhoshHome
   gboolean   focus_app_search;
 
   PhoshHomeState state;
+  gint64         unfold_trace;
 
   /* Keybinding */
   GStrv           action_names;
@@ -493,16 +495,22 @@ on_drag_state_changed (PhoshHome *self)
       self->focus_app_search = FALSE;
     }
     phosh_home_set_background_alpha (self, 1.0);
+    PHOSH_TRACE_END (self->unfold_trace, "overview-open", "unfolded");
+    self->unfold_trace = 0;
     break;
   case PHOSH_DRAG_SURFACE_STATE_FOLDED:
     state = PHOSH_HOME_STATE_FOLDED;
     phosh_home_set_background_alpha (self, 0.0);
     phosh_overview_reset (PHOSH_OVERVIEW (self->overview));
+    PHOSH_TRACE_END (self->unfold_trace, "overview-open", "aborted");
+    self->unfold_trace = 0;
     break;
   case PHOSH_DRAG_SURFACE_STATE_DRAGGED:
     state = PHOSH_HOME_STATE_TRANSITION;
-    if (self->state == PHOSH_HOME_STATE_FOLDED)
+    if (self->state == PHOSH_HOME_STATE_FOLDED) {
+      self->unfold_trace = PHOSH_TRACE_BEGIN ();
       phosh_overview_refresh (PHOSH_OVERVIEW (self->overview));
+    }
     break;
   default:
     g_return_if_reached ();
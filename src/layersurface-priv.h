@@ -12,6 +12,28 @@
 
 G_BEGIN_DECLS
 
+/**
+ * PhoshLayerSurfaceFrameStats:
+ * @frames: The number of frames the frame clock went through
+ * @commits: The number of frames that were painted and committed
+ * @missed_vblanks: The number of refresh cycles frames were presented late
+ * @layout_time: The total time spent in the update and layout phases in µs
+ * @layout_time_max: The longest update and layout phase in µs
+ * @paint_time: The total time spent painting and committing in µs
+ * @paint_time_max: The longest paint in µs
+ *
+ * Frame statistics of a layer surface.
+ */
+typedef struct {
+  guint64 frames;
+  guint64 commits;
+  guint64 missed_vblanks;
+  gint64  layout_time;
+  gint64  layout_time_max;
+  gint64  paint_time;
+  gint64  paint_time_max;
+} PhoshLayerSurfaceFrameStats;
+
 GtkWidget *phosh_layer_surface_new (gpointer layer_shell,
                                     gpointer wl_output);
 struct     zwlr_layer_surface_v1 *phosh_layer_surface_get_layer_surface(PhoshLayerSurface *self);
@@ -46,5 +68,9 @@ void                              phosh_layer_surface_set_stacked_above (PhoshLa
 void                              phosh_layer_surface_set_stacked_below (PhoshLayerSurface *self,
                                                                          PhoshLayerSurface *target);
 gpointer                          phosh_layer_surface_get_wl_output (PhoshLayerSurface *self);
+void                              phosh_layer_surface_get_frame_stats (PhoshLayerSurface           *self,
+                                                                       PhoshLayerSurfaceFrameStats *stats);
+void                              phosh_layer_surface_reset_frame_stats (PhoshLayerSurface *self);
+void                              phosh_layer_surface_set_frame_stats_overlay (gboolean enable);
 
 G_END_DECLS
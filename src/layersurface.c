@@ -12,6 +12,7 @@
 #include "layersurface-priv.h"
 #include "phosh-wayland.h"
 #include "phoc-layer-shell-effects-unstable-v1-client-protocol.h"
+#include "trace.h"
 
 #include <gdk/gdkwayland.h>
 
@@ -75,8 +76,19 @@ typedef struct {
   /* stacked_layer_surface_v1 */
   PhoshLayerSurface            *stack_target;
   gboolean                      stack_above;
+
+  /* Frame statistics */
+  GdkFrameClock                *frame_clock;
+  gulong                        before_paint_id;
+  gulong                        after_paint_id;
+  gint64                        frame_start;
+  gint64                        paint_start;
+  gint64                        last_presented_counter;
+  PhoshLayerSurfaceFrameStats   frame_stats;
 } PhoshLayerSurfacePrivate;
 
+static gboolean frame_stats_overlay;
+
 G_DEFINE_TYPE_WITH_PRIVATE (PhoshLayerSurface, phosh_layer_surface, GTK_TYPE_WINDOW)
 
 
@@ -90,6 +102,7 @@ layer_surface_configure (void                         *data,
   PhoshLayerSurface *self = data;
   PhoshLayerSurfacePrivate *priv;
   gboolean changed = FALSE;
+  gint64 trace = PHOSH_TRACE_BEGIN ();
 
   g_return_if_fail (PHOSH_IS_LAYER_SURFACE (self));
   priv = phosh_layer_surface_get_instance_private (self);
@@ -111,6 +124,8 @@ layer_surface_configure (void                         *data,
   g_debug ("Configured '%s' (%p) (%dx%d)", priv->namespace, self, width, height);
   if (changed)
     g_signal_emit (self, signals[CONFIGURED], 0);
+
+  PHOSH_TRACE_END (trace, "layer-surface-configure", "%s %ux%u", priv->namespace, width, height);
 }
 
 
@@ -330,6 +345,133 @@ phosh_layer_surface_get_property (GObject    *object,
 }
 
 
+static void
+update_missed_vblanks (PhoshLayerSurface *self, GdkFrameClock *frame_clock)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+  gint64 counter = MAX (priv->last_presented_counter + 1,
+                        gdk_frame_clock_get_history_start (frame_clock));
+  gint64 current = gdk_frame_clock_get_frame_counter (frame_clock);
+
+  /* Frames become complete once the compositor sent presentation
+   * feedback so look at the ones we didn't check so far */
+  for (; counter < current; counter++) {
+    GdkFrameTimings *timings = gdk_frame_clock_get_timings (frame_clock, counter);
+    gint64 presented, predicted, refresh;
+
+    if (timings == NULL)
+      continue;
+
+    if (!gdk_frame_timings_get_complete (timings))
+      break;
+
+    priv->last_presented_counter = counter;
+
+    presented = gdk_frame_timings_get_presentation_time (timings);
+    predicted = gdk_frame_timings_get_predicted_presentation_time (timings);
+    refresh = gdk_frame_timings_get_refresh_interval (timings);
+    /* Frames without a commit are never presented */
+    if (presented == 0 || predicted == 0 || refresh == 0)
+      continue;
+
+    if (presented > predicted + refresh / 2)
+      priv->frame_stats.missed_vblanks += (presented - predicted + refresh / 2) / refresh;
+  }
+}
+
+
+static void
+on_before_paint (PhoshLayerSurface *self, GdkFrameClock *frame_clock)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+
+  priv->frame_start = g_get_monotonic_time ();
+  priv->paint_start = 0;
+}
+
+
+static void
+on_after_paint (PhoshLayerSurface *self, GdkFrameClock *frame_clock)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+  PhoshLayerSurfaceFrameStats *stats = &priv->frame_stats;
+  gint64 now = g_get_monotonic_time ();
+  gint64 layout_time, paint_time = 0;
+
+  if (priv->frame_start == 0)
+    return;
+
+  if (priv->paint_start) {
+    layout_time = priv->paint_start - priv->frame_start;
+    /* GTK commits the surface at the end of the paint phase */
+    paint_time = now - priv->paint_start;
+    stats->commits++;
+  } else {
+    layout_time = now - priv->frame_start;
+  }
+
+  stats->frames++;
+  stats->layout_time += layout_time;
+  stats->layout_time_max = MAX (stats->layout_time_max, layout_time);
+  stats->paint_time += paint_time;
+  stats->paint_time_max = MAX (stats->paint_time_max, paint_time);
+
+  priv->frame_start = 0;
+
+  update_missed_vblanks (self, frame_clock);
+}
+
+
+static gboolean
+on_draw (PhoshLayerSurface *self, cairo_t *cr)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+
+  if (priv->paint_start == 0)
+    priv->paint_start = g_get_monotonic_time ();
+
+  return GDK_EVENT_PROPAGATE;
+}
+
+
+static gboolean
+on_draw_after (PhoshLayerSurface *self, cairo_t *cr)
+{
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+  PhoshLayerSurfaceFrameStats *stats = &priv->frame_stats;
+  g_autoptr (PangoLayout) layout = NULL;
+  g_autofree char *text = NULL;
+  int width, height;
+
+  if (!frame_stats_overlay || stats->frames == 0)
+    return GDK_EVENT_PROPAGATE;
+
+  text = g_strdup_printf ("%s: %" G_GUINT64_FORMAT " frames, %" G_GUINT64_FORMAT " commits, "
+                          "%" G_GUINT64_FORMAT " missed, layout %.1f/%.1fms, paint %.1f/%.1fms",
+                          priv->namespace ?: "",
+                          stats->frames,
+                          stats->commits,
+                          stats->missed_vblanks,
+                          stats->layout_time / 1000.0 / stats->frames,
+                          stats->layout_time_max / 1000.0,
+                          stats->commits ? stats->paint_time / 1000.0 / stats->commits : 0.0,
+                          stats->paint_time_max / 1000.0);
+  layout = gtk_widget_create_pango_layout (GTK_WIDGET (self), text);
+  pango_layout_get_pixel_size (layout, &width, &height);
+
+  cairo_save (cr);
+  cairo_set_source_rgba (cr, 0.0, 0.0, 0.0, 0.6);
+  cairo_rectangle (cr, 0, 0, width, height);
+  cairo_fill (cr);
+  cairo_set_source_rgb (cr, 1.0, 1.0, 1.0);
+  cairo_move_to (cr, 0, 0);
+  pango_cairo_show_layout (cr, layout);
+  cairo_restore (cr);
+
+  return GDK_EVENT_PROPAGATE;
+}
+
+
 static void
 phosh_layer_surface_realize (GtkWidget *widget)
 {
@@ -344,6 +486,30 @@ phosh_layer_surface_realize (GtkWidget *widget)
   priv->wl_surface = gdk_wayland_window_get_wl_surface (gdk_window);
 
   gtk_window_set_decorated (GTK_WINDOW (self), FALSE);
+
+  priv->frame_clock = gtk_widget_get_frame_clock (widget);
+  priv->last_presented_counter = gdk_frame_clock_get_frame_counter (priv->frame_clock);
+  priv->before_paint_id = g_signal_connect_swapped (priv->frame_clock, "before-paint",
+                                                    G_CALLBACK (on_before_paint), self);
+  priv->after_paint_id = g_signal_connect_swapped (priv->frame_clock, "after-paint",
+                                                   G_CALLBACK (on_after_paint), self);
+}
+
+
+static void
+phosh_layer_surface_unrealize (GtkWidget *widget)
+{
+  PhoshLayerSurface *self = PHOSH_LAYER_SURFACE (widget);
+  PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
+
+  if (priv->frame_clock) {
+    g_clear_signal_handler (&priv->before_paint_id, priv->frame_clock);
+    g_clear_signal_handler (&priv->after_paint_id, priv->frame_clock);
+    priv->frame_clock = NULL;
+  }
+  priv->frame_start = 0;
+
+  GTK_WIDGET_CLASS (phosh_layer_surface_parent_class)->unrealize (widget);
 }
 
 
@@ -457,6 +623,7 @@ phosh_layer_surface_class_init (PhoshLayerSurfaceClass *klass)
   object_class->get_property = phosh_layer_surface_get_property;
 
   widget_class->realize = phosh_layer_surface_realize;
+  widget_class->unrealize = phosh_layer_surface_unrealize;
   widget_class->map = phosh_layer_surface_map;
   widget_class->unmap = phosh_layer_surface_unmap;
 
@@ -631,6 +798,10 @@ phosh_layer_surface_init (PhoshLayerSurface *self)
   PhoshLayerSurfacePrivate *priv = phosh_layer_surface_get_instance_private (self);
 
   priv->alpha = 1.0;
+
+  /* Bracket the class handler (and the ones of subclasses) */
+  g_signal_connect (self, "draw", G_CALLBACK (on_draw), NULL);
+  g_signal_connect_after (self, "draw", G_CALLBACK (on_draw_after), NULL);
 }
 
 
@@ -1013,3 +1184,53 @@ phosh_layer_surface_set_stacked_below (PhoshLayerSurface *self, PhoshLayerSurfac
 
   phosh_layer_surface_set_stacked (self, target, FALSE);
 }
+
+/**
+ * phosh_layer_surface_get_frame_stats:
+ * @self: The layer surface
+ * @stats:(out): The frame statistics
+ *
+ * Get the frame statistics of this surface since it was created or the last
+ * call to `phosh_layer_surface_reset_frame_stats()`.
+ */
+void
+phosh_layer_surface_get_frame_stats (PhoshLayerSurface *self, PhoshLayerSurfaceFrameStats *stats)
+{
+  PhoshLayerSurfacePrivate *priv;
+
+  g_return_if_fail (PHOSH_IS_LAYER_SURFACE (self));
+  g_return_if_fail (stats);
+
+  priv = phosh_layer_surface_get_instance_private (self);
+  *stats = priv->frame_stats;
+}
+
+/**
+ * phosh_layer_surface_reset_frame_stats:
+ * @self: The layer surface
+ *
+ * Reset the frame statistics of this surface.
+ */
+void
+phosh_layer_surface_reset_frame_stats (PhoshLayerSurface *self)
+{
+  PhoshLayerSurfacePrivate *priv;
+
+  g_return_if_fail (PHOSH_IS_LAYER_SURFACE (self));
+
+  priv = phosh_layer_surface_get_instance_private (self);
+  priv->frame_stats = (PhoshLayerSurfaceFrameStats) { 0 };
+}
+
+/**
+ * phosh_layer_surface_set_frame_stats_overlay:
+ * @enable: Whether to enable the overlay
+ *
+ * Whether layer surfaces should draw their frame statistics on top of their
+ * content. The overlay is updated whenever the surface redraws.
+ */
+void
+phosh_layer_surface_set_frame_stats_overlay (gboolean enable)
+{
+  frame_stats_overlay = enable;
+}
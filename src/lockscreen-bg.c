@@ -12,6 +12,7 @@
 
 #include "shell-priv.h"
 #include "lockscreen-bg.h"
+#include "memory-registry.h"
 #include "style-manager.h"
 #include "util.h"
 
@@ -117,11 +118,24 @@ on_theme_name_changed (PhoshLockscreenBg *self, GParamSpec *pspec, PhoshStyleMan
 }
 
 
+static void
+get_memory_usage (gpointer owner, gsize *bytes, guint *n_entries)
+{
+  PhoshLockscreenBg *self = PHOSH_LOCKSCREEN_BG (owner);
+
+  if (self->pixbuf) {
+    *bytes = gdk_pixbuf_get_byte_length (self->pixbuf);
+    *n_entries = 1;
+  }
+}
+
+
 static void
 phosh_lockscreen_bg_finalize (GObject *object)
 {
   PhoshLockscreenBg *self = PHOSH_LOCKSCREEN_BG (object);
 
+  phosh_memory_registry_remove (phosh_memory_registry_get_default (), self);
   g_clear_object (&self->bg_image);
   g_clear_object (&self->pixbuf);
 
@@ -158,6 +172,13 @@ phosh_lockscreen_bg_init (PhoshLockscreenBg *self)
                            G_CALLBACK (on_theme_name_changed),
                            self,
                            G_CONNECT_SWAPPED);
+
+  phosh_memory_registry_add (phosh_memory_registry_get_default (),
+                             "lockscreen-background",
+                             PHOSH_MEMORY_PRIORITY_ACTIVE,
+                             self,
+                             get_memory_usage,
+                             NULL);
 }
 
 
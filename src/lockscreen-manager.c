@@ -18,6 +18,7 @@
 #include "monitor/monitor.h"
 #include "phosh-wayland.h"
 #include "shell-priv.h"
+#include "trace.h"
 #include "util.h"
 
 #include <gmobile.h>
@@ -200,6 +201,7 @@ on_lockscreen_unlock (PhoshLockscreenManager *self, PhoshLockscreen *lockscreen)
   PhoshShell *shell = phosh_shell_get_default ();
   PhoshMonitorManager *monitor_manager = phosh_shell_get_monitor_manager (shell);
   PhoshMonitor *primary_monitor = phosh_shell_get_primary_monitor (shell);
+  gint64 trace = PHOSH_TRACE_BEGIN ();
 
   g_return_if_fail (PHOSH_IS_LOCKSCREEN (lockscreen));
   g_return_if_fail (lockscreen == PHOSH_LOCKSCREEN (self->lockscreen));
@@ -215,6 +217,8 @@ on_lockscreen_unlock (PhoshLockscreenManager *self, PhoshLockscreen *lockscreen)
   self->locked = FALSE;
   self->active_time = 0;
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_LOCKED]);
+
+  PHOSH_TRACE_END (trace, "unlock", "unlocked");
 }
 
 
@@ -362,6 +366,7 @@ lockscreen_lock (PhoshLockscreenManager *self)
   PhoshMonitor *primary_monitor;
   PhoshShell *shell = phosh_shell_get_default ();
   PhoshMonitorManager *monitor_manager = phosh_shell_get_monitor_manager (shell);
+  gint64 trace;
 
   g_return_if_fail (!self->locked);
 
@@ -369,6 +374,8 @@ lockscreen_lock (PhoshLockscreenManager *self)
   if (self->locking)
     return;
 
+  trace = PHOSH_TRACE_BEGIN ();
+
   self->locking = TRUE;
   primary_monitor = phosh_shell_get_primary_monitor (shell);
 
@@ -408,6 +415,8 @@ lockscreen_lock (PhoshLockscreenManager *self)
   self->locking = FALSE;
   self->active_time = g_get_monotonic_time ();
   g_object_notify_by_pspec (G_OBJECT (self), props[PROP_LOCKED]);
+
+  PHOSH_TRACE_END (trace, "lock", "%u shields", self->shields->len);
 }
 
 
@@ -11,16 +11,36 @@
 #include "phosh-config.h"
 #include "log.h"
 
+#include <signal.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 
 /* these are emitted by the default log handler */
 #define DEFAULT_LEVELS (G_LOG_LEVEL_ERROR | G_LOG_LEVEL_CRITICAL | G_LOG_LEVEL_WARNING | G_LOG_LEVEL_MESSAGE)
 /* these are filtered by G_MESSAGES_DEBUG by the default log handler */
 #define INFO_LEVELS (G_LOG_LEVEL_INFO | G_LOG_LEVEL_DEBUG)
 
+/* Domains get a bit in the mask, the topmost one means "all" */
+#define LOG_MAX_DOMAINS 31
+#define LOG_DOMAIN_ALL  (1u << LOG_MAX_DOMAINS)
+
+#define LOG_RING_ENTRY_SIZE 256
+
 static gboolean       _log_writer_func_set;
-static char          *_log_domains;
+/* Append only so the writer can look up domains without a lock */
+static const char    *_log_domain_names[LOG_MAX_DOMAINS];
+static guint          _log_n_domain_names;
+static guint          _log_domain_mask;
 G_LOCK_DEFINE_STATIC (_log_domains);
+G_LOCK_DEFINE_STATIC (_log_output);
+
+static char          *_log_ring;
+static guint          _log_ring_size;
+static guint          _log_ring_next;
+G_LOCK_DEFINE_STATIC (_log_ring);
+
+static const int      _log_crash_signals[] = { SIGABRT, SIGBUS, SIGFPE, SIGILL, SIGSEGV };
 
 static gboolean
 log_is_old_api (const GLogField *fields,
@@ -32,6 +52,116 @@ log_is_old_api (const GLogField *fields,
 }
 
 
+static const char *
+log_get_field (const GLogField *fields,
+               gsize            n_fields,
+               const char      *key)
+{
+  for (gsize i = 0; i < n_fields; i++) {
+    if (g_strcmp0 (fields[i].key, key) == 0)
+      return fields[i].value;
+  }
+
+  return NULL;
+}
+
+
+static int
+log_domain_lookup (const char *log_domain)
+{
+  guint n_domains = g_atomic_int_get (&_log_n_domain_names);
+
+  for (guint i = 0; i < n_domains; i++) {
+    if (strcmp (_log_domain_names[i], log_domain) == 0)
+      return i;
+  }
+
+  return -1;
+}
+
+
+static gboolean
+log_domain_enabled (const GLogField *fields,
+                    gsize            n_fields)
+{
+  guint mask = g_atomic_int_get (&_log_domain_mask);
+  const char *log_domain;
+  int bit;
+
+  if (mask == 0)
+    return FALSE;
+
+  if (mask & LOG_DOMAIN_ALL)
+    return TRUE;
+
+  log_domain = log_get_field (fields, n_fields, "GLIB_DOMAIN");
+  if (log_domain == NULL)
+    return FALSE;
+
+  bit = log_domain_lookup (log_domain);
+  return bit >= 0 && (mask & (1u << bit));
+}
+
+
+static void
+log_ring_append (GLogLevelFlags   log_level,
+                 const GLogField *fields,
+                 gsize            n_fields)
+{
+  const char *log_domain = log_get_field (fields, n_fields, "GLIB_DOMAIN");
+  const char *message = log_get_field (fields, n_fields, "MESSAGE");
+  char *entry;
+  gint64 now = g_get_monotonic_time ();
+
+  G_LOCK (_log_ring);
+  entry = _log_ring + (_log_ring_next % _log_ring_size) * LOG_RING_ENTRY_SIZE;
+  g_snprintf (entry, LOG_RING_ENTRY_SIZE, "%" G_GINT64_FORMAT ".%06" G_GINT64_FORMAT " %s-%s: %s",
+              now / G_USEC_PER_SEC, now % G_USEC_PER_SEC,
+              log_domain ?: "**",
+              (log_level & G_LOG_LEVEL_DEBUG) ? "DEBUG" :
+              (log_level & G_LOG_LEVEL_INFO) ? "INFO" :
+              (log_level & G_LOG_LEVEL_MESSAGE) ? "MESSAGE" :
+              (log_level & G_LOG_LEVEL_WARNING) ? "WARNING" :
+              (log_level & G_LOG_LEVEL_CRITICAL) ? "CRITICAL" : "ERROR",
+              message ?: "");
+  _log_ring_next++;
+  G_UNLOCK (_log_ring);
+}
+
+
+static void
+log_dump_ring_unlocked (int fd)
+{
+  guint start, end;
+
+  end = _log_ring_next;
+  start = end > _log_ring_size ? end - _log_ring_size : 0;
+
+  /* Only async signal safe functions from here on */
+  for (guint i = start; i < end; i++) {
+    const char *entry = _log_ring + (i % _log_ring_size) * LOG_RING_ENTRY_SIZE;
+
+    if (write (fd, entry, strnlen (entry, LOG_RING_ENTRY_SIZE)) < 0 ||
+        write (fd, "\n", 1) < 0)
+      return;
+  }
+}
+
+
+static void
+on_crash_signal (int signum)
+{
+  static const char header[] = "Recent log messages:\n";
+
+  /* Don't take the lock, we might have crashed while holding it */
+  if (write (STDERR_FILENO, header, sizeof (header) - 1) > 0)
+    log_dump_ring_unlocked (STDERR_FILENO);
+
+  /* The handler got reset, so this crashes for real */
+  raise (signum);
+}
+
+
 static void
 _phosh_log_abort (gboolean breakpoint)
 {
@@ -55,32 +185,18 @@ phosh_log_writer_default (GLogLevelFlags   log_level,
   g_return_val_if_fail (fields != NULL, G_LOG_WRITER_UNHANDLED);
   g_return_val_if_fail (n_fields > 0, G_LOG_WRITER_UNHANDLED);
 
-  G_LOCK (_log_domains);
+  if (g_atomic_pointer_get (&_log_ring))
+    log_ring_append (log_level, fields, n_fields);
 
-  /* Disable debug message output unless specified in _log_domains. */
+  /* Disable debug message output unless the domain is enabled. This
+   * needs to be cheap as it's hit by every g_debug (). */
   if (!(log_level & DEFAULT_LEVELS) && !(log_level >> G_LOG_LEVEL_USER_SHIFT)) {
-    const char *log_domain = NULL;
-    gsize i;
-
-    if ((log_level & INFO_LEVELS) == 0 || _log_domains == NULL) {
-      G_UNLOCK (_log_domains);
+    if ((log_level & INFO_LEVELS) == 0 || !log_domain_enabled (fields, n_fields))
       return G_LOG_WRITER_HANDLED;
-    }
-
-    for (i = 0; i < n_fields; i++) {
-      if (g_strcmp0 (fields[i].key, "GLIB_DOMAIN") == 0) {
-        log_domain = fields[i].value;
-        break;
-      }
-    }
-
-    if (strcmp (_log_domains, "all") != 0 &&
-        (log_domain == NULL || !strstr (_log_domains, log_domain))) {
-      G_UNLOCK (_log_domains);
-      return G_LOG_WRITER_HANDLED;
-    }
   }
 
+  G_LOCK (_log_output);
+
   /* Need to retrieve this from glib via getting and resetting:
    * https://gitlab.gnome.org/GNOME/glib/-/issues/2217 */
   always_fatal = g_log_set_always_fatal (0);
@@ -96,15 +212,15 @@ phosh_log_writer_default (GLogLevelFlags   log_level,
   }
 
   if (stderr_is_journal &&
-      g_log_writer_journald (log_level, fields, n_fields, _log_domains) ==
+      g_log_writer_journald (log_level, fields, n_fields, NULL) ==
       G_LOG_WRITER_HANDLED)
     goto handled;
 
-  if (g_log_writer_standard_streams (log_level, fields, n_fields, _log_domains) ==
+  if (g_log_writer_standard_streams (log_level, fields, n_fields, NULL) ==
       G_LOG_WRITER_HANDLED)
     goto handled;
 
-  G_UNLOCK (_log_domains);
+  G_UNLOCK (_log_output);
   return G_LOG_WRITER_UNHANDLED;
 
 handled:
@@ -113,10 +229,22 @@ handled:
     _phosh_log_abort (!(log_level & G_LOG_FLAG_RECURSION));
   }
 
-  G_UNLOCK (_log_domains);
+  G_UNLOCK (_log_output);
   return G_LOG_WRITER_HANDLED;
 }
 
+
+static void
+phosh_log_set_writer_func (void)
+{
+  if (_log_writer_func_set)
+    return;
+
+  g_log_set_writer_func ((GLogWriterFunc)phosh_log_writer_default,
+                         NULL, NULL);
+  _log_writer_func_set = TRUE;
+}
+
 /**
  * phosh_log_set_log_domains:
  * @domains: comma separated list of log domains.
@@ -127,15 +255,92 @@ handled:
 void
 phosh_log_set_log_domains (const char *domains)
 {
+  g_auto (GStrv) names = NULL;
+  guint mask = 0;
+
+  if (domains)
+    names = g_strsplit_set (domains, ", ", -1);
+
   G_LOCK (_log_domains);
-  g_free (_log_domains);
-  _log_domains = g_strdup (domains);
+  for (guint i = 0; names && names[i]; i++) {
+    int bit;
+
+    if (names[i][0] == '\0')
+      continue;
+
+    if (g_str_equal (names[i], "all")) {
+      mask |= LOG_DOMAIN_ALL;
+      continue;
+    }
+
+    bit = log_domain_lookup (names[i]);
+    if (bit < 0) {
+      if (_log_n_domain_names == LOG_MAX_DOMAINS) {
+        g_warning ("Too many log domains, ignoring '%s'", names[i]);
+        continue;
+      }
+
+      /* Set the name before publishing it to the writer */
+      bit = _log_n_domain_names;
+      _log_domain_names[bit] = g_intern_string (names[i]);
+      g_atomic_int_set (&_log_n_domain_names, bit + 1);
+    }
+    mask |= 1u << bit;
+  }
+  g_atomic_int_set (&_log_domain_mask, mask);
   G_UNLOCK (_log_domains);
 
-  if (_log_writer_func_set)
+  phosh_log_set_writer_func ();
+}
+
+/**
+ * phosh_log_set_ring_size:
+ * @n_entries: The number of messages to keep
+ *
+ * Keep the last @n_entries log messages (including debug messages
+ * of domains that aren't enabled) in memory and dump them to stderr when
+ * the process crashes. This sets an appropriate log handler as well. Can
+ * only be called once.
+ */
+void
+phosh_log_set_ring_size (guint n_entries)
+{
+  struct sigaction sa = { 0 };
+
+  g_return_if_fail (_log_ring == NULL);
+
+  if (n_entries == 0)
     return;
 
-  g_log_set_writer_func ((GLogWriterFunc)phosh_log_writer_default,
-                         NULL, NULL);
-  _log_writer_func_set = TRUE;
+  G_LOCK (_log_ring);
+  _log_ring_size = n_entries;
+  _log_ring_next = 0;
+  g_atomic_pointer_set (&_log_ring, g_malloc0_n (n_entries, LOG_RING_ENTRY_SIZE));
+  G_UNLOCK (_log_ring);
+
+  sa.sa_handler = on_crash_signal;
+  sa.sa_flags = SA_RESETHAND;
+  sigemptyset (&sa.sa_mask);
+  for (guint i = 0; i < G_N_ELEMENTS (_log_crash_signals); i++)
+    sigaction (_log_crash_signals[i], &sa, NULL);
+
+  phosh_log_set_writer_func ();
+}
+
+/**
+ * phosh_log_dump_ring:
+ * @fd: The file descriptor to write to
+ *
+ * Write the log messages kept in memory to @fd, oldest first. See
+ * `phosh_log_set_ring_size()`.
+ */
+void
+phosh_log_dump_ring (int fd)
+{
+  if (g_atomic_pointer_get (&_log_ring) == NULL)
+    return;
+
+  G_LOCK (_log_ring);
+  log_dump_ring_unlocked (fd);
+  G_UNLOCK (_log_ring);
 }
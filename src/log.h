@@ -13,5 +13,7 @@
 G_BEGIN_DECLS
 
 void             phosh_log_set_log_domains (const char *domains);
+void             phosh_log_set_ring_size   (guint       n_entries);
+void             phosh_log_dump_ring       (int         fd);
 
 G_END_DECLS
@@ -154,6 +154,8 @@ main (int argc, char *argv[])
     print_version ();
 
   phosh_log_set_log_domains (g_getenv ("G_MESSAGES_DEBUG"));
+  if (g_getenv ("PHOSH_LOG_RING"))
+    phosh_log_set_ring_size (g_ascii_strtoull (g_getenv ("PHOSH_LOG_RING"), NULL, 10));
 
   textdomain (GETTEXT_PACKAGE);
   bind_textdomain_codeset (GETTEXT_PACKAGE, "UTF-8");
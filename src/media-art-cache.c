@@ -0,0 +1,448 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-media-art-cache"
+
+#include "phosh-config.h"
+
+#include "media-art-cache.h"
+#include "memory-registry.h"
+
+#include <libsoup/soup.h>
+
+#include <math.h>
+
+#define MAX_ENTRIES 32
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (cairo_t, cairo_destroy)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (cairo_surface_t, cairo_surface_destroy)
+
+/**
+ * PhoshMediaArtCache:
+ *
+ * A cache of album art
+ *
+ * Album art is loaded and decoded on a worker thread and stored as
+ * centered, square surfaces with rounded corners ready to be
+ * shown. Entries are keyed by the content's checksum so art that
+ * is reused under different URLs (or a file that got replaced) is
+ * handled correctly. For remote URLs we also remember the URL so we
+ * don't need to fetch them again.
+ */
+
+struct _PhoshMediaArtCache {
+  GObject     parent;
+
+  /* Protects all of the below, used from the loader threads */
+  GMutex      lock;
+  GHashTable *surfaces; /* key -> cairo_surface_t */
+  GQueue      lru;      /* keys, most recently used first */
+  GHashTable *url_checksums; /* remote URL -> content checksum */
+};
+G_DEFINE_TYPE (PhoshMediaArtCache, phosh_media_art_cache, G_TYPE_OBJECT)
+
+
+typedef struct {
+  char *url;
+  int   size;
+  int   scale;
+} FetchData;
+
+
+static void
+fetch_data_free (FetchData *data)
+{
+  g_free (data->url);
+  g_free (data);
+}
+
+
+static char *
+make_key (const char *checksum, int size, int scale)
+{
+  return g_strdup_printf ("%s@%dx%d", checksum, size, scale);
+}
+
+
+static gboolean
+is_remote_url (const char *url)
+{
+  return g_strcmp0 (g_uri_peek_scheme (url), "http") == 0 ||
+    g_strcmp0 (g_uri_peek_scheme (url), "https") == 0;
+}
+
+
+/* Must be called with the lock held */
+static cairo_surface_t *
+lookup_surface_locked (PhoshMediaArtCache *self, const char *key)
+{
+  cairo_surface_t *surface;
+  GList *link;
+
+  surface = g_hash_table_lookup (self->surfaces, key);
+  if (!surface)
+    return NULL;
+
+  link = g_queue_find_custom (&self->lru, key, (GCompareFunc) g_strcmp0);
+  g_queue_unlink (&self->lru, link);
+  g_queue_push_head_link (&self->lru, link);
+
+  return cairo_surface_reference (surface);
+}
+
+
+/* Must be called with the lock held. Returns the cached surface */
+static cairo_surface_t *
+insert_surface_locked (PhoshMediaArtCache *self, char *key, cairo_surface_t *surface)
+{
+  cairo_surface_t *cached;
+
+  /* Another thread might have been faster */
+  cached = lookup_surface_locked (self, key);
+  if (cached) {
+    g_free (key);
+    return cached;
+  }
+
+  g_hash_table_insert (self->surfaces, key, cairo_surface_reference (surface));
+  g_queue_push_head (&self->lru, key);
+
+  while (g_queue_get_length (&self->lru) > MAX_ENTRIES) {
+    /* The hash table owns the key */
+    char *oldest = g_queue_pop_tail (&self->lru);
+
+    g_hash_table_remove (self->surfaces, oldest);
+  }
+
+  return cairo_surface_reference (surface);
+}
+
+
+static GBytes *
+load_bytes (const char *url, GCancellable *cancel, GError **error)
+{
+  g_autoptr (GFile) file = NULL;
+  GBytes *bytes;
+
+  if (g_strcmp0 (g_uri_peek_scheme (url), "data") == 0) {
+    bytes = soup_uri_decode_data_uri (url, NULL);
+    if (!bytes)
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "Failed to decode data URI");
+    return bytes;
+  }
+
+  file = g_file_new_for_uri (url);
+  return g_file_load_bytes (file, cancel, NULL, error);
+}
+
+
+static void
+on_size_prepared (GdkPixbufLoader *loader, int width, int height, gpointer user_data)
+{
+  int size = GPOINTER_TO_INT (user_data);
+  double factor;
+
+  /* Don't decode more than we show */
+  if (width <= size && height <= size)
+    return;
+
+  factor = (double) size / MAX (width, height);
+  gdk_pixbuf_loader_set_size (loader,
+                              MAX (1, round (width * factor)),
+                              MAX (1, round (height * factor)));
+}
+
+
+static cairo_surface_t *
+render_art (GBytes *bytes, int size, int scale, GError **error)
+{
+  g_autoptr (GdkPixbufLoader) loader = gdk_pixbuf_loader_new ();
+  g_autoptr (cairo_t) cr = NULL;
+  cairo_surface_t *surface;
+  GdkPixbuf *pixbuf;
+  int width, height, px = size * scale;
+  double factor, radius;
+  const double degrees = G_PI / 180.0;
+
+  g_signal_connect (loader, "size-prepared", G_CALLBACK (on_size_prepared), GINT_TO_POINTER (px));
+  if (!gdk_pixbuf_loader_write_bytes (loader, bytes, error) ||
+      !gdk_pixbuf_loader_close (loader, error))
+    return NULL;
+
+  pixbuf = gdk_pixbuf_loader_get_pixbuf (loader);
+  if (!pixbuf) {
+    g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "No image data");
+    return NULL;
+  }
+
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+  factor = (double) px / MAX (width, height);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, px, px);
+  cr = cairo_create (surface);
+
+  radius = px / 8.0;
+  cairo_new_path (cr);
+  cairo_arc (cr, px - radius, radius, radius, -90 * degrees, 0 * degrees);
+  cairo_arc (cr, px - radius, px - radius, radius, 0 * degrees, 90 * degrees);
+  cairo_arc (cr, radius, px - radius, radius, 90 * degrees, 180 * degrees);
+  cairo_arc (cr, radius, radius, radius, 180 * degrees, 270 * degrees);
+  cairo_close_path (cr);
+  cairo_clip (cr);
+
+  /* Center non square images */
+  cairo_translate (cr, (px - width * factor) / 2.0, (px - height * factor) / 2.0);
+  cairo_scale (cr, factor, factor);
+  gdk_cairo_set_source_pixbuf (cr, pixbuf, 0, 0);
+  cairo_paint (cr);
+
+  cairo_surface_set_device_scale (surface, scale, scale);
+
+  return surface;
+}
+
+
+static void
+fetch_in_thread (GTask        *task,
+                 gpointer      source_object,
+                 gpointer      task_data,
+                 GCancellable *cancel)
+{
+  PhoshMediaArtCache *self = PHOSH_MEDIA_ART_CACHE (source_object);
+  FetchData *data = task_data;
+  g_autoptr (cairo_surface_t) rendered = NULL;
+  g_autoptr (GBytes) bytes = NULL;
+  g_autofree char *checksum = NULL;
+  g_autofree char *key = NULL;
+  cairo_surface_t *surface;
+  GError *err = NULL;
+
+  bytes = load_bytes (data->url, cancel, &err);
+  if (!bytes) {
+    g_task_return_error (task, err);
+    return;
+  }
+
+  checksum = g_compute_checksum_for_bytes (G_CHECKSUM_SHA256, bytes);
+  key = make_key (checksum, data->size, data->scale);
+
+  g_mutex_lock (&self->lock);
+  /* Keep the URL map bounded too, it's only a shortcut */
+  if (g_hash_table_size (self->url_checksums) > 4 * MAX_ENTRIES)
+    g_hash_table_remove_all (self->url_checksums);
+  if (is_remote_url (data->url))
+    g_hash_table_insert (self->url_checksums, g_strdup (data->url), g_strdup (checksum));
+  surface = lookup_surface_locked (self, key);
+  g_mutex_unlock (&self->lock);
+
+  if (surface) {
+    g_debug ("Art cache hit for content of %.64s", data->url);
+    g_task_return_pointer (task, surface, (GDestroyNotify) cairo_surface_destroy);
+    return;
+  }
+
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  g_debug ("Art cache miss for %.64s", data->url);
+  rendered = render_art (bytes, data->size, data->scale, &err);
+  if (!rendered) {
+    g_task_return_error (task, err);
+    return;
+  }
+
+  g_mutex_lock (&self->lock);
+  surface = insert_surface_locked (self, g_steal_pointer (&key), rendered);
+  g_mutex_unlock (&self->lock);
+
+  g_task_return_pointer (task, surface, (GDestroyNotify) cairo_surface_destroy);
+}
+
+
+static void
+get_memory_usage (gpointer owner, gsize *bytes, guint *n_entries)
+{
+  PhoshMediaArtCache *self = PHOSH_MEDIA_ART_CACHE (owner);
+  GHashTableIter iter;
+  cairo_surface_t *surface;
+
+  g_mutex_lock (&self->lock);
+  g_hash_table_iter_init (&iter, self->surfaces);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&surface)) {
+    *bytes += (gsize) cairo_image_surface_get_stride (surface) *
+      cairo_image_surface_get_height (surface);
+  }
+  *n_entries = g_hash_table_size (self->surfaces);
+  g_mutex_unlock (&self->lock);
+}
+
+
+static void
+phosh_media_art_cache_finalize (GObject *object)
+{
+  PhoshMediaArtCache *self = PHOSH_MEDIA_ART_CACHE (object);
+
+  phosh_memory_registry_remove (phosh_memory_registry_get_default (), self);
+  g_queue_clear (&self->lru);
+  g_clear_pointer (&self->surfaces, g_hash_table_destroy);
+  g_clear_pointer (&self->url_checksums, g_hash_table_destroy);
+  g_mutex_clear (&self->lock);
+
+  G_OBJECT_CLASS (phosh_media_art_cache_parent_class)->finalize (object);
+}
+
+
+static void
+phosh_media_art_cache_class_init (PhoshMediaArtCacheClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = phosh_media_art_cache_finalize;
+}
+
+
+static void
+phosh_media_art_cache_init (PhoshMediaArtCache *self)
+{
+  g_mutex_init (&self->lock);
+  g_queue_init (&self->lru);
+  self->surfaces = g_hash_table_new_full (g_str_hash,
+                                          g_str_equal,
+                                          g_free,
+                                          (GDestroyNotify) cairo_surface_destroy);
+  self->url_checksums = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+
+  phosh_memory_registry_add (phosh_memory_registry_get_default (),
+                             "media-art-cache",
+                             PHOSH_MEMORY_PRIORITY_CACHE,
+                             self,
+                             get_memory_usage,
+                             (PhoshMemoryShrinkFunc) phosh_media_art_cache_clear_all);
+}
+
+/**
+ * phosh_media_art_cache_get_default:
+ *
+ * Gets the album art cache singleton.
+ *
+ * Returns:(transfer none): The album art cache singleton.
+ */
+PhoshMediaArtCache *
+phosh_media_art_cache_get_default (void)
+{
+  static PhoshMediaArtCache *instance;
+
+  if (instance == NULL) {
+    g_debug ("Creating album art cache");
+    instance = g_object_new (PHOSH_TYPE_MEDIA_ART_CACHE, NULL);
+    g_object_add_weak_pointer (G_OBJECT (instance), (gpointer *)&instance);
+  }
+  return instance;
+}
+
+/**
+ * phosh_media_art_cache_fetch_async:
+ * @self: The album art cache
+ * @url: The URL of the album art
+ * @size: The size in logical pixels
+ * @scale: The scale factor
+ * @cancel: A cancellable
+ * @callback: The callback to invoke when done
+ * @user_data: Data passed to the callback
+ *
+ * Looks up the album art at the given URL or loads it into the cache if
+ * not yet present. Supported are `file`, `http`, `https` and `data` URLs.
+ */
+void
+phosh_media_art_cache_fetch_async (PhoshMediaArtCache  *self,
+                                   const char          *url,
+                                   int                  size,
+                                   int                  scale,
+                                   GCancellable        *cancel,
+                                   GAsyncReadyCallback  callback,
+                                   gpointer             user_data)
+{
+  g_autoptr (GTask) task = NULL;
+  FetchData *data;
+
+  g_return_if_fail (PHOSH_IS_MEDIA_ART_CACHE (self));
+  g_return_if_fail (url);
+  g_return_if_fail (size > 0 && scale > 0);
+  g_return_if_fail (cancel == NULL || G_IS_CANCELLABLE (cancel));
+
+  task = g_task_new (self, cancel, callback, user_data);
+  g_task_set_source_tag (task, phosh_media_art_cache_fetch_async);
+
+  if (is_remote_url (url)) {
+    cairo_surface_t *surface = NULL;
+    const char *checksum;
+
+    g_mutex_lock (&self->lock);
+    checksum = g_hash_table_lookup (self->url_checksums, url);
+    if (checksum) {
+      g_autofree char *key = make_key (checksum, size, scale);
+
+      surface = lookup_surface_locked (self, key);
+    }
+    g_mutex_unlock (&self->lock);
+
+    if (surface) {
+      g_debug ("Art cache hit for %s", url);
+      g_task_return_pointer (task, surface, (GDestroyNotify) cairo_surface_destroy);
+      return;
+    }
+  }
+
+  data = g_new0 (FetchData, 1);
+  data->url = g_strdup (url);
+  data->size = size;
+  data->scale = scale;
+  g_task_set_task_data (task, data, (GDestroyNotify) fetch_data_free);
+  g_task_run_in_thread (task, fetch_in_thread);
+}
+
+/**
+ * phosh_media_art_cache_fetch_finish:
+ * @self: The album art cache
+ * @res: The Result
+ * @error: The return location for errors
+ *
+ * Finishes the async operation started with `phosh_media_art_cache_fetch_async`.
+ *
+ * Returns:(transfer full): The album art or `NULL` on error
+ */
+cairo_surface_t *
+phosh_media_art_cache_fetch_finish (PhoshMediaArtCache  *self,
+                                    GAsyncResult        *res,
+                                    GError             **error)
+{
+  g_assert (PHOSH_IS_MEDIA_ART_CACHE (self));
+  g_assert (G_IS_TASK (res));
+  g_assert (!error || !*error);
+
+  return g_task_propagate_pointer (G_TASK (res), error);
+}
+
+/**
+ * phosh_media_art_cache_clear_all:
+ * @self: The album art cache
+ *
+ * Drop all album art from the cache.
+ */
+void
+phosh_media_art_cache_clear_all (PhoshMediaArtCache *self)
+{
+  g_return_if_fail (PHOSH_IS_MEDIA_ART_CACHE (self));
+
+  g_debug ("Clearing album art cache");
+
+  g_mutex_lock (&self->lock);
+  g_queue_clear (&self->lru);
+  g_hash_table_remove_all (self->surfaces);
+  g_hash_table_remove_all (self->url_checksums);
+  g_mutex_unlock (&self->lock);
+}
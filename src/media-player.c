@@ -13,6 +13,7 @@
 
 #include "mpris-dbus.h"
 #include "mpris-manager.h"
+#include "media-art-cache.h"
 #include "media-player.h"
 #include "shell-priv.h"
 #include "util.h"
@@ -29,7 +30,6 @@
 #define SEEK_BACK (-10 * SEEK_SECOND)
 #define SEEK_FORWARD (30 * SEEK_SECOND)
 
-G_DEFINE_AUTOPTR_CLEANUP_FUNC (cairo_t, cairo_destroy)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (cairo_surface_t, cairo_surface_destroy)
 
 /**
@@ -94,7 +94,11 @@ typedef struct _PhoshMediaPlayerPrivate {
   gboolean                          playable;
   gint64                            track_length;
   gint64                            track_position;
-  guint                             pos_poller_id;
+  gint64                            track_position_time; /* monotonic time of track_position */
+  double                            rate;
+  gint64                            shown_seconds;
+  guint                             pos_tick_id;
+  guint                             pos_resync_id;
 } PhoshMediaPlayerPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (PhoshMediaPlayer, phosh_media_player, GTK_TYPE_GRID);
@@ -154,39 +158,73 @@ set_attached (PhoshMediaPlayer *self, gboolean attached)
 }
 
 
+/* Only used to catch players that don't emit Seeked */
+#define POS_RESYNC_INTERVAL 30 /* seconds */
+
+/* The current position extrapolated from the last known one */
+static gint64
+get_position (PhoshMediaPlayer *self)
+{
+  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
+  gint64 position = priv->track_position;
+
+  if (position < 0)
+    return -1;
+
+  if (priv->status == PHOSH_MEDIA_PLAYER_STATUS_PLAYING)
+    position += (g_get_monotonic_time () - priv->track_position_time) * priv->rate;
+
+  position = MAX (position, 0);
+  if (priv->track_length > 0)
+    position = MIN (position, priv->track_length);
+
+  return position;
+}
+
+
 static void
 update_position (PhoshMediaPlayer *self)
 {
   PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
-  g_autofree char *position_text = NULL;
-  double level;
+  gint64 position = get_position (self);
+  gint64 seconds = position >= 0 ? position / G_USEC_PER_SEC : -1;
+  double level, current;
+  int width;
 
-  if (priv->track_position >= 0)
-    position_text = cui_call_format_duration ((double) priv->track_position / G_USEC_PER_SEC);
+  if (seconds != priv->shown_seconds) {
+    g_autofree char *position_text = NULL;
+
+    if (position >= 0)
+      position_text = cui_call_format_duration ((double) position / G_USEC_PER_SEC);
+
+    gtk_label_set_label (GTK_LABEL (priv->lbl_position), position_text ?: "-");
+    priv->shown_seconds = seconds;
+  }
 
-  gtk_label_set_label (GTK_LABEL (priv->lbl_position), position_text ?: "-");
+  level = position >= 0 && priv->track_length > 0 ? ((double) position) / priv->track_length : 0.0;
+  /* Only redraw when the bar grows by at least a pixel */
+  width = gtk_widget_get_allocated_width (priv->prb_position);
+  current = gtk_progress_bar_get_fraction (GTK_PROGRESS_BAR (priv->prb_position));
+  if (width > 0 && ABS (level - current) * width < 1.0)
+    return;
 
-  level = priv->track_position >= 0 ? ((double) priv->track_position) / priv->track_length : 0.0;
   gtk_progress_bar_set_fraction (GTK_PROGRESS_BAR (priv->prb_position), level);
 }
 
 
 static void
-stop_pos_poller (PhoshMediaPlayer *self)
+set_position (PhoshMediaPlayer *self, gint64 position)
 {
   PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
 
-  if (priv->pos_poller_id <= 0)
-    return;
-
-  g_debug ("Stopping position poller");
-  g_source_remove (priv->pos_poller_id);
-  priv->pos_poller_id = 0;
+  priv->track_position = position;
+  priv->track_position_time = g_get_monotonic_time ();
+  update_position (self);
 }
 
 
 static void
-on_poll_position_done (GDBusProxy *proxy, GAsyncResult *res, gpointer user_data)
+on_get_position_done (GDBusProxy *proxy, GAsyncResult *res, gpointer user_data)
 {
   PhoshMediaPlayer *self;
   PhoshMediaPlayerPrivate *priv;
@@ -206,67 +244,121 @@ on_poll_position_done (GDBusProxy *proxy, GAsyncResult *res, gpointer user_data)
 
     /* Return variant has type "(v)" where v has type x (i.e. gint64) */
     g_variant_get_child (var, 0, "v", &var2);
-    priv->track_position = g_variant_get_int64 (var2);
+    set_position (self, g_variant_get_int64 (var2));
     g_debug ("MPRIS Position: %" G_GINT64_FORMAT, priv->track_position);
   } else {
     g_warning ("Could not get Position from MPRIS player, hiding box_pos_len: %s", err->message);
-    priv->track_position = -1;
     gtk_widget_set_visible (priv->box_pos_len, FALSE);
-    stop_pos_poller (self);
+    set_position (self, -1);
   }
-
-  update_position (self);
 }
 
 
-static gboolean
-poll_position (PhoshMediaPlayer *self)
+/* Fetch the actual position from the player. Only needed on state
+ * changes, in between we extrapolate */
+static void
+resync_position (PhoshMediaPlayer *self)
 {
   PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
 
-  g_return_val_if_fail (PHOSH_IS_MEDIA_PLAYER (self), G_SOURCE_CONTINUE);
-
   if (!priv->attached || priv->player == NULL) {
     g_debug ("No MPRIS player attached");
-    priv->pos_poller_id = 0;
-    return G_SOURCE_REMOVE;
+    return;
   }
 
-  if (!gtk_widget_is_visible (priv->lbl_position)) {
-    g_debug ("Widget hidden, not updating Position");
-    return G_SOURCE_CONTINUE;
-  }
+  if (!gtk_widget_get_visible (priv->box_pos_len))
+    return;
 
   g_dbus_proxy_call (G_DBUS_PROXY (priv->player),
                      "org.freedesktop.DBus.Properties.Get",
                      g_variant_new ("(ss)", "org.mpris.MediaPlayer2.Player", "Position"),
                      G_DBUS_CALL_FLAGS_NONE, -1, priv->cancel,
-                     (GAsyncReadyCallback) on_poll_position_done, self);
+                     (GAsyncReadyCallback) on_get_position_done, self);
+}
+
+
+static gboolean
+on_pos_resync_timeout (gpointer user_data)
+{
+  resync_position (PHOSH_MEDIA_PLAYER (user_data));
 
   return G_SOURCE_CONTINUE;
 }
 
 
-#define POLLER_INTERVAL 1 /* seconds */
+/* Driven by the frame clock so there are no wakeups when the
+ * compositor doesn't draw us, e.g. when the display is blanked */
+static gboolean
+on_pos_tick (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer user_data)
+{
+  update_position (PHOSH_MEDIA_PLAYER (user_data));
+
+  return G_SOURCE_CONTINUE;
+}
+
+
+/* Only update the progress while playing and the bar is on screen */
 static void
-start_pos_poller (PhoshMediaPlayer *self)
+update_pos_tracking (PhoshMediaPlayer *self)
 {
   PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
+  gboolean track;
+
+  track = priv->attached && priv->player &&
+    priv->status == PHOSH_MEDIA_PLAYER_STATUS_PLAYING &&
+    gtk_widget_get_visible (priv->box_pos_len) &&
+    gtk_widget_get_mapped (priv->prb_position);
 
-  if (!gtk_widget_get_visible (priv->box_pos_len)) {
-    g_debug ("box_pos_len not visible, not starting position poller");
+  if (track == !!priv->pos_tick_id)
     return;
+
+  if (track) {
+    g_debug ("Starting position tracking");
+    priv->pos_tick_id = gtk_widget_add_tick_callback (priv->prb_position, on_pos_tick, self, NULL);
+    priv->pos_resync_id = g_timeout_add_seconds (POS_RESYNC_INTERVAL, on_pos_resync_timeout, self);
+    g_source_set_name_by_id (priv->pos_resync_id, "[PhoshMediaPlayer] pos_resync");
+    /* The position might have changed while we weren't looking */
+    resync_position (self);
+  } else {
+    g_debug ("Stopping position tracking");
+    gtk_widget_remove_tick_callback (priv->prb_position, priv->pos_tick_id);
+    priv->pos_tick_id = 0;
+    g_clear_handle_id (&priv->pos_resync_id, g_source_remove);
   }
-  if (priv->pos_poller_id != 0) {
-    g_debug ("Position poller already running");
+}
+
+
+static void
+on_seeked (PhoshMediaPlayer *self, gint64 position, PhoshMprisDBusMediaPlayer2Player *player)
+{
+  g_return_if_fail (PHOSH_IS_MEDIA_PLAYER (self));
+
+  g_debug ("Seeked to %" G_GINT64_FORMAT, position);
+  set_position (self, position);
+}
+
+
+static void
+on_rate_changed (PhoshMediaPlayer *self, GParamSpec *pspec, PhoshMprisDBusMediaPlayer2Player *player)
+{
+  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
+  double rate;
+
+  g_return_if_fail (PHOSH_IS_MEDIA_PLAYER (self));
+
+  rate = phosh_mpris_dbus_media_player2_player_get_rate (player);
+  /* Rate must not be 0.0, so this means the player doesn't provide it */
+  if (G_APPROX_VALUE (rate, 0.0, FLT_EPSILON))
+    rate = 1.0;
+
+  if (G_APPROX_VALUE (rate, priv->rate, FLT_EPSILON))
     return;
-  }
-  g_debug ("Starting position poller");
-  poll_position (self);
-  priv->pos_poller_id = g_timeout_add_seconds (POLLER_INTERVAL,
-                                               (GSourceFunc) poll_position,
-                                               self);
-  g_source_set_name_by_id (priv->pos_poller_id, "[PhoshMediaPlayer] pos_poller");
+
+  g_debug ("Rate: %f", rate);
+  /* Extrapolate the part played at the old rate */
+  if (priv->track_position >= 0)
+    set_position (self, get_position (self));
+  priv->rate = rate;
 }
 
 
@@ -300,7 +392,6 @@ btn_play_clicked_cb (PhoshMediaPlayer *self, GtkButton *button)
 static void
 on_next_done (PhoshMprisDBusMediaPlayer2Player *player, GAsyncResult *res, PhoshMediaPlayer *self)
 {
-  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
   g_autoptr (GError) err = NULL;
 
   g_return_if_fail (PHOSH_MPRIS_DBUS_IS_MEDIA_PLAYER2_PLAYER (player));
@@ -309,7 +400,7 @@ on_next_done (PhoshMprisDBusMediaPlayer2Player *player, GAsyncResult *res, Phosh
     phosh_async_error_warn (err, "Failed to trigger next");
     return;
   }
-  priv->track_position = 0;
+  set_position (self, 0);
 }
 
 
@@ -332,7 +423,6 @@ btn_next_clicked_cb (PhoshMediaPlayer *self, GtkButton *button)
 static void
 on_previous_done (PhoshMprisDBusMediaPlayer2Player *player, GAsyncResult *res, PhoshMediaPlayer *self)
 {
-  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
   g_autoptr (GError) err = NULL;
 
   g_return_if_fail (PHOSH_MPRIS_DBUS_IS_MEDIA_PLAYER2_PLAYER (player));
@@ -341,7 +431,7 @@ on_previous_done (PhoshMprisDBusMediaPlayer2Player *player, GAsyncResult *res, P
     phosh_async_error_warn (err, "Failed to trigger prev");
     return;
   }
-  priv->track_position = 0;
+  set_position (self, 0);
 }
 
 
@@ -372,7 +462,8 @@ on_seek_done (PhoshMprisDBusMediaPlayer2Player *player, GAsyncResult *res, Phosh
     g_warning ("Failed to trigger seek: %s", err->message);
     return;
   }
-  poll_position (self);
+  /* Not all players emit Seeked */
+  resync_position (self);
 }
 
 
@@ -443,174 +534,54 @@ btn_details_clicked_cb (PhoshMediaPlayer *self, GtkButton *button)
 }
 
 
-static GdkPixbuf *
-center_pixbuf (GdkPixbuf *pixbuf)
-{
-  int width, height, size;
-  g_autoptr (GdkPixbuf) centered = NULL;
-  g_autoptr (cairo_t) cr = NULL;
-  g_autoptr (cairo_surface_t) surface = NULL;
-
-  g_return_val_if_fail (GDK_IS_PIXBUF (pixbuf), NULL);
-
-  width = gdk_pixbuf_get_width (pixbuf);
-  height = gdk_pixbuf_get_height (pixbuf);
-
-  if (width == height)
-    return g_object_ref (pixbuf);
-
-  size = MAX (width, height);
-  /* gdk_pixbuf_copy_area would work as well but that goes via gdk_pixbuf_scale, …*/
-  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, size, size);
-  cr = cairo_create (surface);
-  if (width > height)
-    gdk_cairo_set_source_pixbuf (cr, pixbuf, 0, (width - height) / 2.0);
-  else
-    gdk_cairo_set_source_pixbuf (cr, pixbuf, (height - width) / 2.0, 0);
-  cairo_paint (cr);
-
-  return gdk_pixbuf_get_from_surface (surface, 0, 0, size, size);
-}
-
-
-static GdkPixbuf *
-round_corners (GdkPixbuf *pixbuf)
-{
-  g_autoptr (GdkPixbuf) rounded = NULL;
-  g_autoptr (cairo_t) cr = NULL;
-  g_autoptr (cairo_surface_t) surface = NULL;
-  int width, height, size;
-  double radius;
-  const double degrees = M_PI / 180.0;
-
-  g_return_val_if_fail (GDK_IS_PIXBUF (pixbuf), NULL);
-
-  width = gdk_pixbuf_get_width (pixbuf);
-  height = gdk_pixbuf_get_height (pixbuf);
-
-  /* We only round square images */
-  g_return_val_if_fail (width == height, NULL);
-
-  size = width;
-  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, size, size);
-  cr = cairo_create (surface);
-
-  radius = size / 8.0;
-  cairo_new_path (cr);
-  cairo_arc (cr, size - radius, radius, radius, -90 * degrees, 0 * degrees);
-  cairo_arc (cr, size - radius, size - radius, radius, 0 * degrees, 90 * degrees);
-  cairo_arc (cr, radius, size - radius, radius, 90 * degrees, 180 * degrees);
-  cairo_arc (cr, radius, radius, radius, 180 * degrees, 270 * degrees);
-  cairo_close_path (cr);
-  cairo_clip (cr);
-
-  gdk_cairo_set_source_pixbuf (cr, pixbuf, 0, 0);
-  cairo_paint (cr);
-
-  return gdk_pixbuf_get_from_surface (surface, 0, 0, size, size);
-}
-
-
-static void
-phosh_media_player_set_image (PhoshMediaPlayer *self, GdkPixbuf *pixbuf)
-{
-  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
-  g_autoptr (GdkPixbuf) centered = NULL;
-  g_autoptr (GdkPixbuf) rounded = NULL;
-
-  centered = center_pixbuf (pixbuf);
-  rounded = round_corners (centered);
-  g_object_set (priv->img_art, "gicon", rounded, NULL);
-}
-
-
 static void
-on_fetch_icon_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
+on_fetch_art_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
 {
   PhoshMediaPlayer *self;
   PhoshMediaPlayerPrivate *priv;
-  g_autoptr (GInputStream) stream = NULL;
+  g_autoptr (cairo_surface_t) surface = NULL;
   g_autoptr (GError) err = NULL;
-  g_autofree char *type = NULL;
-  g_autoptr (GdkPixbuf) pixbuf = NULL;
-
-  stream = g_loadable_icon_load_finish (G_LOADABLE_ICON (source_object), res, &type, &err);
-  if (!stream) {
-    g_warning ("Failed to fetch icon: %s", err->message);
-    return;
-  }
-
-  g_debug ("Loading icon of type: %s", type);
-  self = PHOSH_MEDIA_PLAYER (user_data);
-  priv = phosh_media_player_get_instance_private (self);
-  pixbuf = gdk_pixbuf_new_from_stream (stream, priv->fetch_icon_cancel, &err);
-
-  phosh_media_player_set_image (self, pixbuf);
-}
-
 
-static void
-fetch_icon_async (PhoshMediaPlayer *self, const char *url)
+  surface = phosh_media_art_cache_fetch_finish (PHOSH_MEDIA_ART_CACHE (source_object), res, &err);
+  if (!surface) {
+    if (phosh_async_error_warn (err, "Failed to load album art"))
+      return;
 
-{
-  PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
-  g_autoptr (GFile) file = g_file_new_for_uri (url);
-  GIcon *icon;
-
-  g_debug ("Fetching icon for %s", url);
-
-  if (!priv->fetch_icon_cancel)
-    priv->fetch_icon_cancel = g_cancellable_new ();
-
-  icon = g_file_icon_new (file);
-  g_loadable_icon_load_async (G_LOADABLE_ICON (icon),
-                              ART_PIXEL_SIZE,
-                              priv->fetch_icon_cancel,
-                              on_fetch_icon_ready,
-                              self);
-}
-
-
-static void
-on_load_icon_from_file_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
-{
-  PhoshMediaPlayer *self;
-  g_autoptr (GdkPixbuf) pixbuf = NULL;
-  g_autoptr (GError) err = NULL;
-
-  pixbuf = gdk_pixbuf_new_from_stream_finish (res, &err);
-  if (!pixbuf) {
-    phosh_async_error_warn (err, "Failed to load image");
+    self = PHOSH_MEDIA_PLAYER (user_data);
+    priv = phosh_media_player_get_instance_private (self);
+    g_object_set (priv->img_art, "icon-name", "audio-x-generic-symbolic", NULL);
     return;
   }
 
   self = PHOSH_MEDIA_PLAYER (user_data);
-  phosh_media_player_set_image (self, pixbuf);
+  priv = phosh_media_player_get_instance_private (self);
+  gtk_image_set_from_surface (GTK_IMAGE (priv->img_art), surface);
 }
 
 
-static void
-phosh_media_player_load_icon_from_file_async (PhoshMediaPlayer *self, GFile *file)
+static gboolean
+fetch_art (PhoshMediaPlayer *self, const char *url)
 {
   PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
-  g_autoptr (GFileInputStream) stream = NULL;
-  g_autoptr (GError) err = NULL;
+  const char *scheme = url ? g_uri_peek_scheme (url) : NULL;
 
-  stream = g_file_read (file, NULL, &err);
-  if (stream == NULL) {
-    g_autofree char *path = g_file_get_path (file);
+  if (g_strcmp0 (scheme, "file") != 0 &&
+      g_strcmp0 (scheme, "http") != 0 &&
+      g_strcmp0 (scheme, "https") != 0 &&
+      g_strcmp0 (scheme, "data") != 0)
+    return FALSE;
 
-    g_warning ("Failed to open '%s': %s", path, err->message);
-    return;
-  }
+  g_debug ("Fetching art for %.64s", url);
 
-  if (!priv->fetch_icon_cancel)
-    priv->fetch_icon_cancel = g_cancellable_new ();
-
-  gdk_pixbuf_new_from_stream_async (G_INPUT_STREAM (stream),
-                                    priv->fetch_icon_cancel,
-                                    on_load_icon_from_file_ready,
-                                    self);
+  priv->fetch_icon_cancel = g_cancellable_new ();
+  phosh_media_art_cache_fetch_async (phosh_media_art_cache_get_default (),
+                                     url,
+                                     ART_PIXEL_SIZE,
+                                     gtk_widget_get_scale_factor (priv->img_art),
+                                     priv->fetch_icon_cancel,
+                                     on_fetch_art_ready,
+                                     self);
+  return TRUE;
 }
 
 
@@ -659,37 +630,20 @@ on_metadata_changed (PhoshMediaPlayer *self, GParamSpec *psepc, PhoshMprisDBusMe
     gtk_label_set_label (GTK_LABEL (priv->lbl_length), length_text);
     g_debug ("Metadata has length, showing box_pos_len");
     gtk_widget_set_visible (priv->box_pos_len, TRUE);
-    if (priv->status == PHOSH_MEDIA_PLAYER_STATUS_PLAYING)
-      start_pos_poller (self);
   } else {
     gtk_label_set_label (GTK_LABEL (priv->lbl_length), "-");
   }
   priv->track_length = length;
-  update_position (self);
+  update_pos_tracking (self);
+  /* Might be a new track */
+  resync_position (self);
 
   /* Cancel any pending icon loads */
   g_cancellable_cancel (priv->fetch_icon_cancel);
   g_clear_object (&priv->fetch_icon_cancel);
 
-  if (url && g_strcmp0 (g_uri_peek_scheme (url), "file") == 0) {
-    g_autoptr (GFile) file = g_file_new_for_uri (url);
-
-    phosh_media_player_load_icon_from_file_async (self, file);
-  } else if (url && (g_strcmp0 (g_uri_peek_scheme (url), "http") == 0 ||
-                     g_strcmp0 (g_uri_peek_scheme (url), "https") == 0)) {
-    fetch_icon_async (self, url);
-  } else if (url && g_strcmp0 (g_uri_peek_scheme (url), "data") == 0) {
-    g_autoptr (GdkPixbuf) pixbuf = NULL;
-    g_autoptr (GError) error = NULL;
-
-    pixbuf = phosh_util_data_uri_to_pixbuf (url, &error);
-    if (pixbuf) {
-      phosh_media_player_set_image (self, pixbuf);
-      has_art = TRUE;
-    } else {
-      g_warning_once ("Failed to load album art from base64 string: %s", error->message);
-    }
-  }
+  /* Keep the current art until the new one is ready to avoid flicker */
+  has_art = fetch_art (self, url);
 
   if (!has_art)
     g_object_set (priv->img_art, "icon-name", "audio-x-generic-symbolic", NULL);
@@ -715,19 +669,16 @@ on_playback_status_changed (PhoshMediaPlayer                 *self,
 
   g_debug ("Status: '%s'", status);
   current = priv->status;
+  /* Rebase on what got played so far in the old state, the player's answer follows */
+  if (priv->track_position >= 0)
+    set_position (self, get_position (self));
   if (!g_strcmp0 ("Playing", status)) {
     priv->status = PHOSH_MEDIA_PLAYER_STATUS_PLAYING;
     icon = "media-playback-pause-symbolic";
-    start_pos_poller (self);
   } else if (!g_strcmp0 ("Paused", status)) {
     priv->status = PHOSH_MEDIA_PLAYER_STATUS_PAUSED;
-    stop_pos_poller (self);
-    poll_position (self);
   } else if (!g_strcmp0 ("Stopped", status)) {
     priv->status = PHOSH_MEDIA_PLAYER_STATUS_STOPPED;
-    stop_pos_poller (self);
-    priv->track_position = 0;
-    update_position (self);
   } else {
     g_warning ("Unknown status %s", status);
     g_warn_if_reached ();
@@ -736,7 +687,15 @@ on_playback_status_changed (PhoshMediaPlayer                 *self,
   if (priv->status != current) {
     g_object_set (priv->img_play, "icon-name", icon, NULL);
     gtk_widget_set_valign (priv->img_play, GTK_ALIGN_START);
+
+    /* When starting to play the tracking below fetches the position */
+    if (priv->status == PHOSH_MEDIA_PLAYER_STATUS_STOPPED)
+      set_position (self, 0);
+    else if (priv->status == PHOSH_MEDIA_PLAYER_STATUS_PAUSED)
+      resync_position (self);
   }
+
+  update_pos_tracking (self);
 }
 
 
@@ -808,7 +767,11 @@ phosh_media_player_dispose (GObject *object)
   PhoshMediaPlayer *self = PHOSH_MEDIA_PLAYER (object);
   PhoshMediaPlayerPrivate *priv = phosh_media_player_get_instance_private (self);
 
-  stop_pos_poller (self);
+  if (priv->pos_tick_id) {
+    gtk_widget_remove_tick_callback (priv->prb_position, priv->pos_tick_id);
+    priv->pos_tick_id = 0;
+  }
+  g_clear_handle_id (&priv->pos_resync_id, g_source_remove);
   g_cancellable_cancel (priv->cancel);
   g_clear_object (&priv->cancel);
 
@@ -912,7 +875,15 @@ phosh_media_player_init (PhoshMediaPlayer *self)
   priv->cancel = g_cancellable_new ();
   priv->track_length = -1;
   priv->track_position = -1;
-  priv->pos_poller_id = 0;
+  priv->rate = 1.0;
+  priv->shown_seconds = G_MININT64;
+
+  g_signal_connect_object (priv->prb_position, "map",
+                           G_CALLBACK (update_pos_tracking), self,
+                           G_CONNECT_SWAPPED);
+  g_signal_connect_object (priv->prb_position, "unmap",
+                           G_CALLBACK (update_pos_tracking), self,
+                           G_CONNECT_SWAPPED);
 
   if (manager) {
     priv->manager = g_object_ref (manager);
@@ -984,6 +955,7 @@ phosh_media_player_set_player (PhoshMediaPlayer *self, PhoshMprisDBusMediaPlayer
 
   if (!priv->player) {
     set_attached (self, FALSE);
+    update_pos_tracking (self);
     return;
   }
 
@@ -1007,9 +979,15 @@ phosh_media_player_set_player (PhoshMediaPlayer *self, PhoshMprisDBusMediaPlayer
                     "swapped-object-signal::notify::can-seek",
                     G_CALLBACK (on_can_seek),
                     self,
+                    "swapped-object-signal::notify::rate",
+                    G_CALLBACK (on_rate_changed),
+                    self,
+                    "swapped-object-signal::seeked",
+                    G_CALLBACK (on_seeked),
+                    self,
                     NULL);
 
-  /* Set 'attached' before running notifiers, since we check it on e.g. start_pos_poller() */
+  /* Set 'attached' before running notifiers, since we check it on e.g. resync_position() */
   set_attached (self, TRUE);
   /* Hide progress bar box by default, it's shown if track length is given in metadata */
   gtk_widget_set_visible (priv->box_pos_len, FALSE);
@@ -1020,4 +998,5 @@ phosh_media_player_set_player (PhoshMediaPlayer *self, PhoshMprisDBusMediaPlayer
   g_object_notify (G_OBJECT (priv->player), "can-go-previous");
   g_object_notify (G_OBJECT (priv->player), "can-play");
   g_object_notify (G_OBJECT (priv->player), "can-seek");
+  g_object_notify (G_OBJECT (priv->player), "rate");
 }
@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-memory-registry"
+
+#include "phosh-config.h"
+
+#include "memory-registry.h"
+
+/**
+ * PhoshMemoryRegistry:
+ *
+ * Keeps track of the memory held by caches and images
+ *
+ * Caches and widgets holding large buffers register a function
+ * reporting their resident bytes and number of entries. They can
+ * additionally register a function to release memory which is
+ * invoked on memory pressure in the order of the registered
+ * `PhoshMemoryPriority`.
+ */
+
+typedef struct {
+  const char            *name; /* interned */
+  PhoshMemoryPriority    priority;
+  gpointer               owner;
+  PhoshMemoryUsageFunc   usage_func;
+  PhoshMemoryShrinkFunc  shrink_func;
+} Provider;
+
+struct _PhoshMemoryRegistry {
+  GObject  parent;
+
+  GArray  *providers;
+};
+G_DEFINE_TYPE (PhoshMemoryRegistry, phosh_memory_registry, G_TYPE_OBJECT)
+
+
+static gboolean
+is_registered (PhoshMemoryRegistry *self, Provider *provider)
+{
+  for (guint i = 0; i < self->providers->len; i++) {
+    Provider *p = &g_array_index (self->providers, Provider, i);
+
+    if (p->owner == provider->owner && p->shrink_func == provider->shrink_func)
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+
+static void
+phosh_memory_registry_finalize (GObject *object)
+{
+  PhoshMemoryRegistry *self = PHOSH_MEMORY_REGISTRY (object);
+
+  g_clear_pointer (&self->providers, g_array_unref);
+
+  G_OBJECT_CLASS (phosh_memory_registry_parent_class)->finalize (object);
+}
+
+
+static void
+phosh_memory_registry_class_init (PhoshMemoryRegistryClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = phosh_memory_registry_finalize;
+}
+
+
+static void
+phosh_memory_registry_init (PhoshMemoryRegistry *self)
+{
+  self->providers = g_array_new (FALSE, FALSE, sizeof (Provider));
+}
+
+/**
+ * phosh_memory_registry_get_default:
+ *
+ * Gets the memory registry singleton.
+ *
+ * Returns:(transfer none): The memory registry singleton.
+ */
+PhoshMemoryRegistry *
+phosh_memory_registry_get_default (void)
+{
+  static PhoshMemoryRegistry *instance;
+
+  if (instance == NULL) {
+    instance = g_object_new (PHOSH_TYPE_MEMORY_REGISTRY, NULL);
+    g_object_add_weak_pointer (G_OBJECT (instance), (gpointer *)&instance);
+  }
+  return instance;
+}
+
+/**
+ * phosh_memory_registry_add:
+ * @self: The memory registry
+ * @name: The name to report the memory under
+ * @priority: The memory's priority
+ * @owner: The object holding the memory
+ * @usage_func: Function reporting the memory held by @owner
+ * @shrink_func: (nullable): Function releasing memory held by @owner
+ *
+ * Register memory held by @owner. Several owners can use the same
+ * @name, their usage is summed up. The owner must call
+ * `phosh_memory_registry_remove()` before it goes away.
+ */
+void
+phosh_memory_registry_add (PhoshMemoryRegistry   *self,
+                           const char            *name,
+                           PhoshMemoryPriority    priority,
+                           gpointer               owner,
+                           PhoshMemoryUsageFunc   usage_func,
+                           PhoshMemoryShrinkFunc  shrink_func)
+{
+  Provider provider;
+
+  g_return_if_fail (PHOSH_IS_MEMORY_REGISTRY (self));
+  g_return_if_fail (name != NULL);
+  g_return_if_fail (owner != NULL);
+  g_return_if_fail (usage_func != NULL);
+
+  provider = (Provider) {
+    .name = g_intern_string (name),
+    .priority = priority,
+    .owner = owner,
+    .usage_func = usage_func,
+    .shrink_func = shrink_func,
+  };
+  g_array_append_val (self->providers, provider);
+}
+
+/**
+ * phosh_memory_registry_remove:
+ * @self: The memory registry
+ * @owner: The object holding the memory
+ *
+ * Unregister all memory registered for @owner.
+ */
+void
+phosh_memory_registry_remove (PhoshMemoryRegistry *self, gpointer owner)
+{
+  g_return_if_fail (PHOSH_IS_MEMORY_REGISTRY (self));
+
+  for (int i = (int) self->providers->len - 1; i >= 0; i--) {
+    if (g_array_index (self->providers, Provider, i).owner == owner)
+      g_array_remove_index (self->providers, i);
+  }
+}
+
+/**
+ * phosh_memory_registry_get_usage:
+ * @self: The memory registry
+ *
+ * Gets the current memory usage summed up by name.
+ *
+ * Returns:(transfer full)(element-type PhoshMemoryUsage): The memory usage
+ */
+GArray *
+phosh_memory_registry_get_usage (PhoshMemoryRegistry *self)
+{
+  GArray *usages;
+
+  g_return_val_if_fail (PHOSH_IS_MEMORY_REGISTRY (self), NULL);
+
+  usages = g_array_new (FALSE, TRUE, sizeof (PhoshMemoryUsage));
+
+  for (guint i = 0; i < self->providers->len; i++) {
+    Provider *provider = &g_array_index (self->providers, Provider, i);
+    PhoshMemoryUsage *usage = NULL;
+    gsize bytes = 0;
+    guint n_entries = 0;
+
+    provider->usage_func (provider->owner, &bytes, &n_entries);
+
+    for (guint j = 0; j < usages->len; j++) {
+      /* Names are interned */
+      if (g_array_index (usages, PhoshMemoryUsage, j).name == provider->name) {
+        usage = &g_array_index (usages, PhoshMemoryUsage, j);
+        break;
+      }
+    }
+
+    if (usage == NULL) {
+      g_array_set_size (usages, usages->len + 1);
+      usage = &g_array_index (usages, PhoshMemoryUsage, usages->len - 1);
+      usage->name = provider->name;
+      usage->priority = provider->priority;
+    }
+
+    usage->bytes += bytes;
+    usage->n_entries += n_entries;
+    usage->n_owners++;
+  }
+
+  return usages;
+}
+
+/**
+ * phosh_memory_registry_shrink:
+ * @self: The memory registry
+ * @priority: The highest priority to shrink
+ *
+ * Release memory of all owners up to and including @priority. Owners
+ * with lower priority are shrunk first.
+ */
+void
+phosh_memory_registry_shrink (PhoshMemoryRegistry *self, PhoshMemoryPriority priority)
+{
+  g_autoptr (GArray) providers = NULL;
+
+  g_return_if_fail (PHOSH_IS_MEMORY_REGISTRY (self));
+
+  /* Shrinking might make other owners go away */
+  providers = g_array_copy (self->providers);
+
+  for (PhoshMemoryPriority p = PHOSH_MEMORY_PRIORITY_CACHE; p <= priority; p++) {
+    for (guint i = 0; i < providers->len; i++) {
+      Provider *provider = &g_array_index (providers, Provider, i);
+
+      if (provider->priority != p || provider->shrink_func == NULL)
+        continue;
+
+      if (!is_registered (self, provider))
+        continue;
+
+      g_debug ("Shrinking '%s' (%s)", provider->name, phosh_memory_priority_to_string (p));
+      provider->shrink_func (provider->owner);
+    }
+  }
+}
+
+/**
+ * phosh_memory_registry_handle_warning:
+ * @self: The memory registry
+ * @level: The warning level
+ *
+ * Release memory according to a low memory warning, e.g. from
+ * `GMemoryMonitor`.
+ */
+void
+phosh_memory_registry_handle_warning (PhoshMemoryRegistry        *self,
+                                      GMemoryMonitorWarningLevel  level)
+{
+  PhoshMemoryPriority priority;
+
+  g_return_if_fail (PHOSH_IS_MEMORY_REGISTRY (self));
+
+  if (level >= G_MEMORY_MONITOR_WARNING_LEVEL_CRITICAL)
+    priority = PHOSH_MEMORY_PRIORITY_ACTIVE;
+  else if (level >= G_MEMORY_MONITOR_WARNING_LEVEL_MEDIUM)
+    priority = PHOSH_MEMORY_PRIORITY_INACTIVE;
+  else
+    priority = PHOSH_MEMORY_PRIORITY_CACHE;
+
+  g_message ("Low memory warning (level %d), shrinking up to '%s'",
+             level, phosh_memory_priority_to_string (priority));
+  phosh_memory_registry_shrink (self, priority);
+}
+
+
+const char *
+phosh_memory_priority_to_string (PhoshMemoryPriority priority)
+{
+  switch (priority) {
+  case PHOSH_MEMORY_PRIORITY_CACHE:
+    return "cache";
+  case PHOSH_MEMORY_PRIORITY_INACTIVE:
+    return "inactive";
+  case PHOSH_MEMORY_PRIORITY_ACTIVE:
+    return "active";
+  default:
+    g_return_val_if_reached (NULL);
+  }
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/**
+ * PhoshMemoryPriority:
+ * @PHOSH_MEMORY_PRIORITY_CACHE: Data that can be recreated any time, shrunk first
+ * @PHOSH_MEMORY_PRIORITY_INACTIVE: Data that isn't shown at the moment
+ * @PHOSH_MEMORY_PRIORITY_ACTIVE: Data that is in use, only reported
+ *
+ * How important memory is to the shell. This determines in which order
+ * it is released on memory pressure.
+ */
+typedef enum {
+  PHOSH_MEMORY_PRIORITY_CACHE = 0,
+  PHOSH_MEMORY_PRIORITY_INACTIVE,
+  PHOSH_MEMORY_PRIORITY_ACTIVE,
+} PhoshMemoryPriority;
+
+/**
+ * PhoshMemoryUsage:
+ * @name: The name the memory got registered with
+ * @priority: The memory's priority
+ * @bytes: Resident bytes summed up over all owners
+ * @n_entries: Entries summed up over all owners
+ * @n_owners: The number of owners registered under @name
+ *
+ * Memory usage of all owners registered under the same name.
+ */
+typedef struct {
+  const char          *name;
+  PhoshMemoryPriority  priority;
+  gsize                bytes;
+  guint                n_entries;
+  guint                n_owners;
+} PhoshMemoryUsage;
+
+/**
+ * PhoshMemoryUsageFunc:
+ * @owner: The owner of the memory
+ * @bytes: (out): Return location for the resident bytes
+ * @n_entries: (out): Return location for the number of entries
+ *
+ * Report the memory currently held by @owner.
+ */
+typedef void (*PhoshMemoryUsageFunc) (gpointer owner, gsize *bytes, guint *n_entries);
+
+/**
+ * PhoshMemoryShrinkFunc:
+ * @owner: The owner of the memory
+ *
+ * Release as much of the memory held by @owner as possible.
+ */
+typedef void (*PhoshMemoryShrinkFunc) (gpointer owner);
+
+#define PHOSH_TYPE_MEMORY_REGISTRY (phosh_memory_registry_get_type ())
+
+G_DECLARE_FINAL_TYPE (PhoshMemoryRegistry, phosh_memory_registry, PHOSH, MEMORY_REGISTRY, GObject)
+
+PhoshMemoryRegistry *phosh_memory_registry_get_default    (void);
+void                 phosh_memory_registry_add            (PhoshMemoryRegistry        *self,
+                                                           const char                 *name,
+                                                           PhoshMemoryPriority         priority,
+                                                           gpointer                    owner,
+                                                           PhoshMemoryUsageFunc        usage_func,
+                                                           PhoshMemoryShrinkFunc       shrink_func);
+void                 phosh_memory_registry_remove         (PhoshMemoryRegistry        *self,
+                                                           gpointer                    owner);
+GArray              *phosh_memory_registry_get_usage      (PhoshMemoryRegistry        *self);
+void                 phosh_memory_registry_shrink         (PhoshMemoryRegistry        *self,
+                                                           PhoshMemoryPriority         priority);
+void                 phosh_memory_registry_handle_warning (PhoshMemoryRegistry        *self,
+                                                           GMemoryMonitorWarningLevel  level);
+const char          *phosh_memory_priority_to_string      (PhoshMemoryPriority         priority);
+
+G_END_DECLS
@@ -27,6 +27,11 @@
 #define GSD_COLOR_BUS_NAME "org.gnome.SettingsDaemon.Color"
 #define GSD_COLOR_OBJECT_PATH "/org/gnome/SettingsDaemon/Color"
 
+#define NIGHT_LIGHT_TRANSITION_DURATION_DEFAULT 1000 /* ms */
+/* Only push new gamma tables for temperature changes of this size */
+#define NIGHT_LIGHT_TEMP_STEP 10 /* K */
+#define DEFAULT_REFRESH 60000 /* mHz */
+
 /**
  * PhoshMonitorManager:
  *
@@ -48,6 +53,7 @@ enum {
   PROP_0,
   PROP_SENSOR_PROXY_MANAGER,
   PROP_N_MONITORS,
+  PROP_NIGHT_LIGHT_TRANSITION_DURATION,
   PROP_LAST_PROP
 };
 static GParamSpec *props[PROP_LAST_PROP];
@@ -70,7 +76,15 @@ typedef struct _PhoshMonitorManager
   GBinding                *sensor_proxy_binding;
 
   PhoshDBusColor          *gsd_color_proxy;
+  /* The temperature requested by gsd-color */
   guint32                  night_light_temp;
+  /* The temperature currently set on the monitors */
+  guint32                  night_light_current;
+  /* Transition from night_light_from to night_light_temp */
+  guint32                  night_light_from;
+  gint64                   night_light_start;
+  guint                    night_light_duration;
+  guint                    night_light_id;
 
   GPtrArray *monitors;   /* Currently known monitors */
   GPtrArray *heads;      /* Currently known heads */
@@ -81,6 +95,16 @@ typedef struct _PhoshMonitorManager
   PhoshHead *pending_primary;
   uint32_t zwlr_output_serial;
 
+  /* Pending head changes get applied together */
+  guint      commit_id;
+  GPtrArray *commit_tasks;
+
+  /* Cached DBus replies, valid for reply_serial and reply_primary_head */
+  GVariant  *resources_reply;
+  GVariant  *current_state_reply;
+  int        reply_serial;
+  PhoshHead *reply_primary_head;
+
   GCancellable            *cancel;
 } PhoshMonitorManager;
 
@@ -180,38 +204,36 @@ phosh_monitor_manager_get_head_from_monitor (PhoshMonitorManager *self, PhoshMon
  * DBus Interface
  */
 
-static gboolean
-phosh_monitor_manager_handle_get_resources (PhoshDBusDisplayConfig *skeleton,
-                                            GDBusMethodInvocation  *invocation)
+static void
+phosh_monitor_manager_clear_dbus_replies (PhoshMonitorManager *self)
 {
-  PhoshMonitorManager *self = PHOSH_MONITOR_MANAGER (skeleton);
-  GVariantBuilder crtc_builder, output_builder, mode_builder;
-  PhoshMonitor *primary_monitor;
-  PhoshHead *primary_head;
+  g_clear_pointer (&self->resources_reply, g_variant_unref);
+  g_clear_pointer (&self->current_state_reply, g_variant_unref);
+  self->reply_primary_head = NULL;
+}
 
-  g_debug ("DBus %s", __func__);
+/*
+ * Building the replies is expensive with lots of heads and modes so we
+ * keep them around until the configuration (and hence the serial) or
+ * the primary head changes.
+ */
+static void
+phosh_monitor_manager_check_dbus_replies (PhoshMonitorManager *self, PhoshHead *primary_head)
+{
+  if (self->reply_serial == self->serial && self->reply_primary_head == primary_head)
+    return;
 
-  if (phosh_monitor_manager_get_num_monitors (self) == 0) {
-    g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
-                                           G_DBUS_ERROR_ACCESS_DENIED,
-                                           "No monitors found");
-    return TRUE;
-  }
+  phosh_monitor_manager_clear_dbus_replies (self);
+  self->reply_serial = self->serial;
+  self->reply_primary_head = primary_head;
+}
 
-  primary_monitor = phosh_shell_get_primary_monitor (phosh_shell_get_default ());
-  if (!primary_monitor) {
-    g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
-                                           G_DBUS_ERROR_ACCESS_DENIED,
-                                           "No primary monitor found");
-    return TRUE;
-  }
-  primary_head = phosh_monitor_manager_get_head_from_monitor (self, primary_monitor);
-  if (!primary_head) {
-    g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
-                                           G_DBUS_ERROR_ACCESS_DENIED,
-                                           "No primary monitor found");
-    return TRUE;
-  }
+
+static GVariant *
+build_resources_reply (PhoshMonitorManager *self, PhoshHead *primary_head)
+{
+  GVariantBuilder crtc_builder, output_builder, mode_builder;
+  GVariant *reply[6];
 
   g_variant_builder_init (&crtc_builder, G_VARIANT_TYPE ("a(uxiiiiiuaua{sv})"));
   g_variant_builder_init (&output_builder, G_VARIANT_TYPE ("a(uxiausauaua{sv})"));
@@ -282,16 +304,54 @@ phosh_monitor_manager_handle_get_resources (PhoshDBusDisplayConfig *skeleton,
 
   /* Don't bother setting up modes, they're ignored */
 
-  phosh_dbus_display_config_complete_get_resources (
-    skeleton,
-    invocation,
-    self->serial,
-    g_variant_builder_end (&crtc_builder),
-    g_variant_builder_end (&output_builder),
-    g_variant_builder_end (&mode_builder),
-    65535,  /* max_screen_width */
-    65535   /* max_screen_height */
-    );
+  reply[0] = g_variant_new_uint32 (self->serial);
+  reply[1] = g_variant_builder_end (&crtc_builder);
+  reply[2] = g_variant_builder_end (&output_builder);
+  reply[3] = g_variant_builder_end (&mode_builder);
+  reply[4] = g_variant_new_int32 (65535); /* max_screen_width */
+  reply[5] = g_variant_new_int32 (65535); /* max_screen_height */
+
+  return g_variant_ref_sink (g_variant_new_tuple (reply, G_N_ELEMENTS (reply)));
+}
+
+
+static gboolean
+phosh_monitor_manager_handle_get_resources (PhoshDBusDisplayConfig *skeleton,
+                                            GDBusMethodInvocation  *invocation)
+{
+  PhoshMonitorManager *self = PHOSH_MONITOR_MANAGER (skeleton);
+  PhoshMonitor *primary_monitor;
+  PhoshHead *primary_head;
+
+  g_debug ("DBus %s", __func__);
+
+  if (phosh_monitor_manager_get_num_monitors (self) == 0) {
+    g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                           G_DBUS_ERROR_ACCESS_DENIED,
+                                           "No monitors found");
+    return TRUE;
+  }
+
+  primary_monitor = phosh_shell_get_primary_monitor (phosh_shell_get_default ());
+  if (!primary_monitor) {
+    g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                           G_DBUS_ERROR_ACCESS_DENIED,
+                                           "No primary monitor found");
+    return TRUE;
+  }
+  primary_head = phosh_monitor_manager_get_head_from_monitor (self, primary_monitor);
+  if (!primary_head) {
+    g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                           G_DBUS_ERROR_ACCESS_DENIED,
+                                           "No primary monitor found");
+    return TRUE;
+  }
+
+  phosh_monitor_manager_check_dbus_replies (self, primary_head);
+  if (self->resources_reply == NULL)
+    self->resources_reply = build_resources_reply (self, primary_head);
+
+  g_dbus_method_invocation_return_value (invocation, self->resources_reply);
 
   return TRUE;
 }
@@ -394,31 +454,11 @@ phosh_monitor_manager_handle_set_crtc_gamma (PhoshDBusDisplayConfig *skeleton,
 #define LOGICAL_MONITORS_FORMAT "a" LOGICAL_MONITOR_FORMAT
 
 
-static gboolean
-phosh_monitor_manager_handle_get_current_state (PhoshDBusDisplayConfig *skeleton,
-                                                GDBusMethodInvocation  *invocation)
+static GVariant *
+build_current_state_reply (PhoshMonitorManager *self, PhoshHead *primary_head)
 {
-  PhoshMonitorManager *self = PHOSH_MONITOR_MANAGER (skeleton);
   GVariantBuilder monitors_builder, logical_monitors_builder, properties_builder;
-  PhoshMonitor *primary_monitor;
-  PhoshHead *primary_head;
-
-  g_debug ("DBus call %s", __func__);
-
-  primary_monitor = phosh_shell_get_primary_monitor (phosh_shell_get_default ());
-  if (!primary_monitor) {
-    g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
-                                           G_DBUS_ERROR_ACCESS_DENIED,
-                                           "No primary monitor found");
-    return TRUE;
-  }
-  primary_head = phosh_monitor_manager_get_head_from_monitor (self, primary_monitor);
-  if (!primary_head) {
-    g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
-                                           G_DBUS_ERROR_ACCESS_DENIED,
-                                           "No primary monitor found");
-    return TRUE;
-  }
+  GVariant *reply[4];
 
   g_variant_builder_init (&monitors_builder,
                           G_VARIANT_TYPE (MONITORS_FORMAT));
@@ -534,13 +574,45 @@ phosh_monitor_manager_handle_get_current_state (PhoshDBusDisplayConfig *skeleton
                          "supports-changing-layout-mode",
                          g_variant_new_boolean (TRUE));
 
-  phosh_dbus_display_config_complete_get_current_state (
-    skeleton,
-    invocation,
-    self->serial,
-    g_variant_builder_end (&monitors_builder),
-    g_variant_builder_end (&logical_monitors_builder),
-    g_variant_builder_end (&properties_builder));
+  reply[0] = g_variant_new_uint32 (self->serial);
+  reply[1] = g_variant_builder_end (&monitors_builder);
+  reply[2] = g_variant_builder_end (&logical_monitors_builder);
+  reply[3] = g_variant_builder_end (&properties_builder);
+
+  return g_variant_ref_sink (g_variant_new_tuple (reply, G_N_ELEMENTS (reply)));
+}
+
+
+static gboolean
+phosh_monitor_manager_handle_get_current_state (PhoshDBusDisplayConfig *skeleton,
+                                                GDBusMethodInvocation  *invocation)
+{
+  PhoshMonitorManager *self = PHOSH_MONITOR_MANAGER (skeleton);
+  PhoshMonitor *primary_monitor;
+  PhoshHead *primary_head;
+
+  g_debug ("DBus call %s", __func__);
+
+  primary_monitor = phosh_shell_get_primary_monitor (phosh_shell_get_default ());
+  if (!primary_monitor) {
+    g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                           G_DBUS_ERROR_ACCESS_DENIED,
+                                           "No primary monitor found");
+    return TRUE;
+  }
+  primary_head = phosh_monitor_manager_get_head_from_monitor (self, primary_monitor);
+  if (!primary_head) {
+    g_dbus_method_invocation_return_error (invocation, G_DBUS_ERROR,
+                                           G_DBUS_ERROR_ACCESS_DENIED,
+                                           "No primary monitor found");
+    return TRUE;
+  }
+
+  phosh_monitor_manager_check_dbus_replies (self, primary_head);
+  if (self->current_state_reply == NULL)
+    self->current_state_reply = build_current_state_reply (self, primary_head);
+
+  g_dbus_method_invocation_return_value (invocation, self->current_state_reply);
 
   return TRUE;
 }
@@ -963,6 +1035,11 @@ on_monitor_n_gamma_entries_changed (PhoshMonitorManager *self)
 }
 
 
+static void on_monitor_power_mode_changed (PhoshMonitorManager *self,
+                                           GParamSpec          *pspec,
+                                           PhoshMonitor        *monitor);
+
+
 static void
 on_monitor_configured (PhoshMonitorManager *self, PhoshMonitor *monitor)
 {
@@ -990,12 +1067,15 @@ on_monitor_configured (PhoshMonitorManager *self, PhoshMonitor *monitor)
   g_signal_connect_swapped (monitor, "notify::n-gamma-entries",
                             G_CALLBACK (on_monitor_n_gamma_entries_changed),
                             self);
+  g_signal_connect_swapped (monitor, "notify::power-mode",
+                            G_CALLBACK (on_monitor_power_mode_changed),
+                            self);
 
   phosh_monitor_manager_set_night_light_supported (self);
 
   /* Update night light */
-  if (self->night_light_temp > 0 && phosh_monitor_has_gamma (monitor))
-    phosh_monitor_set_color_temp (monitor, self->night_light_temp);
+  if (self->night_light_current > 0 && phosh_monitor_has_gamma (monitor))
+    phosh_monitor_set_color_temp (monitor, self->night_light_current);
 }
 
 
@@ -1072,6 +1152,7 @@ on_head_finished (PhoshMonitorManager *self,
 {
   g_return_if_fail (PHOSH_IS_MONITOR_MANAGER (self));
 
+  phosh_monitor_manager_clear_dbus_replies (self);
   if (g_ptr_array_remove (self->heads, head))
     g_debug ("Removing head %p", head);
   else
@@ -1093,6 +1174,7 @@ zwlr_output_manager_v1_handle_head (void                          *data,
 
   head = phosh_head_new_from_wlr_head (wlr_head);
   g_debug ("New head %p", head);
+  phosh_monitor_manager_clear_dbus_replies (self);
   g_ptr_array_add (self->heads, head);
   g_signal_connect_swapped (head, "head-finished", G_CALLBACK (on_head_finished), self);
 
@@ -1111,6 +1193,7 @@ zwlr_output_manager_v1_handle_done (void                          *data,
   g_debug ("Got zwlr_output_manager serial %u", serial);
   self->zwlr_output_serial = serial;
   self->serial++;
+  phosh_monitor_manager_clear_dbus_replies (self);
 
   phosh_dbus_display_config_emit_monitors_changed (PHOSH_DBUS_DISPLAY_CONFIG (self));
 }
@@ -1122,12 +1205,31 @@ static const struct zwlr_output_manager_v1_listener zwlr_output_manager_v1_liste
 };
 
 
+static void
+complete_config_tasks (GPtrArray *tasks, GError *err)
+{
+  for (guint i = 0; i < tasks->len; i++) {
+    GTask *task = g_ptr_array_index (tasks, i);
+
+    if (err)
+      g_task_return_error (task, g_error_copy (err));
+    else
+      g_task_return_boolean (task, TRUE);
+  }
+
+  g_ptr_array_free (tasks, TRUE);
+}
+
+
 static void
 zwlr_output_configuration_v1_handle_succeeded (void                                *data,
                                                struct zwlr_output_configuration_v1 *config)
 {
+  GPtrArray *tasks = data;
+
   g_debug ("New output configuration %p applied", config);
   zwlr_output_configuration_v1_destroy (config);
+  complete_config_tasks (tasks, NULL);
 }
 
 
@@ -1135,9 +1237,14 @@ static void
 zwlr_output_configuration_v1_handle_failed (void                                *data,
                                             struct zwlr_output_configuration_v1 *config)
 {
-  /* TODO: bubble up error */
+  g_autoptr (GError) err = NULL;
+  GPtrArray *tasks = data;
+
   g_warning ("Failed to apply New output %p configuration", config);
   zwlr_output_configuration_v1_destroy (config);
+
+  err = g_error_new (G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to apply output configuration");
+  complete_config_tasks (tasks, err);
 }
 
 
@@ -1145,8 +1252,14 @@ static void
 zwlr_output_configuration_v1_handle_cancelled (void                                *data,
                                                struct zwlr_output_configuration_v1 *config)
 {
+  g_autoptr (GError) err = NULL;
+  GPtrArray *tasks = data;
+
   zwlr_output_configuration_v1_destroy (config);
   g_warning ("Failed to apply New output configuration %p due to changes", config);
+
+  err = g_error_new (G_IO_ERROR, G_IO_ERROR_BUSY, "Output configuration changed meanwhile");
+  complete_config_tasks (tasks, err);
 }
 
 
@@ -1171,6 +1284,14 @@ phosh_monitor_manager_dispose (GObject *object)
   g_clear_pointer (&self->sensor_proxy_binding, g_binding_unbind);
 
   g_clear_object (&self->gsd_color_proxy);
+  g_clear_handle_id (&self->night_light_id, g_source_remove);
+  g_clear_handle_id (&self->commit_id, g_source_remove);
+  phosh_monitor_manager_clear_dbus_replies (self);
+  if (self->commit_tasks) {
+    g_autoptr (GError) err = g_error_new (G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                                          "Monitor manager disposed");
+    complete_config_tasks (g_steal_pointer (&self->commit_tasks), err);
+  }
   g_cancellable_cancel (self->cancel);
   g_clear_object (&self->cancel);
 
@@ -1205,6 +1326,9 @@ phosh_monitor_manager_set_property (GObject      *object,
   case PROP_SENSOR_PROXY_MANAGER:
     phosh_monitor_manager_set_sensor_proxy_manager (self, g_value_get_object (value));
     break;
+  case PROP_NIGHT_LIGHT_TRANSITION_DURATION:
+    self->night_light_duration = g_value_get_uint (value);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -1227,6 +1351,9 @@ phosh_monitor_manager_get_property (GObject    *object,
   case PROP_N_MONITORS:
     g_value_set_int (value, self->monitors->len);
     break;
+  case PROP_NIGHT_LIGHT_TRANSITION_DURATION:
+    g_value_set_uint (value, self->night_light_duration);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -1234,6 +1361,111 @@ phosh_monitor_manager_get_property (GObject    *object,
 }
 
 
+static gboolean
+monitor_is_on (PhoshMonitor *monitor)
+{
+  return phosh_monitor_get_power_save_mode (monitor) == PHOSH_MONITOR_POWER_SAVE_MODE_ON;
+}
+
+
+static void
+night_light_apply (PhoshMonitorManager *self, guint32 temp)
+{
+  self->night_light_current = temp;
+
+  for (int i = 0; i < self->monitors->len; i++) {
+    PhoshMonitor *monitor = g_ptr_array_index (self->monitors, i);
+
+    /* Caught up when the monitor is turned on again */
+    if (!phosh_monitor_has_gamma (monitor) || !monitor_is_on (monitor))
+      continue;
+
+    if (!phosh_monitor_set_color_temp (monitor, temp))
+      g_warning ("Failed to set gamma for %s", monitor->name);
+  }
+}
+
+
+/*
+ * Step at the highest refresh rate of the monitors we can change the
+ * gamma of. Returns 0 if no such monitor is on.
+ */
+static guint
+night_light_get_interval (PhoshMonitorManager *self)
+{
+  int refresh = 0;
+
+  for (int i = 0; i < self->monitors->len; i++) {
+    PhoshMonitor *monitor = g_ptr_array_index (self->monitors, i);
+    int monitor_refresh = DEFAULT_REFRESH;
+
+    if (!phosh_monitor_has_gamma (monitor) || !monitor_is_on (monitor))
+      continue;
+
+    if (monitor->current_mode < monitor->modes->len) {
+      PhoshMonitorMode *mode = phosh_monitor_get_current_mode (monitor);
+
+      if (mode->refresh > 0)
+        monitor_refresh = mode->refresh;
+    }
+
+    refresh = MAX (refresh, monitor_refresh);
+  }
+
+  if (refresh == 0)
+    return 0;
+
+  return MAX (1000 * 1000 / refresh, 1);
+}
+
+
+static gboolean
+on_night_light_step (gpointer data)
+{
+  PhoshMonitorManager *self = PHOSH_MONITOR_MANAGER (data);
+  double progress, temp;
+  guint32 step;
+
+  progress = (g_get_monotonic_time () - self->night_light_start) /
+    (1000.0 * self->night_light_duration);
+
+  if (progress >= 1.0) {
+    self->night_light_id = 0;
+    if (self->night_light_current != self->night_light_temp)
+      night_light_apply (self, self->night_light_temp);
+    return G_SOURCE_REMOVE;
+  }
+
+  temp = self->night_light_from + progress * ((double)self->night_light_temp - self->night_light_from);
+  step = round (temp / NIGHT_LIGHT_TEMP_STEP) * NIGHT_LIGHT_TEMP_STEP;
+  step = CLAMP (step, 1000, 25000);
+  if (step != self->night_light_current)
+    night_light_apply (self, step);
+
+  return G_SOURCE_CONTINUE;
+}
+
+
+static void
+night_light_schedule (PhoshMonitorManager *self)
+{
+  guint interval;
+
+  g_clear_handle_id (&self->night_light_id, g_source_remove);
+
+  if (self->night_light_current == self->night_light_temp)
+    return;
+
+  /* Suspended while all monitors are off */
+  interval = night_light_get_interval (self);
+  if (interval == 0)
+    return;
+
+  self->night_light_id = g_timeout_add (interval, on_night_light_step, self);
+  g_source_set_name_by_id (self->night_light_id, "[phosh] night light transition");
+}
+
+
 static void
 on_gsd_color_temperature_changed (PhoshMonitorManager*self,
                                   GParamSpec         *pspec,
@@ -1250,14 +1482,33 @@ on_gsd_color_temperature_changed (PhoshMonitorManager*self,
 
   g_return_if_fail (self->night_light_temp > 0);
   g_debug ("Setting night light: %dK", self->night_light_temp);
-  for (int i = 0; i < self->monitors->len; i++) {
-    gboolean success;
-    PhoshMonitor *monitor = g_ptr_array_index (self->monitors, i);
 
-    success = phosh_monitor_set_color_temp (monitor, self->night_light_temp);
-    if (!success)
-      g_warning ("Failed to set gamma for %s", monitor->name);
+  /* Nothing to transition from */
+  if (self->night_light_current == 0 || self->night_light_duration == 0) {
+    g_clear_handle_id (&self->night_light_id, g_source_remove);
+    night_light_apply (self, self->night_light_temp);
+    return;
+  }
+
+  self->night_light_from = self->night_light_current;
+  self->night_light_start = g_get_monotonic_time ();
+  night_light_schedule (self);
+}
+
+
+static void
+on_monitor_power_mode_changed (PhoshMonitorManager *self, GParamSpec *pspec, PhoshMonitor *monitor)
+{
+  g_return_if_fail (PHOSH_IS_MONITOR_MANAGER (self));
+  g_return_if_fail (PHOSH_IS_MONITOR (monitor));
+
+  if (monitor_is_on (monitor) && self->night_light_current > 0 &&
+      phosh_monitor_has_gamma (monitor)) {
+    phosh_monitor_set_color_temp (monitor, self->night_light_current);
   }
+
+  /* Suspend or resume the transition */
+  night_light_schedule (self);
 }
 
 
@@ -1376,6 +1627,17 @@ phosh_monitor_manager_class_init (PhoshMonitorManagerClass *klass)
     g_param_spec_int ("n-monitors", "", "",
                       0, G_MAXINT, 0,
                       G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+  /**
+   * PhoshMonitorManager:night-light-transition-duration:
+   *
+   * The duration in milliseconds of the transition between night light
+   * temperatures. The transition is stepped at the monitors' refresh
+   * rate. `0` disables transitions.
+   */
+  props[PROP_NIGHT_LIGHT_TRANSITION_DURATION] =
+    g_param_spec_uint ("night-light-transition-duration", "", "",
+                       0, G_MAXUINT, NIGHT_LIGHT_TRANSITION_DURATION_DEFAULT,
+                       G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
 
@@ -1412,6 +1674,7 @@ phosh_monitor_manager_init (PhoshMonitorManager *self)
   self->monitors = g_ptr_array_new_with_free_func ((GDestroyNotify) (g_object_unref));
   self->heads = g_ptr_array_new_with_free_func ((GDestroyNotify) (g_object_unref));
   self->serial = 1;
+  self->night_light_duration = NIGHT_LIGHT_TRANSITION_DURATION_DEFAULT;
 
   self->cancel = g_cancellable_new ();
 }
@@ -1523,26 +1786,65 @@ phosh_monitor_manager_set_monitor_scale (PhoshMonitorManager  *self,
   phosh_head_set_pending_scale (head, scale, self->heads);
 }
 
-/**
- * phosh_monitor_manager_apply_monitor_config
- * @self: a #PhoshMonitorManager
- *
- * Applies a full output configuration
- */
-void
-phosh_monitor_manager_apply_monitor_config (PhoshMonitorManager *self)
+static gboolean
+validate_pending_config (PhoshMonitorManager *self, GError **err)
+{
+  gboolean have_enabled = FALSE;
+
+  for (int i = 0; i < self->heads->len; i++) {
+    PhoshHead *head = g_ptr_array_index (self->heads, i);
+
+    if (!head->pending.enabled)
+      continue;
+
+    have_enabled = TRUE;
+
+    if (head->pending.mode == NULL && phosh_head_get_preferred_mode (head) == NULL) {
+      g_set_error (err, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                   "Head %s has no mode", head->name);
+      return FALSE;
+    }
+
+    if (head->pending.scale <= 0.0) {
+      g_set_error (err, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                   "Invalid scale %f for head %s", head->pending.scale, head->name);
+      return FALSE;
+    }
+  }
+
+  if (self->heads->len && !have_enabled) {
+    g_set_error (err, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT, "No enabled head");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+static void
+commit_monitor_config (PhoshMonitorManager *self)
 {
   PhoshWayland *wl = phosh_wayland_get_default ();
   struct zwlr_output_configuration_v1 *config;
   struct zwlr_output_manager_v1 *output_manager =
     phosh_wayland_get_zwlr_output_manager_v1 (wl);
+  g_autoptr (GError) err = NULL;
+  GPtrArray *tasks;
 
-  g_return_if_fail (PHOSH_IS_MONITOR_MANAGER (self));
+  g_clear_handle_id (&self->commit_id, g_source_remove);
+  tasks = g_steal_pointer (&self->commit_tasks);
+
+  if (!validate_pending_config (self, &err)) {
+    g_warning ("Not applying invalid output configuration: %s", err->message);
+    phosh_monitor_manager_clear_pending (self);
+    complete_config_tasks (tasks, err);
+    return;
+  }
 
   config = zwlr_output_manager_v1_create_configuration (output_manager,
                                                         self->zwlr_output_serial);
 
-  zwlr_output_configuration_v1_add_listener (config, &config_listener, self);
+  zwlr_output_configuration_v1_add_listener (config, &config_listener, tasks);
   for (int i = 0; i < self->heads->len; i++) {
     struct zwlr_output_configuration_head_v1 *config_head;
     PhoshHead *head = g_ptr_array_index (self->heads, i);
@@ -1578,6 +1880,109 @@ phosh_monitor_manager_apply_monitor_config (PhoshMonitorManager *self)
   zwlr_output_configuration_v1_apply (config);
 }
 
+
+static gboolean
+on_commit_monitor_config (gpointer data)
+{
+  PhoshMonitorManager *self = PHOSH_MONITOR_MANAGER (data);
+
+  self->commit_id = 0;
+  commit_monitor_config (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+schedule_commit (PhoshMonitorManager *self, GTask *task)
+{
+  if (self->commit_tasks == NULL)
+    self->commit_tasks = g_ptr_array_new_with_free_func (g_object_unref);
+
+  if (task)
+    g_ptr_array_add (self->commit_tasks, task);
+
+  if (self->commit_id)
+    return;
+
+  /* Collect all changes up to the next frame */
+  self->commit_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE + 10,
+                                     on_commit_monitor_config,
+                                     self,
+                                     NULL);
+  g_source_set_name_by_id (self->commit_id, "[phosh] commit monitor config");
+}
+
+/**
+ * phosh_monitor_manager_apply_monitor_config
+ * @self: a #PhoshMonitorManager
+ *
+ * Applies a full output configuration. See
+ * [method@MonitorManager.apply_monitor_config_async].
+ */
+void
+phosh_monitor_manager_apply_monitor_config (PhoshMonitorManager *self)
+{
+  g_return_if_fail (PHOSH_IS_MONITOR_MANAGER (self));
+
+  schedule_commit (self, NULL);
+}
+
+/**
+ * phosh_monitor_manager_apply_monitor_config_async:
+ * @self: a #PhoshMonitorManager
+ * @cancellable: (nullable): A cancellable
+ * @callback: The callback to invoke once the configuration was applied
+ * @user_data: The user data for @callback
+ *
+ * Applies a full output configuration built from the pending head
+ * changes. Requests made before the next frame are coalesced into a
+ * single output configuration that is validated and applied at once
+ * so e.g. a rotation followed by a scale change results in a single
+ * mode set. @callback is invoked when the compositor applied (or
+ * rejected) that configuration.
+ */
+void
+phosh_monitor_manager_apply_monitor_config_async (PhoshMonitorManager *self,
+                                                  GCancellable        *cancellable,
+                                                  GAsyncReadyCallback  callback,
+                                                  gpointer             user_data)
+{
+  GTask *task;
+
+  g_return_if_fail (PHOSH_IS_MONITOR_MANAGER (self));
+
+  task = g_task_new (self, cancellable, callback, user_data);
+  g_task_set_source_tag (task, phosh_monitor_manager_apply_monitor_config_async);
+  g_task_set_check_cancellable (task, TRUE);
+
+  schedule_commit (self, task);
+}
+
+/**
+ * phosh_monitor_manager_apply_monitor_config_finish:
+ * @self: a #PhoshMonitorManager
+ * @res: The async result
+ * @error: The return location for an error
+ *
+ * Finish an operation started via
+ * [method@MonitorManager.apply_monitor_config_async].
+ *
+ * Returns: %TRUE if the configuration was applied, otherwise %FALSE
+ */
+gboolean
+phosh_monitor_manager_apply_monitor_config_finish (PhoshMonitorManager  *self,
+                                                   GAsyncResult         *res,
+                                                   GError              **error)
+{
+  g_return_val_if_fail (PHOSH_IS_MONITOR_MANAGER (self), FALSE);
+  g_return_val_if_fail (g_task_is_valid (res, self), FALSE);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (res)) ==
+                        phosh_monitor_manager_apply_monitor_config_async, FALSE);
+
+  return g_task_propagate_boolean (G_TASK (res), error);
+}
+
 void
 phosh_monitor_manager_set_sensor_proxy_manager (PhoshMonitorManager     *self,
                                                 PhoshSensorProxyManager *manager)
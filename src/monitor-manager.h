@@ -48,6 +48,13 @@ void                  phosh_monitor_manager_set_monitor_scale         (PhoshMoni
                                                                        PhoshMonitor        *monitor,
                                                                        double               scale);
 void                  phosh_monitor_manager_apply_monitor_config      (PhoshMonitorManager *self);
+void                  phosh_monitor_manager_apply_monitor_config_async (PhoshMonitorManager *self,
+                                                                        GCancellable        *cancellable,
+                                                                        GAsyncReadyCallback  callback,
+                                                                        gpointer             user_data);
+gboolean              phosh_monitor_manager_apply_monitor_config_finish (PhoshMonitorManager  *self,
+                                                                         GAsyncResult         *res,
+                                                                         GError              **error);
 void                  phosh_monitor_manager_set_sensor_proxy_manager  (PhoshMonitorManager     *self,
                                                                        PhoshSensorProxyManager *manager);
 gboolean              phosh_monitor_manager_enable_fallback           (PhoshMonitorManager *self);
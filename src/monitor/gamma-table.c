@@ -11,8 +11,26 @@
 #define G_LOG_DOMAIN "phosh-gamma-table"
 
 #include "gamma-table.h"
+#include "util.h"
 
-#include <math.h>
+#include <glib/gstdio.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* Number of computed gamma tables to keep around */
+#define GAMMA_TABLE_CACHE_SIZE 32
+
+typedef struct {
+  guint32  ramp_size;
+  guint32  temp;
+  guint16 *table;
+} GammaTableEntry;
+
+/* Most recently used first */
+static GQueue gamma_table_cache = G_QUEUE_INIT;
 
 static const float blackbody_color[] = {
   1.00000000,  0.18172716,  0.00000000,       /* 1000K */
@@ -269,32 +287,41 @@ interpolate_color (float a, const float *c1, const float *c2, float *c)
 }
 
 
-/* Helper macro used in the fill functions */
-#define F(Y, C)  pow ((Y) *brightness * white_point[C], 1.0 / gamma[C])
-
+/*
+ * We use a gamma of 1.0 and a brightness of 1.0 so the usual
+ * pow (Y * brightness * white_point, 1.0 / gamma) collapses to a
+ * plain multiplication with the white point. The loops are kept free of
+ * calls and branches so the compiler can vectorize them.
+ */
 static void
 colorramp_fill (guint16 *gamma_r,
                 guint16 *gamma_g,
                 guint16 *gamma_b,
-                int      ramp_size,
+                guint32  ramp_size,
                 guint32  temp)
 {
   /* Approximate white point */
   float white_point[3];
   float alpha = (temp % 100) / 100.0;
   int temp_index = ((temp - 1000) / 100) * 3;
-  float brightness = 1.0;
-  float gamma[3] = { 1.0, 1.0, 1.0 };
+  double wp_r, wp_g, wp_b;
 
   interpolate_color (alpha,
                      &blackbody_color[temp_index],
                      &blackbody_color[temp_index+3],
                      white_point);
 
-  for (int i = 0; i < ramp_size; i++) {
-    gamma_r[i] = F ((double)gamma_r[i]/(G_MAXUINT16+1), 0) * (G_MAXUINT16+1);
-    gamma_g[i] = F ((double)gamma_g[i]/(G_MAXUINT16+1), 1) * (G_MAXUINT16+1);
-    gamma_b[i] = F ((double)gamma_b[i]/(G_MAXUINT16+1), 2) * (G_MAXUINT16+1);
+  wp_r = white_point[0];
+  wp_g = white_point[1];
+  wp_b = white_point[2];
+
+  for (guint32 i = 0; i < ramp_size; i++) {
+    /* The identity ramp */
+    double value = (guint16) ((double)i / ramp_size * (G_MAXUINT16+1));
+
+    gamma_r[i] = value * wp_r;
+    gamma_g[i] = value * wp_g;
+    gamma_b[i] = value * wp_b;
   }
 }
 
@@ -308,13 +335,100 @@ phosh_gamma_table_fill (guint16 *table, guint32 ramp_size, guint32 temp)
 
   g_return_if_fail (temp >= 1000 && temp <= 25000);
 
-  /* Initialize gamma ramps to pure state */
-  for (guint32 i = 0; i < ramp_size; i++) {
-    guint16 value = (double)i / ramp_size * (G_MAXUINT16+1);
-    r[i] = value;
-    g[i] = value;
-    b[i] = value;
+  colorramp_fill (r, g, b, ramp_size, temp);
+}
+
+
+static void
+gamma_table_entry_free (GammaTableEntry *entry)
+{
+  g_free (entry->table);
+  g_free (entry);
+}
+
+
+static const guint16 *
+gamma_table_lookup (guint32 ramp_size, guint32 temp)
+{
+  GammaTableEntry *entry;
+
+  for (GList *l = gamma_table_cache.head; l; l = l->next) {
+    entry = l->data;
+
+    if (entry->ramp_size != ramp_size || entry->temp != temp)
+      continue;
+
+    g_queue_unlink (&gamma_table_cache, l);
+    g_queue_push_head_link (&gamma_table_cache, l);
+    return entry->table;
   }
 
-  colorramp_fill (r, g, b, ramp_size, temp);
+  entry = g_new0 (GammaTableEntry, 1);
+  entry->ramp_size = ramp_size;
+  entry->temp = temp;
+  entry->table = g_new (guint16, ramp_size * 3);
+  phosh_gamma_table_fill (entry->table, ramp_size, temp);
+  g_queue_push_head (&gamma_table_cache, entry);
+
+  while (gamma_table_cache.length > GAMMA_TABLE_CACHE_SIZE)
+    gamma_table_entry_free (g_queue_pop_tail (&gamma_table_cache));
+
+  return entry->table;
+}
+
+/**
+ * phosh_gamma_table_get_fd:
+ * @ramp_size: The number of entries per color channel
+ * @temp: The color temperature in Kelvin
+ *
+ * Get a file descriptor with the gamma table for the given ramp size
+ * and temperature suitable for `zwlr_gamma_control_v1_set_gamma`.
+ * Recently used tables are kept around so going back and forth between
+ * temperatures doesn't need to recompute them. Each call returns a new
+ * file so requests don't share a file offset. The caller needs to close
+ * the file descriptor.
+ *
+ * Returns: The file descriptor or -1 on error
+ */
+int
+phosh_gamma_table_get_fd (guint32 ramp_size, guint32 temp)
+{
+  g_autofd int fd = -1;
+  const guint16 *table;
+  guint16 *data;
+  off_t size;
+
+  g_return_val_if_fail (ramp_size > 0, -1);
+  g_return_val_if_fail (temp >= 1000 && temp <= 25000, -1);
+
+  table = gamma_table_lookup (ramp_size, temp);
+
+  size = ramp_size * sizeof (guint16) * 3;
+  fd = phosh_create_shm_file (size);
+  if (fd < 0) {
+    g_warning ("Failed to create shm file");
+    return -1;
+  }
+
+  data = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    g_warning ("Failed to map gamma table: %s", g_strerror (errno));
+    return -1;
+  }
+
+  memcpy (data, table, size);
+  munmap (data, size);
+
+  return g_steal_fd (&fd);
+}
+
+/**
+ * phosh_gamma_table_clear_cache:
+ *
+ * Drop all cached gamma tables.
+ */
+void
+phosh_gamma_table_clear_cache (void)
+{
+  g_queue_clear_full (&gamma_table_cache, (GDestroyNotify) gamma_table_entry_free);
 }
@@ -10,6 +10,8 @@
 
 G_BEGIN_DECLS
 
-void phosh_gamma_table_fill (guint16 *table, guint32 ramp_size, guint32 temp);
+void phosh_gamma_table_fill        (guint16 *table, guint32 ramp_size, guint32 temp);
+int  phosh_gamma_table_get_fd      (guint32 ramp_size, guint32 temp);
+void phosh_gamma_table_clear_cache (void);
 
 G_END_DECLS
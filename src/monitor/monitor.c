@@ -15,7 +15,6 @@
 
 #include <glib/gstdio.h>
 
-#include <sys/mman.h>
 #include <errno.h>
 
 #include <gdk/gdkwayland.h>
@@ -793,29 +792,17 @@ phosh_monitor_transform_is_tilted (PhoshMonitorTransform transform)
 gboolean
 phosh_monitor_set_color_temp (PhoshMonitor *self, guint32 temp)
 {
-  g_autofd int fd = -1;
-  guint16 *table;
-  off_t size;
+  int fd;
 
   if (!phosh_monitor_has_gamma (self))
     return FALSE;
 
-  size = self->n_gamma_entries * sizeof (guint16) * 3;
-  fd = phosh_create_shm_file (size);
-  if (fd < 0) {
-    g_warning ("Failed to create shm file");
+  fd = phosh_gamma_table_get_fd (self->n_gamma_entries, temp);
+  if (fd < 0)
     return FALSE;
-  }
-
-  table = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-  if (table == MAP_FAILED) {
-    g_warning ("Failed to map gamma table");
-    return FALSE;
-  }
 
-  phosh_gamma_table_fill (table, self->n_gamma_entries, temp);
-  munmap (table, size);
   zwlr_gamma_control_v1_set_gamma (self->gamma_control, fd);
+  g_close (fd, NULL);
 
   return TRUE;
 }
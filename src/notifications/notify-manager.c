@@ -13,12 +13,14 @@
 #include <gio/gdesktopappinfo.h>
 
 #include "dbus-notification.h"
+#include "memory-registry.h"
 #include "notification-banner.h"
 #include "notification-list.h"
 #include "notify-manager.h"
 #include "notify-feedback.h"
 #include "shell-priv.h"
 #include "phosh-enums.h"
+#include "trace.h"
 #include "util.h"
 
 #include <gmobile.h>
@@ -435,6 +437,7 @@ handle_notify (PhoshNotifyDBusNotifications *skeleton,
   g_autofree char *sound_file = NULL;
   GIcon *icon = NULL;
   GIcon *image = NULL;
+  gint64 trace = PHOSH_TRACE_BEGIN ();
 
   g_return_val_if_fail (PHOSH_IS_NOTIFY_MANAGER (self), FALSE);
 
@@ -575,6 +578,8 @@ handle_notify (PhoshNotifyDBusNotifications *skeleton,
   phosh_notify_dbus_notifications_complete_notify (
     skeleton, invocation, id);
 
+  PHOSH_TRACE_END (trace, "notification-ingest", "%s (%u)", source_id, id);
+
   return TRUE;
 }
 
@@ -649,11 +654,36 @@ on_bus_acquired (GDBusConnection *connection,
 }
 
 
+static void
+get_memory_usage (gpointer owner, gsize *bytes, guint *n_entries)
+{
+  PhoshNotifyManager *self = PHOSH_NOTIFY_MANAGER (owner);
+  GListModel *sources = G_LIST_MODEL (self->list);
+
+  /* Only images sent as raw data are held by us */
+  for (guint i = 0; i < g_list_model_get_n_items (sources); i++) {
+    g_autoptr (GListModel) source = g_list_model_get_item (sources, i);
+
+    for (guint j = 0; j < g_list_model_get_n_items (source); j++) {
+      g_autoptr (PhoshNotification) notification = g_list_model_get_item (source, j);
+      GIcon *image = phosh_notification_get_image (notification);
+
+      if (GDK_IS_PIXBUF (image)) {
+        *bytes += gdk_pixbuf_get_byte_length (GDK_PIXBUF (image));
+        (*n_entries)++;
+      }
+    }
+  }
+}
+
+
 static void
 phosh_notify_manager_dispose (GObject *object)
 {
   PhoshNotifyManager *self = PHOSH_NOTIFY_MANAGER (object);
 
+  phosh_memory_registry_remove (phosh_memory_registry_get_default (), self);
+
   g_clear_handle_id (&self->dbus_name_id, g_bus_unown_name);
 
   if (g_dbus_interface_skeleton_get_object_path (G_DBUS_INTERFACE_SKELETON (self)))
@@ -765,6 +795,13 @@ phosh_notify_manager_init (PhoshNotifyManager *self)
   self->next_id = 1;
 
   self->list = phosh_notification_list_new ();
+
+  phosh_memory_registry_add (phosh_memory_registry_get_default (),
+                             "notification-images",
+                             PHOSH_MEMORY_PRIORITY_ACTIVE,
+                             self,
+                             get_memory_usage,
+                             NULL);
 }
 
 /**
@@ -13,6 +13,7 @@
 #include "activity.h"
 #include "app-grid-button.h"
 #include "app-grid.h"
+#include "memory-registry.h"
 #include "overview.h"
 #include "wlr-screencopy-unstable-v1-client-protocol.h"
 #include "phosh-private-client-protocol.h"
@@ -27,6 +28,8 @@
 #include <handy.h>
 
 #define OVERVIEW_ICON_SIZE 64
+/* Set on activities whose thumbnail got dropped on memory pressure */
+#define THUMBNAIL_DROPPED_KEY "phosh-thumbnail-dropped"
 
 /**
  * PhoshOverview:
@@ -254,6 +257,10 @@ request_thumbnail (PhoshActivity *activity, PhoshToplevel *toplevel)
   scale = gtk_widget_get_scale_factor (GTK_WIDGET (activity));
   phosh_activity_get_thumbnail_allocation (activity, &allocation);
   thumbnail = phosh_toplevel_thumbnail_new_from_toplevel (toplevel, allocation.width * scale, allocation.height * scale);
+  if (thumbnail == NULL)
+    return;
+
+  g_object_set_data (G_OBJECT (activity), THUMBNAIL_DROPPED_KEY, NULL);
   g_signal_connect_object (thumbnail, "notify::ready", G_CALLBACK (on_thumbnail_ready_changed), activity, 0);
 }
 
@@ -511,6 +518,62 @@ page_changed_cb (PhoshOverview *self,
 }
 
 
+static void
+get_memory_usage (gpointer owner, gsize *bytes, guint *n_entries)
+{
+  PhoshOverview *self = PHOSH_OVERVIEW (owner);
+  PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
+  g_autoptr (GList) children = NULL;
+
+  children = gtk_container_get_children (GTK_CONTAINER (priv->carousel_running_activities));
+  for (GList *l = children; l; l = l->next) {
+    gsize size = phosh_activity_get_thumbnail_bytes (PHOSH_ACTIVITY (l->data));
+
+    if (size) {
+      *bytes += size;
+      (*n_entries)++;
+    }
+  }
+}
+
+
+static void
+shrink_memory (gpointer owner)
+{
+  PhoshOverview *self = PHOSH_OVERVIEW (owner);
+  PhoshOverviewPrivate *priv = phosh_overview_get_instance_private (self);
+  g_autoptr (GList) children = NULL;
+
+  /* Thumbnails are visible */
+  if (phosh_shell_get_state (phosh_shell_get_default ()) & PHOSH_STATE_OVERVIEW)
+    return;
+
+  /* Keep the current one so opening the overview looks right, the
+   * others get requested again in phosh_overview_refresh () */
+  children = gtk_container_get_children (GTK_CONTAINER (priv->carousel_running_activities));
+  for (GList *l = children; l; l = l->next) {
+    PhoshActivity *activity = PHOSH_ACTIVITY (l->data);
+
+    if (activity == priv->activity || phosh_activity_get_thumbnail_bytes (activity) == 0)
+      continue;
+
+    phosh_activity_clear_thumbnail (activity);
+    g_object_set_data (G_OBJECT (activity), THUMBNAIL_DROPPED_KEY, GINT_TO_POINTER (TRUE));
+  }
+}
+
+
+static void
+phosh_overview_dispose (GObject *object)
+{
+  PhoshOverview *self = PHOSH_OVERVIEW (object);
+
+  phosh_memory_registry_remove (phosh_memory_registry_get_default (), self);
+
+  G_OBJECT_CLASS (phosh_overview_parent_class)->dispose (object);
+}
+
+
 static void
 phosh_overview_constructed (GObject *object)
 {
@@ -543,6 +606,13 @@ phosh_overview_constructed (GObject *object)
 
   g_signal_connect_swapped (priv->carousel_running_activities, "page-changed",
                             G_CALLBACK (page_changed_cb), self);
+
+  phosh_memory_registry_add (phosh_memory_registry_get_default (),
+                             "activity-thumbnails",
+                             PHOSH_MEMORY_PRIORITY_INACTIVE,
+                             self,
+                             get_memory_usage,
+                             shrink_memory);
 }
 
 
@@ -553,6 +623,7 @@ phosh_overview_class_init (PhoshOverviewClass *klass)
   GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
   object_class->constructed = phosh_overview_constructed;
+  object_class->dispose = phosh_overview_dispose;
   object_class->get_property = phosh_overview_get_property;
   widget_class->size_allocate = phosh_overview_size_allocate;
 
@@ -624,6 +695,7 @@ void
 phosh_overview_refresh (PhoshOverview *self)
 {
   PhoshOverviewPrivate *priv;
+  g_autoptr (GList) children = NULL;
   g_return_if_fail(PHOSH_IS_OVERVIEW (self));
   priv = phosh_overview_get_instance_private (self);
 
@@ -631,6 +703,15 @@ phosh_overview_refresh (PhoshOverview *self)
     gtk_widget_grab_focus (GTK_WIDGET (priv->activity));
     request_thumbnail (priv->activity, get_toplevel_from_activity (priv->activity));
   }
+
+  /* Thumbnails might have been dropped on memory pressure */
+  children = gtk_container_get_children (GTK_CONTAINER (priv->carousel_running_activities));
+  for (GList *l = children; l; l = l->next) {
+    PhoshActivity *activity = PHOSH_ACTIVITY (l->data);
+
+    if (activity != priv->activity && g_object_get_data (G_OBJECT (activity), THUMBNAIL_DROPPED_KEY))
+      request_thumbnail (activity, get_toplevel_from_activity (activity));
+  }
 }
 
 
@@ -13,8 +13,13 @@
 #include "plugin-loader.h"
 
 #include <gio/gio.h>
+#include <glib/gstdio.h>
 #include <gtk/gtk.h>
 
+#define PLUGIN_MANIFEST     "phosh-plugins.manifest"
+#define PLUGIN_INFO_SUFFIX  ".plugin"
+#define PLUGIN_INFO_GROUP   "Plugin"
+
 enum {
   PROP_0,
   PROP_PLUGIN_DIRS,
@@ -28,18 +33,383 @@ static GParamSpec *props[PROP_LAST_PROP];
  *
  * Loads plugins for a given extension point
  *
+ * To avoid loading modules that aren't used the loader looks at the
+ * plugin infos (`*.plugin`) in each plugin directory and only loads
+ * the module of a plugin when that plugin is requested. The infos are
+ * read from a manifest generated at build time as long as it matches
+ * the plugin infos in the directory. Directories without plugin infos
+ * are scanned for modules instead. The results are shared between
+ * all loaders.
+ *
  * Since: 0.21.0
  */
 
+typedef struct {
+  GStrv  types;
+  char  *module;
+} PhoshPluginInfo;
+
+typedef struct {
+  gint64      mtime;
+  GHashTable *plugins;
+} PhoshPluginDir;
+
+/* Directory -> PhoshPluginDir */
+static GHashTable *plugin_dirs_cache;
+/* Bumped whenever a plugin directory gets (re)read */
+static guint plugin_dirs_generation;
+/* Directories scanned for modules */
+static GHashTable *scanned_dirs;
+/* Modules loaded on demand, blocked from scans */
+static GIOModuleScope *module_scope;
+
+static const struct {
+  const char *extension_point;
+  const char *type;
+} plugin_types[] = {
+  { PHOSH_EXTENSION_POINT_LOCKSCREEN_WIDGET, "lockscreen" },
+  { PHOSH_EXTENSION_POINT_QUICK_SETTING_WIDGET, "quick-setting" },
+};
+
 struct _PhoshPluginLoader {
   GObject parent;
 
-  GStrv   plugin_dirs;
-  char   *extension_point;
+  GStrv       plugin_dirs;
+  char       *extension_point;
+  GHashTable *load_times;
+  /* Plugin name -> plugin dirs generation it wasn't found in */
+  GHashTable *missing_plugins;
 };
 
 G_DEFINE_TYPE (PhoshPluginLoader, phosh_plugin_loader, G_TYPE_OBJECT)
 
+
+static void
+plugin_info_free (PhoshPluginInfo *info)
+{
+  g_strfreev (info->types);
+  g_free (info->module);
+  g_free (info);
+}
+
+
+static void
+plugin_dir_free (PhoshPluginDir *plugin_dir)
+{
+  g_hash_table_destroy (plugin_dir->plugins);
+  g_free (plugin_dir);
+}
+
+
+static gint64
+get_mtime (const char *path)
+{
+  GStatBuf st;
+
+  if (g_stat (path, &st) != 0)
+    return -1;
+
+  return st.st_mtime;
+}
+
+
+static const char *
+get_plugin_type (const char *extension_point)
+{
+  for (guint i = 0; i < G_N_ELEMENTS (plugin_types); i++) {
+    if (g_str_equal (plugin_types[i].extension_point, extension_point))
+      return plugin_types[i].type;
+  }
+
+  return NULL;
+}
+
+
+static void
+add_plugin_info (PhoshPluginDir *plugin_dir,
+                 const char     *dir,
+                 GKeyFile       *keyfile,
+                 const char     *group,
+                 const char     *id)
+{
+  g_autofree char *module = NULL;
+  g_auto (GStrv) types = NULL;
+  PhoshPluginInfo *info;
+
+  module = g_key_file_get_string (keyfile, group, "Plugin", NULL);
+  types = g_key_file_get_string_list (keyfile, group, "Types", NULL, NULL);
+  if (module == NULL || types == NULL) {
+    g_debug ("Incomplete plugin info for '%s' in '%s'", id, dir);
+    return;
+  }
+
+  /* Plugin infos in the build dir point to the install location */
+  if (!g_file_test (module, G_FILE_TEST_EXISTS)) {
+    g_autofree char *basename = g_path_get_basename (module);
+
+    g_free (module);
+    module = g_build_filename (dir, basename, NULL);
+  }
+
+  info = g_new0 (PhoshPluginInfo, 1);
+  info->types = g_steal_pointer (&types);
+  info->module = g_steal_pointer (&module);
+  g_hash_table_insert (plugin_dir->plugins, g_strdup (id), info);
+}
+
+
+static guint
+count_plugin_infos (const char *dir)
+{
+  g_autoptr (GDir) gdir = NULL;
+  const char *name;
+  guint n_infos = 0;
+
+  gdir = g_dir_open (dir, 0, NULL);
+  if (gdir == NULL)
+    return 0;
+
+  while ((name = g_dir_read_name (gdir))) {
+    if (g_str_has_suffix (name, PLUGIN_INFO_SUFFIX))
+      n_infos++;
+  }
+
+  return n_infos;
+}
+
+/*
+ * The manifest lists the name, size and mtime of each plugin info it
+ * was generated from. It's only valid if it lists exactly the plugin
+ * infos in the directory and none of them changed in size or mtime.
+ */
+static gboolean
+manifest_is_current (GKeyFile *keyfile, GStrv groups, const char *dir)
+{
+  if (g_strv_length (groups) != count_plugin_infos (dir))
+    return FALSE;
+
+  for (int i = 0; groups[i]; i++) {
+    g_autofree char *info = g_key_file_get_string (keyfile, groups[i], "Info", NULL);
+    g_autofree char *path = NULL;
+    g_autoptr (GError) err = NULL;
+    GStatBuf st;
+    gint64 size, mtime;
+
+    size = g_key_file_get_int64 (keyfile, groups[i], "InfoSize", &err);
+    if (info == NULL || err)
+      return FALSE;
+
+    mtime = g_key_file_get_int64 (keyfile, groups[i], "InfoMTime", &err);
+    if (err)
+      return FALSE;
+
+    if (strchr (info, G_DIR_SEPARATOR) || !g_str_has_suffix (info, PLUGIN_INFO_SUFFIX))
+      return FALSE;
+
+    path = g_build_filename (dir, info, NULL);
+    if (g_stat (path, &st) != 0 || st.st_size != size || st.st_mtime != mtime)
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+static gboolean
+read_manifest (PhoshPluginDir *plugin_dir, const char *dir)
+{
+  g_autofree char *path = g_build_filename (dir, PLUGIN_MANIFEST, NULL);
+  g_autoptr (GKeyFile) keyfile = g_key_file_new ();
+  g_autoptr (GError) err = NULL;
+  g_auto (GStrv) groups = NULL;
+
+  if (!g_key_file_load_from_file (keyfile, path, G_KEY_FILE_NONE, &err)) {
+    if (!g_error_matches (err, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+      g_warning ("Failed to load plugin manifest '%s': %s", path, err->message);
+    return FALSE;
+  }
+
+  groups = g_key_file_get_groups (keyfile, NULL);
+  if (!manifest_is_current (keyfile, groups, dir)) {
+    g_debug ("Plugin manifest '%s' outdated", path);
+    return FALSE;
+  }
+
+  for (int i = 0; groups[i]; i++)
+    add_plugin_info (plugin_dir, dir, keyfile, groups[i], groups[i]);
+
+  return TRUE;
+}
+
+
+static void
+read_plugin_infos (PhoshPluginDir *plugin_dir, const char *dir)
+{
+  g_autoptr (GDir) gdir = NULL;
+  const char *name;
+
+  gdir = g_dir_open (dir, 0, NULL);
+  if (gdir == NULL)
+    return;
+
+  while ((name = g_dir_read_name (gdir))) {
+    g_autoptr (GKeyFile) keyfile = NULL;
+    g_autofree char *path = NULL;
+    g_autofree char *id = NULL;
+
+    if (!g_str_has_suffix (name, PLUGIN_INFO_SUFFIX))
+      continue;
+
+    keyfile = g_key_file_new ();
+    path = g_build_filename (dir, name, NULL);
+    if (!g_key_file_load_from_file (keyfile, path, G_KEY_FILE_NONE, NULL))
+      continue;
+
+    id = g_key_file_get_string (keyfile, PLUGIN_INFO_GROUP, "Id", NULL);
+    if (id == NULL)
+      continue;
+
+    add_plugin_info (plugin_dir, dir, keyfile, PLUGIN_INFO_GROUP, id);
+  }
+}
+
+
+static PhoshPluginDir *
+get_plugin_dir (const char *dir)
+{
+  PhoshPluginDir *plugin_dir;
+  gint64 mtime = get_mtime (dir);
+
+  if (G_UNLIKELY (plugin_dirs_cache == NULL)) {
+    plugin_dirs_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                               (GDestroyNotify) plugin_dir_free);
+  }
+
+  plugin_dir = g_hash_table_lookup (plugin_dirs_cache, dir);
+  if (plugin_dir && plugin_dir->mtime == mtime)
+    return plugin_dir;
+
+  plugin_dir = g_new0 (PhoshPluginDir, 1);
+  plugin_dir->mtime = mtime;
+  plugin_dir->plugins = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                               (GDestroyNotify) plugin_info_free);
+  if (mtime >= 0 && !read_manifest (plugin_dir, dir))
+    read_plugin_infos (plugin_dir, dir);
+
+  g_debug ("Found %u plugin infos in '%s'", g_hash_table_size (plugin_dir->plugins), dir);
+  g_hash_table_insert (plugin_dirs_cache, g_strdup (dir), plugin_dir);
+  plugin_dirs_generation++;
+
+  return plugin_dir;
+}
+
+
+static gboolean
+has_plugins_of_type (PhoshPluginDir *plugin_dir, const char *type)
+{
+  GHashTableIter iter;
+  PhoshPluginInfo *info;
+
+  if (type == NULL)
+    return FALSE;
+
+  g_hash_table_iter_init (&iter, plugin_dir->plugins);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &info)) {
+    if (g_strv_contains ((const char * const *) info->types, type))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+
+static GIOModuleScope *
+get_module_scope (void)
+{
+  if (G_UNLIKELY (module_scope == NULL))
+    module_scope = g_io_module_scope_new (G_IO_MODULE_SCOPE_BLOCK_DUPLICATES);
+
+  return module_scope;
+}
+
+
+static void
+scan_dir (const char *dir)
+{
+  if (G_UNLIKELY (scanned_dirs == NULL))
+    scanned_dirs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  if (g_hash_table_contains (scanned_dirs, dir))
+    return;
+
+  g_debug ("Scanning '%s' for modules", dir);
+  g_io_modules_scan_all_in_directory_with_scope (dir, get_module_scope ());
+  g_hash_table_add (scanned_dirs, g_strdup (dir));
+}
+
+
+static gboolean
+load_module (const char *path)
+{
+  g_autofree char *basename = g_path_get_basename (path);
+  GIOModule *module;
+
+  /* Keep the module around, like GIO does, types can't be unregistered */
+  module = g_io_module_new (path);
+  if (!g_type_module_use (G_TYPE_MODULE (module))) {
+    g_warning ("Failed to load module '%s'", path);
+    g_object_unref (module);
+    return FALSE;
+  }
+  g_type_module_unuse (G_TYPE_MODULE (module));
+
+  g_io_module_scope_block (get_module_scope (), basename);
+  return TRUE;
+}
+
+
+/*
+ * Whether the plugin wasn't found the last time it was looked up and
+ * none of the plugin directories changed since then.
+ */
+static gboolean
+is_missing_plugin (PhoshPluginLoader *self, const char *name)
+{
+  gpointer generation;
+
+  for (int i = 0; i < g_strv_length (self->plugin_dirs); i++)
+    get_plugin_dir (self->plugin_dirs[i]);
+
+  if (!g_hash_table_lookup_extended (self->missing_plugins, name, NULL, &generation))
+    return FALSE;
+
+  return GPOINTER_TO_UINT (generation) == plugin_dirs_generation;
+}
+
+
+static GIOExtension *
+load_plugin_module (PhoshPluginLoader *self, GIOExtensionPoint *ep, const char *name)
+{
+  const char *type = get_plugin_type (self->extension_point);
+
+  if (type == NULL)
+    return NULL;
+
+  for (int i = 0; i < g_strv_length (self->plugin_dirs); i++) {
+    PhoshPluginDir *plugin_dir = get_plugin_dir (self->plugin_dirs[i]);
+    PhoshPluginInfo *info = g_hash_table_lookup (plugin_dir->plugins, name);
+
+    if (info == NULL || !g_strv_contains ((const char * const *) info->types, type))
+      continue;
+
+    g_debug ("Loading module '%s' for plugin %s", info->module, name);
+    if (load_module (info->module))
+      return g_io_extension_point_get_extension_by_name (ep, name);
+  }
+
+  return NULL;
+}
+
 static void
 phosh_plugin_loader_set_property (GObject      *object,
                                   guint         property_id,
@@ -104,8 +474,14 @@ phosh_plugin_loader_constructed (GObject *object)
   g_io_extension_point_set_required_type (ep, GTK_TYPE_WIDGET);
 
   for (int i = 0; i < g_strv_length (self->plugin_dirs); i++) {
+    PhoshPluginDir *plugin_dir = get_plugin_dir (self->plugin_dirs[i]);
+
     g_debug ("Will load plugins from '%s' for '%s'", self->plugin_dirs[i], self->extension_point);
-    g_io_modules_scan_all_in_directory (self->plugin_dirs[i]);
+    /* Modules get loaded on demand */
+    if (has_plugins_of_type (plugin_dir, get_plugin_type (self->extension_point)))
+      continue;
+
+    scan_dir (self->plugin_dirs[i]);
   }
 }
 
@@ -117,6 +493,8 @@ phosh_plugin_loader_dispose (GObject *object)
 
   g_clear_pointer (&self->plugin_dirs, g_strfreev);
   g_clear_pointer (&self->extension_point, g_free);
+  g_clear_pointer (&self->load_times, g_hash_table_destroy);
+  g_clear_pointer (&self->missing_plugins, g_hash_table_destroy);
 
   G_OBJECT_CLASS (phosh_plugin_loader_parent_class)->dispose (object);
 }
@@ -159,6 +537,8 @@ phosh_plugin_loader_class_init (PhoshPluginLoaderClass *klass)
 static void
 phosh_plugin_loader_init (PhoshPluginLoader *self)
 {
+  self->load_times = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+  self->missing_plugins = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 }
 
 
@@ -185,7 +565,9 @@ phosh_plugin_loader_load_plugin (PhoshPluginLoader *self, const char *name)
 {
   GIOExtensionPoint *ep;
   GIOExtension *extension;
+  GtkWidget *widget;
   GType type;
+  gint64 start, *load_time;
 
   g_return_val_if_fail (PHOSH_IS_PLUGIN_LOADER (self), NULL);
   g_return_val_if_fail (name, NULL);
@@ -193,12 +575,63 @@ phosh_plugin_loader_load_plugin (PhoshPluginLoader *self, const char *name)
   ep = g_io_extension_point_lookup (self->extension_point);
 
   extension = g_io_extension_point_get_extension_by_name (ep, name);
-  if (extension == NULL)
+  if (extension == NULL) {
+    /* Don't look at the plugin dirs again for unknown plugins */
+    if (is_missing_plugin (self, name))
+      return NULL;
+
+    extension = load_plugin_module (self, ep, name);
+  }
+
+  if (extension == NULL) {
+    /* Plugins without plugin info */
+    for (int i = 0; i < g_strv_length (self->plugin_dirs); i++)
+      scan_dir (self->plugin_dirs[i]);
+    extension = g_io_extension_point_get_extension_by_name (ep, name);
+  }
+
+  if (extension == NULL) {
+    g_debug ("Plugin %s not found", name);
+    g_hash_table_insert (self->missing_plugins, g_strdup (name),
+                         GUINT_TO_POINTER (plugin_dirs_generation));
     return NULL;
+  }
 
   g_debug ("Loading plugin %s", name);
+  start = g_get_monotonic_time ();
   type = g_io_extension_get_type (extension);
-  return g_object_new (type, NULL);
+  widget = g_object_new (type, NULL);
+
+  load_time = g_new (gint64, 1);
+  *load_time = g_get_monotonic_time () - start;
+  g_hash_table_insert (self->load_times, g_strdup (name), load_time);
+  g_debug ("Loaded plugin %s in %.1fms", name, *load_time / 1000.0);
+
+  return widget;
+}
+
+/**
+ * phosh_plugin_loader_get_load_time:
+ * @self: The plugin loader
+ * @name: The name of the plugin
+ *
+ * Gets the time it took to instantiate the given plugin the last time
+ * it was loaded.
+ *
+ * Returns: The load time in microseconds or `-1` if the plugin wasn't
+ *   loaded yet.
+ */
+gint64
+phosh_plugin_loader_get_load_time (PhoshPluginLoader *self, const char *name)
+{
+  gint64 *load_time;
+
+  g_return_val_if_fail (PHOSH_IS_PLUGIN_LOADER (self), -1);
+  g_return_val_if_fail (name, -1);
+
+  load_time = g_hash_table_lookup (self->load_times, name);
+
+  return load_time ? *load_time : -1;
 }
 
 
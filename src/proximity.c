@@ -190,19 +190,15 @@ on_calls_manager_active_call_changed (PhoshProximity    *self,
 
 static void
 on_proximity_near_changed (PhoshProximity          *self,
-                           GParamSpec              *pspec,
+                           gboolean                 near,
                            PhoshSensorProxyManager *sensor)
 {
-  gboolean near;
   PhoshShell *shell = phosh_shell_get_default ();
   PhoshMonitor *monitor = phosh_shell_get_builtin_monitor (shell);
 
   if (!self->claimed)
     return;
 
-  near = phosh_dbus_sensor_proxy_get_proximity_near (
-    PHOSH_DBUS_SENSOR_PROXY (self->sensor_proxy_manager));
-
   g_debug ("Proximity near changed: %d", near);
   if (near && monitor)
     show_fader (self, monitor);
@@ -270,7 +266,7 @@ phosh_proximity_constructed (GObject *object)
                             self);
 
   g_signal_connect_swapped (self->sensor_proxy_manager,
-                            "notify::proximity-near",
+                            "proximity-changed",
                             (GCallback) on_proximity_near_changed,
                             self);
 
@@ -18,6 +18,7 @@
 #include "quick-setting.h"
 #include "quick-settings-box.h"
 #include "shell-priv.h"
+#include "top-panel.h"
 #include "wifi-status-page.h"
 
 #define CUSTOM_QUICK_SETTINGS_SCHEMA "sm.puri.phosh.plugins"
@@ -43,6 +44,12 @@ struct _PhoshQuickSettings {
   GSettings *plugin_settings;
   PhoshPluginLoader *plugin_loader;
   GPtrArray *custom_quick_settings;
+  guint      load_id;
+
+  /* The top panel we're in, tracked while mapped */
+  PhoshTopPanel    *top_panel;
+  /* Wi-Fi manager we hold live updates on while unfolded */
+  PhoshWifiManager *wifi_live;
 };
 
 G_DEFINE_TYPE (PhoshQuickSettings, phosh_quick_settings, GTK_TYPE_BIN);
@@ -229,6 +236,7 @@ load_custom_quick_settings (PhoshQuickSettings *self, GSettings *settings, char
   g_auto (GStrv) plugins = NULL;
   GtkWidget *widget;
 
+  g_clear_handle_id (&self->load_id, g_source_remove);
   g_ptr_array_remove_range (self->custom_quick_settings, 0, self->custom_quick_settings->len);
   plugins = g_settings_get_strv (self->plugin_settings, CUSTOM_QUICK_SETTINGS_KEY);
 
@@ -249,11 +257,99 @@ load_custom_quick_settings (PhoshQuickSettings *self, GSettings *settings, char
 }
 
 
+static gboolean
+on_load_custom_quick_settings_idle (gpointer data)
+{
+  PhoshQuickSettings *self = PHOSH_QUICK_SETTINGS (data);
+
+  self->load_id = 0;
+  load_custom_quick_settings (self, NULL, NULL);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+release_wifi_live_updates (PhoshQuickSettings *self)
+{
+  if (self->wifi_live == NULL)
+    return;
+
+  phosh_wifi_manager_release_live_updates (self->wifi_live);
+  g_clear_object (&self->wifi_live);
+}
+
+
+/* We're mapped along with the top panel so go by its fold state
+ * to find out whether the user can see us */
+static void
+update_visibility (PhoshQuickSettings *self)
+{
+  PhoshWifiManager *manager = phosh_shell_get_wifi_manager (phosh_shell_get_default ());
+  gboolean visible;
+
+  visible = gtk_widget_get_mapped (GTK_WIDGET (self)) &&
+    (self->top_panel == NULL ||
+     phosh_top_panel_get_state (self->top_panel) == PHOSH_TOP_PANEL_STATE_UNFOLDED);
+
+  /* Shown before we got to load the plugins in idle time */
+  if (visible && self->load_id)
+    load_custom_quick_settings (self, NULL, NULL);
+
+  /* Show Wi-Fi strength changes right away */
+  if (!visible || manager == NULL) {
+    release_wifi_live_updates (self);
+    return;
+  }
+
+  if (self->wifi_live)
+    return;
+
+  self->wifi_live = g_object_ref (manager);
+  phosh_wifi_manager_hold_live_updates (self->wifi_live);
+}
+
+
+static void
+phosh_quick_settings_map (GtkWidget *widget)
+{
+  PhoshQuickSettings *self = PHOSH_QUICK_SETTINGS (widget);
+  GtkWidget *top_panel;
+
+  GTK_WIDGET_CLASS (phosh_quick_settings_parent_class)->map (widget);
+
+  top_panel = gtk_widget_get_ancestor (widget, PHOSH_TYPE_TOP_PANEL);
+  if (top_panel) {
+    self->top_panel = PHOSH_TOP_PANEL (top_panel);
+    g_signal_connect_object (self->top_panel, "notify::state",
+                             G_CALLBACK (update_visibility), self,
+                             G_CONNECT_SWAPPED);
+  }
+  update_visibility (self);
+}
+
+
+static void
+phosh_quick_settings_unmap (GtkWidget *widget)
+{
+  PhoshQuickSettings *self = PHOSH_QUICK_SETTINGS (widget);
+
+  if (self->top_panel) {
+    g_signal_handlers_disconnect_by_data (self->top_panel, self);
+    self->top_panel = NULL;
+  }
+  release_wifi_live_updates (self);
+
+  GTK_WIDGET_CLASS (phosh_quick_settings_parent_class)->unmap (widget);
+}
+
+
 static void
 phosh_quick_settings_dispose (GObject *object)
 {
   PhoshQuickSettings *self = PHOSH_QUICK_SETTINGS (object);
 
+  g_clear_handle_id (&self->load_id, g_source_remove);
   g_clear_object (&self->plugin_settings);
   g_clear_object (&self->plugin_loader);
   if (self->custom_quick_settings) {
@@ -273,6 +369,9 @@ phosh_quick_settings_class_init (PhoshQuickSettingsClass *klass)
 
   object_class->dispose = phosh_quick_settings_dispose;
 
+  widget_class->map = phosh_quick_settings_map;
+  widget_class->unmap = phosh_quick_settings_unmap;
+
   g_type_ensure (PHOSH_TYPE_QUICK_SETTINGS_BOX);
   g_type_ensure (PHOSH_TYPE_QUICK_SETTING);
 
@@ -317,7 +416,9 @@ phosh_quick_settings_init (PhoshQuickSettings *self)
   g_signal_connect_object (self->plugin_settings, "changed::" CUSTOM_QUICK_SETTINGS_KEY,
                            G_CALLBACK (load_custom_quick_settings), self, G_CONNECT_SWAPPED);
 
-  load_custom_quick_settings (self, NULL, NULL);
+  /* Plugins aren't needed until the quick settings are shown */
+  self->load_id = g_idle_add_full (G_PRIORITY_LOW, on_load_custom_quick_settings_idle, self, NULL);
+  g_source_set_name_by_id (self->load_id, "[phosh] load custom quick settings");
 }
 
 
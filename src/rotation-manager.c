@@ -62,6 +62,20 @@ typedef struct _PhoshRotationManager {
 G_DEFINE_TYPE (PhoshRotationManager, phosh_rotation_manager, G_TYPE_OBJECT);
 
 
+static void
+on_apply_monitor_config_done (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  g_autoptr (GError) err = NULL;
+
+  if (!phosh_monitor_manager_apply_monitor_config_finish (PHOSH_MONITOR_MANAGER (source_object),
+                                                          res,
+                                                          &err)) {
+    /* The monitor manager already warned */
+    g_debug ("Failed to rotate monitor: %s", err->message);
+  }
+}
+
+
 static void
 apply_transform (PhoshRotationManager *self, PhoshMonitorTransform transform)
 {
@@ -81,7 +95,10 @@ apply_transform (PhoshRotationManager *self, PhoshMonitorTransform transform)
   phosh_monitor_manager_set_monitor_transform (monitor_manager,
                                                self->monitor,
                                                transform);
-  phosh_monitor_manager_apply_monitor_config (monitor_manager);
+  phosh_monitor_manager_apply_monitor_config_async (monitor_manager,
+                                                    NULL,
+                                                    on_apply_monitor_config_done,
+                                                    NULL);
 }
 
 /**
@@ -364,7 +381,7 @@ on_lockscreen_manager_locked (PhoshRotationManager *self, GParamSpec *pspec,
 
 static void
 on_accelerometer_orientation_changed (PhoshRotationManager    *self,
-                                      GParamSpec              *pspec,
+                                      const char              *orientation,
                                       PhoshSensorProxyManager *sensor)
 {
   g_return_if_fail (PHOSH_IS_ROTATION_MANAGER (self));
@@ -491,7 +508,7 @@ phosh_rotation_manager_constructed (GObject *object)
   }
 
   g_signal_connect_swapped (self->sensor_proxy_manager,
-                            "notify::accelerometer-orientation",
+                            "orientation-changed",
                             (GCallback) on_accelerometer_orientation_changed,
                             self);
 
@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "screenshot-manager.h"
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <gdk/gdk.h>
+
+G_BEGIN_DECLS
+
+/**
+ * PhoshScreenshotFrame:
+ * @pixbuf: The monitor's contents as captured
+ * @logical: The monitor's area in layout coordinates relative to the
+ *   screenshot's origin
+ * @scale: The monitor's scale
+ * @rotation: The rotation that undoes the monitor's transform
+ *
+ * A captured monitor frame that goes into a screenshot.
+ */
+typedef struct {
+  GdkPixbuf         *pixbuf;
+  GdkRectangle       logical;
+  float              scale;
+  GdkPixbufRotation  rotation;
+} PhoshScreenshotFrame;
+
+GdkPixbuf *phosh_screenshot_manager_composite (const PhoshScreenshotFrame *frames,
+                                               guint                       n_frames,
+                                               int                         width,
+                                               int                         height,
+                                               float                       screenshot_scale);
+
+G_END_DECLS
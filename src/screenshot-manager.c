@@ -11,9 +11,10 @@
 
 #include "phosh-config.h"
 #include "fader.h"
+#include "memory-registry.h"
 #include "phosh-wayland.h"
 #include "notifications/notify-manager.h"
-#include "screenshot-manager.h"
+#include "screenshot-manager-priv.h"
 #include "shell-priv.h"
 #include "util.h"
 #include "wl-buffer.h"
@@ -522,6 +523,58 @@ get_angle (PhoshMonitorTransform transform)
   }
 }
 
+/**
+ * phosh_screenshot_manager_composite:
+ * @frames:(array length=n_frames): The captured monitor frames
+ * @n_frames: The number of frames
+ * @width: The width of the output layout in logical pixels
+ * @height: The height of the output layout in logical pixels
+ * @screenshot_scale: The scale of the resulting screenshot
+ *
+ * Composes the monitor frames into a single screenshot. Frames of
+ * monitors with a lower scale than @screenshot_scale get enlarged.
+ *
+ * Returns:(transfer full): The screenshot
+ */
+GdkPixbuf *
+phosh_screenshot_manager_composite (const PhoshScreenshotFrame *frames,
+                                    guint                       n_frames,
+                                    int                         width,
+                                    int                         height,
+                                    float                       screenshot_scale)
+{
+  GdkPixbuf *pixbuf;
+
+  pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB,
+                           TRUE,
+                           8,
+                           width * screenshot_scale,
+                           height * screenshot_scale);
+
+  /* TODO: Using cairo would avoid lots of copies */
+  for (guint i = 0; i < n_frames; i++) {
+    const PhoshScreenshotFrame *frame = &frames[i];
+    /* how much this monitor gets enlarged based on its scale, >= 1.0 */
+    double zoom = screenshot_scale / frame->scale;
+    g_autoptr (GdkPixbuf) transformed = NULL;
+
+    transformed = gdk_pixbuf_rotate_simple (frame->pixbuf, frame->rotation);
+    gdk_pixbuf_composite (transformed,
+                          pixbuf,
+                          frame->logical.x * screenshot_scale,
+                          frame->logical.y * screenshot_scale,
+                          frame->logical.width * screenshot_scale,
+                          frame->logical.height * screenshot_scale,
+                          frame->logical.x * screenshot_scale,
+                          frame->logical.y * screenshot_scale,
+                          zoom, zoom,
+                          GDK_INTERP_BILINEAR,
+                          255);
+  }
+
+  return pixbuf;
+}
+
 /**
  * create_internal_file:
  * @self: The screenshot manager
@@ -594,55 +647,46 @@ submit_screenshot (PhoshScreenshotManager *self)
   g_autoptr (GFileOutputStream) stream = NULL;
   g_autoptr (GFile) file = NULL;
   g_autoptr (GdkPixbuf) pixbuf = NULL;
+  g_autoptr (GArray) composite = NULL;
   GdkRectangle box;
   float screenshot_scale = self->frames->max_scale;
 
   box = get_output_layout (self);
   g_debug ("Screenshot of %d,%d %dx%d", box.x, box.y, box.width, box.height);
 
-  pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB,
-                           TRUE,
-                           8,
-                           box.width * screenshot_scale,
-                           box.height * screenshot_scale);
-
-  /* TODO: Using cairo would avoid lots of copies */
+  composite = g_array_new (FALSE, FALSE, sizeof (PhoshScreenshotFrame));
   for (GList *l = self->frames->frames; l; l = l->next) {
     ScreencopyFrame *frame = l->data;
-    float scale;
-    /* how much this monitor gets enlarged based on its scale, >= 1.0 */
-    double zoom;
-    g_autoptr (GdkPixbuf) transformed = NULL;
+    PhoshScreenshotFrame composite_frame;
 
     if (frame->monitor == NULL)
       continue;
 
-    scale = phosh_monitor_get_fractional_scale (frame->monitor);
-    zoom = screenshot_scale / scale;
+    composite_frame.pixbuf = frame->pixbuf;
+    composite_frame.logical.x = frame->monitor->logical.x - box.x;
+    composite_frame.logical.y = frame->monitor->logical.y - box.y;
+    composite_frame.logical.width = frame->monitor->logical.width;
+    composite_frame.logical.height = frame->monitor->logical.height;
+    composite_frame.scale = phosh_monitor_get_fractional_scale (frame->monitor);
+    /* TODO: handle flips */
+    composite_frame.rotation = get_angle (frame->monitor->transform);
+
     g_debug ("Screenshot of '%s' of %d,%d %dx%d, scale: %f",
              frame->monitor->name,
-             frame->monitor->logical.x - box.x,
-             frame->monitor->logical.y - box.y,
-             frame->monitor->logical.width,
-             frame->monitor->logical.height,
-             scale);
-
-    /* TODO: handle flips */
-    transformed = gdk_pixbuf_rotate_simple (frame->pixbuf,
-                                            get_angle (frame->monitor->transform));
-    gdk_pixbuf_composite (transformed,
-                          pixbuf,
-                          (frame->monitor->logical.x - box.x) * screenshot_scale,
-                          (frame->monitor->logical.y - box.y) * screenshot_scale,
-                          frame->monitor->logical.width * screenshot_scale,
-                          frame->monitor->logical.height * screenshot_scale,
-                          (frame->monitor->logical.x - box.x) * screenshot_scale,
-                          (frame->monitor->logical.y - box.y) * screenshot_scale,
-                          zoom, zoom,
-                          GDK_INTERP_BILINEAR,
-                          255);
+             composite_frame.logical.x,
+             composite_frame.logical.y,
+             composite_frame.logical.width,
+             composite_frame.logical.height,
+             composite_frame.scale);
+    g_array_append_val (composite, composite_frame);
   }
 
+  pixbuf = phosh_screenshot_manager_composite ((PhoshScreenshotFrame *) composite->data,
+                                               composite->len,
+                                               box.width,
+                                               box.height,
+                                               screenshot_scale);
+
   if (self->frames->area) {
     g_autoptr (GdkPixbuf) tmp = pixbuf;
 
@@ -1297,11 +1341,35 @@ phosh_screenshot_manager_constructed (GObject *object)
 }
 
 
+static void
+get_memory_usage (gpointer owner, gsize *bytes, guint *n_entries)
+{
+  PhoshScreenshotManager *self = PHOSH_SCREENSHOT_MANAGER (owner);
+
+  /* Only held while a screenshot is in progress */
+  for (GList *l = self->frames ? self->frames->frames : NULL; l; l = l->next) {
+    ScreencopyFrame *frame = l->data;
+
+    if (frame->pixbuf) {
+      *bytes += gdk_pixbuf_get_byte_length (frame->pixbuf);
+      (*n_entries)++;
+    }
+  }
+
+  if (self->for_clipboard) {
+    *bytes += gdk_pixbuf_get_byte_length (self->for_clipboard);
+    (*n_entries)++;
+  }
+}
+
+
 static void
 phosh_screenshot_manager_dispose (GObject *object)
 {
   PhoshScreenshotManager *self = PHOSH_SCREENSHOT_MANAGER (object);
 
+  phosh_memory_registry_remove (phosh_memory_registry_get_default (), self);
+
   g_cancellable_cancel (self->cancel);
   g_clear_object (&self->cancel);
 
@@ -1345,6 +1413,13 @@ phosh_screenshot_manager_init (PhoshScreenshotManager *self)
                             G_CALLBACK (on_keybindings_changed),
                             self);
   add_keybindings (self);
+
+  phosh_memory_registry_add (phosh_memory_registry_get_default (),
+                             "screenshot-frames",
+                             PHOSH_MEMORY_PRIORITY_ACTIVE,
+                             self,
+                             get_memory_usage,
+                             NULL);
 }
 
 PhoshScreenshotManager *
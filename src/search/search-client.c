@@ -8,6 +8,7 @@
  */
 
 #include "search-client.h"
+#include "search-result-batch.h"
 #include "search-result-meta.h"
 #include "search-source.h"
 #include "phosh-searchd.h"
@@ -20,6 +21,11 @@
  * The #PhoshSearchClient class provides an interface to interact with the
  * Phosh search service over D-Bus. It allows client to query for results
  * from different search sources.
+ *
+ * If the search service supports it results are received as compact
+ * binary batches (see #PhoshSearchResultBatch) which are decoded in a
+ * worker thread so the main thread doesn't spend time on parsing
+ * results (and their icons) while the user types.
  */
 
 enum State {
@@ -36,6 +42,48 @@ enum {
 static guint signals[N_SIGNALS] = { 0 };
 
 
+/* Per source state when receiving results as batches */
+typedef struct {
+  char      *source_id;
+  guint      serial;
+  /* element-type: Phosh.SearchResultMeta */
+  GPtrArray *results;
+  /* element-type: GBytes */
+  GQueue     pending;
+  gboolean   decoding;
+  gboolean   resyncing;
+} BatchSource;
+
+
+static void
+batch_source_free (BatchSource *source)
+{
+  g_queue_clear_full (&source->pending, (GDestroyNotify) g_bytes_unref);
+  g_clear_pointer (&source->results, g_ptr_array_unref);
+  g_free (source->source_id);
+  g_free (source);
+}
+
+
+typedef struct {
+  char      *source_id;
+  GBytes    *batch;
+  GPtrArray *base;
+  guint      base_serial;
+  guint      serial;
+} DecodeData;
+
+
+static void
+decode_data_free (DecodeData *data)
+{
+  g_free (data->source_id);
+  g_bytes_unref (data->batch);
+  g_clear_pointer (&data->base, g_ptr_array_unref);
+  g_free (data);
+}
+
+
 typedef struct _PhoshSearchClientPrivate PhoshSearchClientPrivate;
 struct _PhoshSearchClientPrivate {
   PhoshDBusSearch *server;
@@ -46,6 +94,10 @@ struct _PhoshSearchClientPrivate {
   GRegex          *splitter;
 
   GCancellable    *cancellable;
+
+  /* key: char * (source id), value: BatchSource * */
+  GHashTable      *batch_sources;
+  gboolean         batched;
 };
 
 static void async_iface_init (GAsyncInitableIface *iface);
@@ -68,6 +120,7 @@ phosh_search_client_finalize (GObject *object)
 
   g_clear_pointer (&priv->highlight, g_regex_unref);
   g_clear_pointer (&priv->splitter, g_regex_unref);
+  g_clear_pointer (&priv->batch_sources, g_hash_table_destroy);
 
   G_OBJECT_CLASS (phosh_search_client_parent_class)->finalize (object);
 }
@@ -106,10 +159,15 @@ on_source_results_changed (PhoshDBusSearch   *server,
                            GVariant          *variant,
                            PhoshSearchClient *self)
 {
+  PhoshSearchClientPrivate *priv = phosh_search_client_get_instance_private (self);
   GVariantIter iter;
   GVariant *item;
   GPtrArray *results = NULL;
 
+  /* Sent for clients still using dictionaries */
+  if (priv->batched)
+    return;
+
   results = g_ptr_array_new_with_free_func ((GDestroyNotify) phosh_search_result_meta_unref);
 
   g_variant_iter_init (&iter, variant);
@@ -131,6 +189,221 @@ on_source_results_changed (PhoshDBusSearch   *server,
 }
 
 
+static void decode_next_batch (PhoshSearchClient *self, BatchSource *source);
+
+
+static void
+decode_batch_thread (GTask        *task,
+                     gpointer      source_object,
+                     gpointer      task_data,
+                     GCancellable *cancellable)
+{
+  DecodeData *data = task_data;
+  GError *error = NULL;
+  GPtrArray *results;
+
+  results = phosh_search_result_batch_decode (data->batch,
+                                              data->base,
+                                              data->base_serial,
+                                              &data->serial,
+                                              &error);
+  if (!results) {
+    g_task_return_error (task, error);
+    return;
+  }
+
+  g_task_return_pointer (task, results, (GDestroyNotify) g_ptr_array_unref);
+}
+
+
+struct ResyncData {
+  PhoshSearchClient *self;
+  char              *source_id;
+};
+
+
+static void
+on_get_source_results_batch_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  g_autofree struct ResyncData *data = user_data;
+  g_autofree char *source_id = data->source_id;
+  g_autoptr (GVariant) batch = NULL;
+  g_autoptr (GError) err = NULL;
+  PhoshSearchClientPrivate *priv;
+  BatchSource *source;
+
+  if (!phosh_dbus_search_call_get_source_results_batch_finish (PHOSH_DBUS_SEARCH (source_object),
+                                                               &batch,
+                                                               res,
+                                                               &err)) {
+    if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      return;
+
+    g_warning ("Failed to resync results of %s: %s", source_id, err->message);
+    /* Next full batch will fix things up */
+    priv = phosh_search_client_get_instance_private (data->self);
+    source = g_hash_table_lookup (priv->batch_sources, source_id);
+    source->resyncing = FALSE;
+    return;
+  }
+
+  priv = phosh_search_client_get_instance_private (data->self);
+  source = g_hash_table_lookup (priv->batch_sources, source_id);
+  source->resyncing = FALSE;
+
+  g_queue_push_head (&source->pending, g_variant_get_data_as_bytes (batch));
+  decode_next_batch (data->self, source);
+}
+
+
+static void
+resync_batch_source (PhoshSearchClient *self, BatchSource *source)
+{
+  PhoshSearchClientPrivate *priv = phosh_search_client_get_instance_private (self);
+  struct ResyncData *data;
+
+  if (source->resyncing)
+    return;
+
+  g_debug ("Resyncing results of %s", source->source_id);
+  source->resyncing = TRUE;
+  /* Pending diffs are against results we don't have */
+  g_queue_clear_full (&source->pending, (GDestroyNotify) g_bytes_unref);
+
+  data = g_new0 (struct ResyncData, 1);
+  data->self = self;
+  data->source_id = g_strdup (source->source_id);
+
+  phosh_dbus_search_call_get_source_results_batch (priv->server,
+                                                   source->source_id,
+                                                   priv->cancellable,
+                                                   on_get_source_results_batch_ready,
+                                                   data);
+}
+
+
+static void
+on_decode_batch_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  PhoshSearchClient *self = PHOSH_SEARCH_CLIENT (source_object);
+  PhoshSearchClientPrivate *priv = phosh_search_client_get_instance_private (self);
+  DecodeData *data = g_task_get_task_data (G_TASK (res));
+  g_autoptr (GPtrArray) results = NULL;
+  g_autoptr (GError) err = NULL;
+  BatchSource *source;
+
+  results = g_task_propagate_pointer (G_TASK (res), &err);
+
+  source = g_hash_table_lookup (priv->batch_sources, data->source_id);
+  source->decoding = FALSE;
+
+  if (!results) {
+    if (g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      return;
+
+    if (g_error_matches (err, PHOSH_SEARCH_RESULT_BATCH_ERROR, PHOSH_SEARCH_RESULT_BATCH_ERROR_STALE)) {
+      resync_batch_source (self, source);
+      return;
+    }
+
+    g_warning ("Failed to decode results of %s: %s", data->source_id, err->message);
+  } else {
+    g_clear_pointer (&source->results, g_ptr_array_unref);
+    source->results = g_steal_pointer (&results);
+    source->serial = data->serial;
+
+    g_signal_emit (self,
+                   signals[SOURCE_RESULTS_CHANGED],
+                   g_quark_from_string (source->source_id),
+                   source->source_id,
+                   source->results);
+  }
+
+  decode_next_batch (self, source);
+}
+
+
+static void
+decode_next_batch (PhoshSearchClient *self, BatchSource *source)
+{
+  PhoshSearchClientPrivate *priv = phosh_search_client_get_instance_private (self);
+  g_autoptr (GTask) task = NULL;
+  DecodeData *data;
+
+  if (source->decoding || source->resyncing || g_queue_is_empty (&source->pending))
+    return;
+
+  data = g_new0 (DecodeData, 1);
+  data->source_id = g_strdup (source->source_id);
+  data->batch = g_queue_pop_head (&source->pending);
+  /* Metas are immutable, the worker can share them */
+  data->base = source->results ? g_ptr_array_ref (source->results) : NULL;
+  data->base_serial = source->serial;
+
+  source->decoding = TRUE;
+  task = g_task_new (self, priv->cancellable, on_decode_batch_ready, NULL);
+  g_task_set_source_tag (task, decode_next_batch);
+  g_task_set_task_data (task, data, (GDestroyNotify) decode_data_free);
+  g_task_run_in_thread (task, decode_batch_thread);
+}
+
+
+static void
+on_source_results_batch (PhoshDBusSearch   *server,
+                         const char        *source_id,
+                         GVariant          *variant,
+                         PhoshSearchClient *self)
+{
+  PhoshSearchClientPrivate *priv = phosh_search_client_get_instance_private (self);
+  g_autoptr (GBytes) batch = NULL;
+  BatchSource *source;
+  guint serial, base_serial;
+
+  batch = g_variant_get_data_as_bytes (variant);
+  if (!phosh_search_result_batch_get_serials (batch, &serial, &base_serial)) {
+    g_warning ("Received malformed result batch for %s", source_id);
+    return;
+  }
+
+  source = g_hash_table_lookup (priv->batch_sources, source_id);
+  if (source == NULL) {
+    source = g_new0 (BatchSource, 1);
+    source->source_id = g_strdup (source_id);
+    g_queue_init (&source->pending);
+    g_hash_table_insert (priv->batch_sources, g_strdup (source_id), source);
+  }
+
+  /* A diff already covered by a full batch we fetched */
+  if (base_serial != 0 && serial <= source->serial)
+    return;
+
+  g_queue_push_tail (&source->pending, g_steal_pointer (&batch));
+  decode_next_batch (self, source);
+}
+
+
+static void
+on_set_results_format_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  PhoshSearchClient *self;
+  PhoshSearchClientPrivate *priv;
+  g_autoptr (GError) err = NULL;
+
+  if (!phosh_dbus_search_call_set_results_format_finish (PHOSH_DBUS_SEARCH (source_object),
+                                                         res,
+                                                         &err)) {
+    /* Older search services only support dictionaries */
+    if (!g_error_matches (err, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_debug ("Can't switch to batched results: %s", err->message);
+    return;
+  }
+
+  self = PHOSH_SEARCH_CLIENT (user_data);
+  priv = phosh_search_client_get_instance_private (self);
+  priv->batched = TRUE;
+}
+
+
 static void
 on_query_finished (PhoshDBusSearch *server, gpointer user_data)
 {
@@ -162,8 +435,15 @@ got_search (GObject *source, GAsyncResult *result, gpointer user_data)
   }
 
   g_signal_connect (priv->server, "source-results-changed", G_CALLBACK (on_source_results_changed), data->self);
+  g_signal_connect (priv->server, "source-results-batch", G_CALLBACK (on_source_results_batch), data->self);
   g_signal_connect (priv->server, "query-finished", G_CALLBACK (on_query_finished), data->self);
 
+  phosh_dbus_search_call_set_results_format (priv->server,
+                                             PHOSH_SEARCH_RESULTS_FORMAT_BATCH,
+                                             priv->cancellable,
+                                             on_set_results_format_ready,
+                                             data->self);
+
   g_task_return_boolean (data->task, TRUE);
 }
 
@@ -240,6 +520,10 @@ phosh_search_client_init (PhoshSearchClient *self)
                                 &error);
   priv->state = CREATED;
   priv->cancellable = g_cancellable_new ();
+  priv->batch_sources = g_hash_table_new_full (g_str_hash,
+                                               g_str_equal,
+                                               g_free,
+                                               (GDestroyNotify) batch_source_free);
 
   if (error)
     g_error ("Bad Regex: %s", error->message);
@@ -0,0 +1,490 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-search-result-batch"
+
+#include "search-result-batch.h"
+#include "search-result-meta.h"
+
+#include <string.h>
+
+/**
+ * PhoshSearchResultBatch:
+ *
+ * A compact binary representation of a source's search results
+ *
+ * A batch is a flat buffer made of a fixed size header, an array of
+ * fixed size records and a table of NUL terminated strings. Strings
+ * are interned so e.g. an icon shared by all results of a source is
+ * only transmitted (and parsed) once.
+ *
+ * When encoded against a base (the previously sent results) the batch
+ * is a diff: only rows that changed are transmitted. Rows that are
+ * identical to a row of the base at another position are sent as a
+ * reference to that position. Rows without a record are unchanged.
+ *
+ * The format is only meant to be exchanged between processes on the
+ * same host so host byte order is used.
+ */
+
+#define BATCH_MAGIC      0x42525350 /* "PSRB" */
+#define BATCH_VERSION    1
+#define BATCH_FLAG_DIFF  (1 << 0)
+
+#define NO_STRING        G_MAXUINT32
+#define NO_POSITION      G_MAXUINT32
+
+typedef enum {
+  ICON_FORMAT_NONE    = 0,
+  ICON_FORMAT_STRING  = 1, /* g_icon_to_string () */
+  ICON_FORMAT_VARIANT = 2, /* g_icon_serialize () in GVariant text format */
+} IconFormat;
+
+typedef struct {
+  guint32 magic;
+  guint16 version;
+  guint16 flags;
+  guint32 base_serial;
+  guint32 serial;
+  guint32 n_rows;
+  guint32 n_records;
+  guint32 strings_len;
+  guint32 reserved;
+} BatchHeader;
+G_STATIC_ASSERT (sizeof (BatchHeader) == 32);
+
+typedef struct {
+  guint32 position;
+  guint32 old_position;
+  guint32 id;
+  guint32 title;
+  guint32 desc;
+  guint32 clipboard_text;
+  guint32 icon;
+  guint32 icon_format;
+} BatchRecord;
+G_STATIC_ASSERT (sizeof (BatchRecord) == 32);
+
+
+G_DEFINE_QUARK (phosh-search-result-batch-error-quark, phosh_search_result_batch_error)
+
+
+static gboolean
+meta_equal (PhoshSearchResultMeta *a, PhoshSearchResultMeta *b)
+{
+  GIcon *icon_a, *icon_b;
+
+  if (a == b)
+    return TRUE;
+
+  if (g_strcmp0 (phosh_search_result_meta_get_id (a), phosh_search_result_meta_get_id (b)) ||
+      g_strcmp0 (phosh_search_result_meta_get_title (a), phosh_search_result_meta_get_title (b)) ||
+      g_strcmp0 (phosh_search_result_meta_get_description (a),
+                 phosh_search_result_meta_get_description (b)) ||
+      g_strcmp0 (phosh_search_result_meta_get_clipboard_text (a),
+                 phosh_search_result_meta_get_clipboard_text (b))) {
+    return FALSE;
+  }
+
+  icon_a = phosh_search_result_meta_get_icon (a);
+  icon_b = phosh_search_result_meta_get_icon (b);
+  if (icon_a == NULL || icon_b == NULL)
+    return icon_a == icon_b;
+
+  return g_icon_equal (icon_a, icon_b);
+}
+
+
+static guint32
+intern_string (GHashTable *offsets, GString *strings, const char *str)
+{
+  gpointer offset;
+  guint32 pos;
+
+  if (str == NULL)
+    return NO_STRING;
+
+  if (g_hash_table_lookup_extended (offsets, str, NULL, &offset))
+    return GPOINTER_TO_UINT (offset);
+
+  pos = strings->len;
+  /* Include the terminating NUL */
+  g_string_append_len (strings, str, strlen (str) + 1);
+  g_hash_table_insert (offsets, g_strdup (str), GUINT_TO_POINTER (pos));
+
+  return pos;
+}
+
+
+static char *
+icon_to_string (GIcon *icon, IconFormat *format)
+{
+  g_autoptr (GVariant) serialised = NULL;
+  char *str;
+
+  *format = ICON_FORMAT_NONE;
+  if (icon == NULL)
+    return NULL;
+
+  str = g_icon_to_string (icon);
+  if (str) {
+    *format = ICON_FORMAT_STRING;
+    return str;
+  }
+
+  serialised = g_icon_serialize (icon);
+  if (serialised) {
+    *format = ICON_FORMAT_VARIANT;
+    return g_variant_print (serialised, TRUE);
+  }
+
+  g_warning ("Can't serialise icon of type %s", G_OBJECT_TYPE_NAME (icon));
+  return NULL;
+}
+
+
+static GIcon *
+icon_from_string (const char *str, IconFormat format)
+{
+  g_autoptr (GVariant) serialised = NULL;
+  g_autoptr (GError) err = NULL;
+  GIcon *icon = NULL;
+
+  switch (format) {
+  case ICON_FORMAT_STRING:
+    icon = g_icon_new_for_string (str, &err);
+    break;
+  case ICON_FORMAT_VARIANT:
+    serialised = g_variant_parse (NULL, str, NULL, NULL, &err);
+    if (serialised)
+      icon = g_icon_deserialize (serialised);
+    break;
+  case ICON_FORMAT_NONE:
+  default:
+    break;
+  }
+
+  if (err)
+    g_debug ("Failed to parse icon '%s': %s", str, err->message);
+
+  return icon;
+}
+
+
+static void
+fill_record (BatchRecord           *record,
+             GHashTable            *offsets,
+             GString               *strings,
+             PhoshSearchResultMeta *meta)
+{
+  g_autofree char *icon = NULL;
+  IconFormat icon_format;
+
+  icon = icon_to_string (phosh_search_result_meta_get_icon (meta), &icon_format);
+
+  record->old_position = NO_POSITION;
+  record->id = intern_string (offsets, strings, phosh_search_result_meta_get_id (meta));
+  record->title = intern_string (offsets, strings, phosh_search_result_meta_get_title (meta));
+  record->desc = intern_string (offsets, strings, phosh_search_result_meta_get_description (meta));
+  record->clipboard_text = intern_string (offsets, strings,
+                                          phosh_search_result_meta_get_clipboard_text (meta));
+  record->icon = intern_string (offsets, strings, icon);
+  record->icon_format = icon_format;
+}
+
+/**
+ * phosh_search_result_batch_encode:
+ * @base: (nullable) (element-type PhoshSearchResultMeta): The results the receiver already has
+ * @base_serial: The serial of @base
+ * @results: (element-type PhoshSearchResultMeta): The results to encode
+ * @serial: The serial of the new batch
+ *
+ * Encodes @results into a batch. If @base is given the batch is a
+ * diff against it and only carries the rows that changed.
+ *
+ * Returns: (transfer full): The encoded batch
+ */
+GBytes *
+phosh_search_result_batch_encode (GPtrArray *base,
+                                  guint      base_serial,
+                                  GPtrArray *results,
+                                  guint      serial)
+{
+  g_autoptr (GHashTable) offsets = NULL;
+  g_autoptr (GArray) records = NULL;
+  g_autoptr (GString) strings = NULL;
+  BatchHeader header = { 0 };
+  GByteArray *buf;
+
+  g_return_val_if_fail (results, NULL);
+
+  offsets = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  records = g_array_sized_new (FALSE, TRUE, sizeof (BatchRecord), results->len);
+  strings = g_string_new (NULL);
+
+  for (guint i = 0; i < results->len; i++) {
+    PhoshSearchResultMeta *meta = g_ptr_array_index (results, i);
+    BatchRecord record = { .position = i, .old_position = NO_POSITION };
+
+    if (base) {
+      guint old = NO_POSITION;
+
+      /* Results are limited to a handful per source so a linear scan is fine */
+      if (i < base->len && meta_equal (g_ptr_array_index (base, i), meta))
+        continue;
+
+      for (guint j = 0; j < base->len; j++) {
+        if (meta_equal (g_ptr_array_index (base, j), meta)) {
+          old = j;
+          break;
+        }
+      }
+
+      if (old != NO_POSITION) {
+        record.old_position = old;
+        record.id = record.title = record.desc = record.clipboard_text = record.icon = NO_STRING;
+        g_array_append_val (records, record);
+        continue;
+      }
+    }
+
+    fill_record (&record, offsets, strings, meta);
+    g_array_append_val (records, record);
+  }
+
+  header.magic = BATCH_MAGIC;
+  header.version = BATCH_VERSION;
+  header.flags = base ? BATCH_FLAG_DIFF : 0;
+  header.base_serial = base ? base_serial : 0;
+  header.serial = serial;
+  header.n_rows = results->len;
+  header.n_records = records->len;
+  header.strings_len = strings->len;
+
+  buf = g_byte_array_sized_new (sizeof (BatchHeader) +
+                                records->len * sizeof (BatchRecord) +
+                                strings->len);
+  g_byte_array_append (buf, (const guint8 *) &header, sizeof (BatchHeader));
+  g_byte_array_append (buf, (const guint8 *) records->data, records->len * sizeof (BatchRecord));
+  g_byte_array_append (buf, (const guint8 *) strings->str, strings->len);
+
+  return g_byte_array_free_to_bytes (buf);
+}
+
+
+static gboolean
+parse_header (GBytes *batch, BatchHeader *header, GError **error)
+{
+  gsize size, records_size;
+  const guint8 *data;
+
+  data = g_bytes_get_data (batch, &size);
+  if (size < sizeof (BatchHeader))
+    goto invalid;
+
+  /* The buffer might come out of a GVariant and be unaligned */
+  memcpy (header, data, sizeof (BatchHeader));
+  if (header->magic != BATCH_MAGIC || header->version != BATCH_VERSION)
+    goto invalid;
+
+  if (header->n_records > header->n_rows)
+    goto invalid;
+
+  records_size = (gsize) header->n_records * sizeof (BatchRecord);
+  if (size - sizeof (BatchHeader) < records_size)
+    goto invalid;
+
+  if (size - sizeof (BatchHeader) - records_size != header->strings_len)
+    goto invalid;
+
+  if (header->strings_len && data[size - 1] != '\0')
+    goto invalid;
+
+  return TRUE;
+
+ invalid:
+  g_set_error (error,
+               PHOSH_SEARCH_RESULT_BATCH_ERROR,
+               PHOSH_SEARCH_RESULT_BATCH_ERROR_INVALID,
+               "Malformed search result batch");
+  return FALSE;
+}
+
+
+static gboolean
+lookup_string (const char *strings, guint32 strings_len, guint32 offset, const char **str)
+{
+  if (offset == NO_STRING) {
+    *str = NULL;
+    return TRUE;
+  }
+
+  if (offset >= strings_len)
+    return FALSE;
+
+  *str = strings + offset;
+  return TRUE;
+}
+
+
+static PhoshSearchResultMeta *
+meta_from_record (const BatchRecord *record,
+                  const char        *strings,
+                  guint32            strings_len,
+                  GHashTable        *icons)
+{
+  const char *id, *title, *desc, *clipboard_text, *icon_str;
+  GIcon *icon = NULL;
+
+  if (!lookup_string (strings, strings_len, record->id, &id) ||
+      !lookup_string (strings, strings_len, record->title, &title) ||
+      !lookup_string (strings, strings_len, record->desc, &desc) ||
+      !lookup_string (strings, strings_len, record->clipboard_text, &clipboard_text) ||
+      !lookup_string (strings, strings_len, record->icon, &icon_str)) {
+    return NULL;
+  }
+
+  if (icon_str) {
+    /* Interned strings let us parse each distinct icon once per batch */
+    icon = g_hash_table_lookup (icons, GUINT_TO_POINTER (record->icon));
+    if (icon == NULL) {
+      icon = icon_from_string (icon_str, record->icon_format);
+      if (icon)
+        g_hash_table_insert (icons, GUINT_TO_POINTER (record->icon), icon);
+    }
+  }
+
+  return phosh_search_result_meta_new (id, title, desc, icon, clipboard_text);
+}
+
+/**
+ * phosh_search_result_batch_decode:
+ * @batch: The batch to decode
+ * @base: (nullable) (element-type PhoshSearchResultMeta): The current results
+ * @base_serial: The serial of @base
+ * @serial: (out) (optional): The serial of the decoded results
+ * @error: Return location for an error
+ *
+ * Decodes @batch. If @batch is a diff it's applied on top of @base.
+ * Unchanged rows share the #PhoshSearchResultMeta of @base. As
+ * #PhoshSearchResultMeta is immutable this can be run in a thread.
+ *
+ * If @batch is a diff against other results than @base
+ * %PHOSH_SEARCH_RESULT_BATCH_ERROR_STALE is returned and the caller
+ * needs to fetch a full batch.
+ *
+ * Returns: (transfer full) (element-type PhoshSearchResultMeta): The decoded results
+ */
+GPtrArray *
+phosh_search_result_batch_decode (GBytes     *batch,
+                                  GPtrArray  *base,
+                                  guint       base_serial,
+                                  guint      *serial,
+                                  GError    **error)
+{
+  g_autoptr (GPtrArray) results = NULL;
+  g_autoptr (GHashTable) icons = NULL;
+  const guint8 *data;
+  const char *strings;
+  BatchHeader header;
+  gboolean diff;
+  guint k = 0;
+
+  g_return_val_if_fail (batch, NULL);
+
+  if (!parse_header (batch, &header, error))
+    return NULL;
+
+  diff = !!(header.flags & BATCH_FLAG_DIFF);
+  if (diff && (base == NULL || base_serial != header.base_serial)) {
+    g_set_error (error,
+                 PHOSH_SEARCH_RESULT_BATCH_ERROR,
+                 PHOSH_SEARCH_RESULT_BATCH_ERROR_STALE,
+                 "Diff against serial %u but have %u", header.base_serial, base_serial);
+    return NULL;
+  }
+
+  data = g_bytes_get_data (batch, NULL);
+  strings = (const char *) data + sizeof (BatchHeader) + header.n_records * sizeof (BatchRecord);
+  icons = g_hash_table_new_full (NULL, NULL, NULL, g_object_unref);
+  results = g_ptr_array_new_full (header.n_rows, (GDestroyNotify) phosh_search_result_meta_unref);
+
+  for (guint32 pos = 0; pos < header.n_rows; pos++) {
+    PhoshSearchResultMeta *meta = NULL;
+    BatchRecord record = { 0 };
+
+    if (k < header.n_records) {
+      memcpy (&record, data + sizeof (BatchHeader) + k * sizeof (BatchRecord), sizeof (BatchRecord));
+      if (record.position < pos)
+        goto invalid;
+    }
+
+    if (k < header.n_records && record.position == pos) {
+      k++;
+      if (record.old_position != NO_POSITION) {
+        if (!diff || record.old_position >= base->len)
+          goto invalid;
+        meta = phosh_search_result_meta_ref (g_ptr_array_index (base, record.old_position));
+      } else {
+        meta = meta_from_record (&record, strings, header.strings_len, icons);
+        if (meta == NULL)
+          goto invalid;
+      }
+    } else {
+      /* Full batches describe every row */
+      if (!diff || pos >= base->len)
+        goto invalid;
+      meta = phosh_search_result_meta_ref (g_ptr_array_index (base, pos));
+    }
+
+    g_ptr_array_add (results, meta);
+  }
+
+  if (k != header.n_records)
+    goto invalid;
+
+  if (serial)
+    *serial = header.serial;
+
+  return g_steal_pointer (&results);
+
+ invalid:
+  g_set_error (error,
+               PHOSH_SEARCH_RESULT_BATCH_ERROR,
+               PHOSH_SEARCH_RESULT_BATCH_ERROR_INVALID,
+               "Malformed search result batch");
+  return NULL;
+}
+
+/**
+ * phosh_search_result_batch_get_serials:
+ * @batch: The batch
+ * @serial: (out) (optional): The serial of @batch
+ * @base_serial: (out) (optional): The serial @batch is a diff against. `0`
+ *   for full batches.
+ *
+ * Peeks at the serials of @batch without decoding it.
+ *
+ * Returns: %TRUE if @batch has a valid header
+ */
+gboolean
+phosh_search_result_batch_get_serials (GBytes *batch, guint *serial, guint *base_serial)
+{
+  BatchHeader header;
+
+  g_return_val_if_fail (batch, FALSE);
+
+  if (!parse_header (batch, &header, NULL))
+    return FALSE;
+
+  if (serial)
+    *serial = header.serial;
+
+  if (base_serial)
+    *base_serial = (header.flags & BATCH_FLAG_DIFF) ? header.base_serial : 0;
+
+  return TRUE;
+}
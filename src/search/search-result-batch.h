@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <gio/gio.h>
+
+#pragma once
+
+G_BEGIN_DECLS
+
+/**
+ * PhoshSearchResultsFormat:
+ * @PHOSH_SEARCH_RESULTS_FORMAT_DICT: One `a{sv}` per result
+ * @PHOSH_SEARCH_RESULTS_FORMAT_BATCH: Compact binary batches
+ *
+ * The formats a client can select via `SetResultsFormat`.
+ */
+typedef enum {
+  PHOSH_SEARCH_RESULTS_FORMAT_DICT  = 0,
+  PHOSH_SEARCH_RESULTS_FORMAT_BATCH = 1,
+} PhoshSearchResultsFormat;
+
+#define PHOSH_SEARCH_RESULT_BATCH_ERROR (phosh_search_result_batch_error_quark ())
+
+/**
+ * PhoshSearchResultBatchError:
+ * @PHOSH_SEARCH_RESULT_BATCH_ERROR_INVALID: The batch is malformed
+ * @PHOSH_SEARCH_RESULT_BATCH_ERROR_STALE: The batch is a diff against results
+ *   we don't have
+ */
+typedef enum {
+  PHOSH_SEARCH_RESULT_BATCH_ERROR_INVALID,
+  PHOSH_SEARCH_RESULT_BATCH_ERROR_STALE,
+} PhoshSearchResultBatchError;
+
+GQuark     phosh_search_result_batch_error_quark (void);
+GBytes    *phosh_search_result_batch_encode      (GPtrArray  *base,
+                                                  guint       base_serial,
+                                                  GPtrArray  *results,
+                                                  guint       serial);
+GPtrArray *phosh_search_result_batch_decode      (GBytes     *batch,
+                                                  GPtrArray  *base,
+                                                  guint       base_serial,
+                                                  guint      *serial,
+                                                  GError    **error);
+gboolean   phosh_search_result_batch_get_serials (GBytes     *batch,
+                                                  guint      *serial,
+                                                  guint      *base_serial);
+
+G_END_DECLS
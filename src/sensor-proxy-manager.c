@@ -23,15 +23,44 @@
  * The #PhoshSensorProxyManager is responsible for
  * getting events from iio-sensor-proxy.
  *
- * This is just a minimal wrapper so we don't have to provide the
- * object path, names and bus names in several places.
+ * Besides providing the object path, names and bus names so we don't
+ * have to do so in several places it acts as a hub for sensor
+ * readings: Readings are timestamped and counted, bursts of light and
+ * proximity readings are coalesced so subscribers see at most one
+ * event per frame and accelerometer orientation changes are debounced
+ * so e.g. a bumpy ride doesn't make the screen rotate back and forth.
+ * Subscribers should connect to the
+ * #PhoshSensorProxyManager::orientation-changed,
+ * #PhoshSensorProxyManager::light-level-changed and
+ * #PhoshSensorProxyManager::proximity-changed signals rather than to
+ * the property notifications.
  */
 
+/* How long an orientation needs to be stable before we report it */
+#define ORIENTATION_DEBOUNCE_MS 250
+
+enum {
+  ORIENTATION_CHANGED,
+  LIGHT_LEVEL_CHANGED,
+  PROXIMITY_CHANGED,
+  N_SIGNALS
+};
+static guint signals[N_SIGNALS];
+
+typedef struct {
+  gint64   timestamp;
+  guint64  n_readings;
+  guint64  n_events;
+  gboolean pending;
+} PhoshSensorState;
 
 typedef struct _PhoshSensorProxyManager
 {
   PhoshDBusSensorProxyProxy parent;
 
+  PhoshSensorState          sensors[PHOSH_SENSOR_TYPE_LAST];
+  guint                     dispatch_id;
+  guint                     orientation_id;
 } PhoshSensorProxyManager;
 
 
@@ -39,9 +68,180 @@ G_DEFINE_TYPE (PhoshSensorProxyManager, phosh_sensor_proxy_manager,
                PHOSH_DBUS_TYPE_SENSOR_PROXY_PROXY)
 
 
+static void
+emit_event (PhoshSensorProxyManager *self, PhoshSensorType type)
+{
+  PhoshDBusSensorProxy *proxy = PHOSH_DBUS_SENSOR_PROXY (self);
+  PhoshSensorState *state = &self->sensors[type];
+
+  state->pending = FALSE;
+  state->n_events++;
+
+  switch (type) {
+  case PHOSH_SENSOR_TYPE_ACCELEROMETER:
+    g_signal_emit (self, signals[ORIENTATION_CHANGED], 0,
+                   phosh_dbus_sensor_proxy_get_accelerometer_orientation (proxy));
+    break;
+  case PHOSH_SENSOR_TYPE_LIGHT:
+    g_signal_emit (self, signals[LIGHT_LEVEL_CHANGED], 0,
+                   phosh_dbus_sensor_proxy_get_light_level (proxy));
+    break;
+  case PHOSH_SENSOR_TYPE_PROXIMITY:
+    g_signal_emit (self, signals[PROXIMITY_CHANGED], 0,
+                   phosh_dbus_sensor_proxy_get_proximity_near (proxy));
+    break;
+  case PHOSH_SENSOR_TYPE_LAST:
+  default:
+    g_assert_not_reached ();
+  }
+}
+
+
+static gboolean
+on_dispatch_idle (gpointer data)
+{
+  PhoshSensorProxyManager *self = PHOSH_SENSOR_PROXY_MANAGER (data);
+
+  self->dispatch_id = 0;
+
+  if (self->sensors[PHOSH_SENSOR_TYPE_PROXIMITY].pending)
+    emit_event (self, PHOSH_SENSOR_TYPE_PROXIMITY);
+
+  if (self->sensors[PHOSH_SENSOR_TYPE_LIGHT].pending)
+    emit_event (self, PHOSH_SENSOR_TYPE_LIGHT);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static gboolean
+on_orientation_debounced (gpointer data)
+{
+  PhoshSensorProxyManager *self = PHOSH_SENSOR_PROXY_MANAGER (data);
+
+  self->orientation_id = 0;
+  emit_event (self, PHOSH_SENSOR_TYPE_ACCELEROMETER);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+add_reading (PhoshSensorProxyManager *self, PhoshSensorType type, gint64 now)
+{
+  PhoshSensorState *state = &self->sensors[type];
+
+  state->timestamp = now;
+  state->n_readings++;
+  state->pending = TRUE;
+
+  if (type == PHOSH_SENSOR_TYPE_ACCELEROMETER) {
+    /* Restart the timer so we only report orientations that stick */
+    g_clear_handle_id (&self->orientation_id, g_source_remove);
+    self->orientation_id = g_timeout_add (ORIENTATION_DEBOUNCE_MS, on_orientation_debounced, self);
+    g_source_set_name_by_id (self->orientation_id, "[phosh] sensor orientation debounce");
+    return;
+  }
+
+  if (self->dispatch_id)
+    return;
+
+  /* Coalesce bursts so we handle them at most once per frame */
+  self->dispatch_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE + 10, on_dispatch_idle, self, NULL);
+  g_source_set_name_by_id (self->dispatch_id, "[phosh] sensor dispatch");
+}
+
+
+static void
+phosh_sensor_proxy_manager_g_properties_changed (GDBusProxy          *proxy,
+                                                 GVariant            *changed_properties,
+                                                 const char * const  *invalidated_properties)
+{
+  PhoshSensorProxyManager *self = PHOSH_SENSOR_PROXY_MANAGER (proxy);
+  gint64 now = g_get_monotonic_time ();
+  GVariantIter iter;
+  const char *name;
+
+  /* Update the cache and notify properties */
+  G_DBUS_PROXY_CLASS (phosh_sensor_proxy_manager_parent_class)->g_properties_changed (
+    proxy, changed_properties, invalidated_properties);
+
+  g_variant_iter_init (&iter, changed_properties);
+  while (g_variant_iter_next (&iter, "{&sv}", &name, NULL)) {
+    if (g_str_equal (name, "AccelerometerOrientation"))
+      add_reading (self, PHOSH_SENSOR_TYPE_ACCELEROMETER, now);
+    else if (g_str_equal (name, "LightLevel"))
+      add_reading (self, PHOSH_SENSOR_TYPE_LIGHT, now);
+    else if (g_str_equal (name, "ProximityNear"))
+      add_reading (self, PHOSH_SENSOR_TYPE_PROXIMITY, now);
+  }
+}
+
+
+static void
+phosh_sensor_proxy_manager_dispose (GObject *object)
+{
+  PhoshSensorProxyManager *self = PHOSH_SENSOR_PROXY_MANAGER (object);
+
+  g_clear_handle_id (&self->dispatch_id, g_source_remove);
+  g_clear_handle_id (&self->orientation_id, g_source_remove);
+
+  G_OBJECT_CLASS (phosh_sensor_proxy_manager_parent_class)->dispose (object);
+}
+
+
 static void
 phosh_sensor_proxy_manager_class_init (PhoshSensorProxyManagerClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GDBusProxyClass *proxy_class = G_DBUS_PROXY_CLASS (klass);
+
+  object_class->dispose = phosh_sensor_proxy_manager_dispose;
+  proxy_class->g_properties_changed = phosh_sensor_proxy_manager_g_properties_changed;
+
+  /**
+   * PhoshSensorProxyManager::orientation-changed:
+   * @self: The sensor proxy manager
+   * @orientation: The accelerometer orientation
+   *
+   * Emitted when the accelerometer orientation changed and stayed
+   * stable for a short amount of time.
+   */
+  signals[ORIENTATION_CHANGED] = g_signal_new ("orientation-changed",
+                                               G_TYPE_FROM_CLASS (klass),
+                                               G_SIGNAL_RUN_LAST, 0, NULL, NULL,
+                                               NULL,
+                                               G_TYPE_NONE,
+                                               1,
+                                               G_TYPE_STRING);
+  /**
+   * PhoshSensorProxyManager::light-level-changed:
+   * @self: The sensor proxy manager
+   * @level: The ambient light level
+   *
+   * Emitted at most once per frame when the ambient light level changed.
+   */
+  signals[LIGHT_LEVEL_CHANGED] = g_signal_new ("light-level-changed",
+                                               G_TYPE_FROM_CLASS (klass),
+                                               G_SIGNAL_RUN_LAST, 0, NULL, NULL,
+                                               NULL,
+                                               G_TYPE_NONE,
+                                               1,
+                                               G_TYPE_DOUBLE);
+  /**
+   * PhoshSensorProxyManager::proximity-changed:
+   * @self: The sensor proxy manager
+   * @near: Whether an object is near
+   *
+   * Emitted at most once per frame when the proximity changed.
+   */
+  signals[PROXIMITY_CHANGED] = g_signal_new ("proximity-changed",
+                                             G_TYPE_FROM_CLASS (klass),
+                                             G_SIGNAL_RUN_LAST, 0, NULL, NULL,
+                                             NULL,
+                                             G_TYPE_NONE,
+                                             1,
+                                             G_TYPE_BOOLEAN);
 }
 
 
@@ -62,3 +262,36 @@ phosh_sensor_proxy_manager_new (GError **err)
                          "g-interface-name", IIO_SENSOR_PROXY_DBUS_IFACE_NAME,
                          NULL);
 }
+
+
+/**
+ * phosh_sensor_proxy_manager_get_counters:
+ * @self: The sensor proxy manager
+ * @type: The sensor to get the counters for
+ * @n_readings:(out)(optional): Number of readings received
+ * @n_events:(out)(optional): Number of events dispatched to subscribers
+ *
+ * Gets the number of readings received from a sensor and the number
+ * of events dispatched after coalescing and debouncing. Sampling
+ * these periodically gives the respective rates.
+ *
+ * Returns: The monotonic time of the last reading or `0` if there
+ *   was none so far.
+ */
+gint64
+phosh_sensor_proxy_manager_get_counters (PhoshSensorProxyManager *self,
+                                         PhoshSensorType          type,
+                                         guint64                 *n_readings,
+                                         guint64                 *n_events)
+{
+  g_return_val_if_fail (PHOSH_IS_SENSOR_PROXY_MANAGER (self), 0);
+  g_return_val_if_fail (type < PHOSH_SENSOR_TYPE_LAST, 0);
+
+  if (n_readings)
+    *n_readings = self->sensors[type].n_readings;
+
+  if (n_events)
+    *n_events = self->sensors[type].n_events;
+
+  return self->sensors[type].timestamp;
+}
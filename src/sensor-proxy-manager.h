@@ -8,6 +8,22 @@
 
 #include "dbus/iio-sensor-proxy-dbus.h"
 
+/**
+ * PhoshSensorType:
+ * @PHOSH_SENSOR_TYPE_ACCELEROMETER: The accelerometer
+ * @PHOSH_SENSOR_TYPE_LIGHT: The ambient light sensor
+ * @PHOSH_SENSOR_TYPE_PROXIMITY: The proximity sensor
+ * @PHOSH_SENSOR_TYPE_LAST: The number of sensor types
+ *
+ * The sensors handled by #PhoshSensorProxyManager.
+ */
+typedef enum {
+  PHOSH_SENSOR_TYPE_ACCELEROMETER,
+  PHOSH_SENSOR_TYPE_LIGHT,
+  PHOSH_SENSOR_TYPE_PROXIMITY,
+  PHOSH_SENSOR_TYPE_LAST, /*< skip >*/
+} PhoshSensorType;
+
 #define PHOSH_TYPE_SENSOR_PROXY_MANAGER     (phosh_sensor_proxy_manager_get_type ())
 
 G_DECLARE_FINAL_TYPE (PhoshSensorProxyManager, phosh_sensor_proxy_manager,
@@ -16,3 +32,7 @@ G_DECLARE_FINAL_TYPE (PhoshSensorProxyManager, phosh_sensor_proxy_manager,
 PhoshSensorProxyManager *phosh_sensor_proxy_manager_new (GError **err);
 gboolean phosh_sensor_proxy_manager_claim_proximity_sync (PhoshSensorProxyManager *self,
                                                           GError **err);
+gint64   phosh_sensor_proxy_manager_get_counters (PhoshSensorProxyManager *self,
+                                                  PhoshSensorType          type,
+                                                  guint64                 *n_readings,
+                                                  guint64                 *n_events);
@@ -60,6 +60,7 @@ typedef enum {
  * @PHOSH_SHELL_DEBUG_FLAG_ALWAYS_SPLASH: always use splash (even when docked)
  * @PHOSH_SHELL_DEBUG_FLAG_FAKE_BUILTIN: When calculatiog layout treat the first
  *     virtual output like a built-in output.
+ * @PHOSH_SHELL_DEBUG_FLAG_FRAME_STATS: Draw frame statistics on top of layer surfaces
  *
  * These flags are to enable/disable debugging features.
  */
@@ -67,6 +68,7 @@ typedef enum {
   PHOSH_SHELL_DEBUG_FLAG_NONE          = 0,
   PHOSH_SHELL_DEBUG_FLAG_ALWAYS_SPLASH = 1 << 0,
   PHOSH_SHELL_DEBUG_FLAG_FAKE_BUILTIN  = 1 << 1,
+  PHOSH_SHELL_DEBUG_FLAG_FRAME_STATS   = 1 << 2,
 } PhoshShellDebugFlags;
 
 
@@ -103,6 +105,8 @@ PhoshEmergencyCallsManager *phosh_shell_get_emergency_calls_manager (PhoshShell
 void                 phosh_shell_enable_power_save (PhoshShell *self, gboolean enable);
 gboolean             phosh_shell_started_by_display_manager(PhoshShell *self);
 gboolean             phosh_shell_is_startup_finished (PhoshShell *self);
+GStrv                phosh_shell_get_startup_stages (PhoshShell *self);
+gint64               phosh_shell_get_startup_stage_time (PhoshShell *self, const char *stage);
 void                 phosh_shell_add_global_keyboard_action_entries (PhoshShell *self,
                                                                      const GActionEntry *actions,
                                                                      gint n_entries,
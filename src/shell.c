@@ -25,6 +25,7 @@
 
 #include "phosh-config.h"
 #include "ambient.h"
+#include "animation.h"
 #include "background.h"
 #include "drag-surface.h"
 #include "shell-priv.h"
@@ -36,6 +37,7 @@
 #include "connectivity-info.h"
 #include "connectivity-manager.h"
 #include "calls-manager.h"
+#include "debug-manager.h"
 #include "cell-broadcast-manager.h"
 #include "docked-info.h"
 #include "docked-manager.h"
@@ -56,6 +58,7 @@
 #include "location-manager.h"
 #include "lockscreen-manager-priv.h"
 #include "default-media-player.h"
+#include "memory-registry.h"
 #include "mode-manager.h"
 #include "monitor-manager.h"
 #include "monitor/monitor.h"
@@ -92,6 +95,7 @@
 #include "top-panel-bg.h"
 #include "torch-manager.h"
 #include "torch-info.h"
+#include "trace.h"
 #include "util.h"
 #include "vpn-info.h"
 #include "wifi-info.h"
@@ -135,6 +139,32 @@ static guint signals[N_SIGNALS] = { 0 };
 
 static PhoshShellDebugFlags debug_flags;
 
+/* Startup stages, in order of priority */
+typedef enum {
+  PHOSH_SHELL_STAGE_CORE,
+  PHOSH_SHELL_STAGE_PANELS,
+  PHOSH_SHELL_STAGE_SCREEN_SAVER,
+  PHOSH_SHELL_STAGE_NOTIFICATIONS,
+  PHOSH_SHELL_STAGE_MONITORS,
+  PHOSH_SHELL_STAGE_SESSION,
+  PHOSH_SHELL_STAGE_SENSORS,
+  PHOSH_SHELL_STAGE_POWER,
+  PHOSH_SHELL_STAGE_SERVICES,
+  PHOSH_SHELL_STAGE_MOUNT,
+  PHOSH_SHELL_STAGE_FEEDBACK,
+  PHOSH_SHELL_STAGE_LAST
+} PhoshShellStage;
+
+#define STAGE_BIT(stage) (1u << (stage))
+/*
+ * Once non critical stages took this long in a main loop iteration no
+ * further stage is started in that iteration. Stages aren't interrupted
+ * so a single slow stage can still exceed it.
+ */
+#define STARTUP_STAGES_BUDGET_US 5000
+/* Tell the compositor we're up even if the top panel never draws */
+#define STARTUP_FIRST_FRAME_TIMEOUT_MS 2000
+
 typedef struct
 {
   PhoshDragSurface *top_panel;
@@ -168,6 +198,7 @@ typedef struct
   PhoshModeManager *mode_manager;
   PhoshDockedManager *docked_manager;
   PhoshGtkMountManager *gtk_mount_manager;
+  PhoshDebugManager *debug_manager;
   PhoshHksManager *hks_manager;
   PhoshKeyboardEvents *keyboard_events;
   PhoshLocationManager *location_manager;
@@ -187,6 +218,8 @@ typedef struct
   PhoshConnectivityManager *connectivity_manager;
   PhoshMprisManager *mpris_manager;
 
+  GMemoryMonitor *memory_monitor;
+
   /* sensors */
   PhoshSensorProxyManager *sensor_proxy_manager;
   PhoshProximity *proximity;
@@ -194,7 +227,14 @@ typedef struct
   PhoshRotationManager *rotation_manager;
 
   gboolean             startup_finished;
-  guint                startup_finished_id;
+  gboolean             startup_frame_pending;
+  guint                startup_tick_id;
+  GdkFrameClock       *startup_frame_clock;
+  gulong               startup_after_paint_id;
+  guint                startup_frame_timeout_id;
+  guint                startup_stages_id;
+  guint                startup_stages_done;
+  gint64               startup_stage_times[PHOSH_SHELL_STAGE_LAST];
 
   GSimpleActionGroup  *action_map;
 
@@ -345,6 +385,7 @@ on_primary_monitor_power_mode_changed (PhoshShell *self, GParamSpec *pspec, Phos
   g_object_get (monitor, "power-mode", &mode, NULL);
 
   phosh_shell_set_state (self, PHOSH_STATE_BLANKED, mode == PHOSH_MONITOR_POWER_SAVE_MODE_OFF);
+  phosh_animation_set_outputs_off (mode == PHOSH_MONITOR_POWER_SAVE_MODE_OFF);
 }
 
 
@@ -383,6 +424,108 @@ setup_primary_monitor_signal_handlers (PhoshShell *self)
 }
 
 
+static void
+notify_compositor_up_state (PhoshShell *self, enum phosh_private_shell_state state)
+{
+  struct phosh_private *phosh_private;
+
+  g_debug ("Notify compositor state: %d", state);
+
+  phosh_private = phosh_wayland_get_phosh_private (phosh_wayland_get_default ());
+  if (phosh_private && phosh_private_get_version (phosh_private) >= PHOSH_PRIVATE_SET_SHELL_STATE_SINCE_VERSION)
+    phosh_private_set_shell_state (phosh_private, state);
+}
+
+
+static void startup_unwatch_first_frame (PhoshShell *self);
+
+static void
+startup_first_frame_done (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  startup_unwatch_first_frame (self);
+  g_clear_handle_id (&priv->startup_frame_timeout_id, g_source_remove);
+  priv->startup_frame_pending = FALSE;
+
+  notify_compositor_up_state (self, PHOSH_PRIVATE_SHELL_STATE_UP);
+}
+
+
+static void
+on_startup_after_paint (PhoshShell *self, GdkFrameClock *frame_clock)
+{
+  startup_first_frame_done (self);
+}
+
+
+static gboolean
+on_startup_first_frame_timeout (gpointer data)
+{
+  PhoshShell *self = PHOSH_SHELL (data);
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  priv->startup_frame_timeout_id = 0;
+  g_warning ("Top panel didn't draw within %dms", STARTUP_FIRST_FRAME_TIMEOUT_MS);
+  startup_first_frame_done (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static gboolean
+on_startup_first_tick (GtkWidget *widget, GdkFrameClock *frame_clock, gpointer user_data)
+{
+  PhoshShell *self = PHOSH_SHELL (user_data);
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  /* The top panel's first frame gets painted and committed after this */
+  priv->startup_tick_id = 0;
+  priv->startup_frame_clock = g_object_ref (frame_clock);
+  priv->startup_after_paint_id = g_signal_connect_swapped (frame_clock, "after-paint",
+                                                           G_CALLBACK (on_startup_after_paint),
+                                                           self);
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+startup_unwatch_first_frame (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  if (priv->startup_tick_id && priv->top_panel)
+    gtk_widget_remove_tick_callback (GTK_WIDGET (priv->top_panel), priv->startup_tick_id);
+  priv->startup_tick_id = 0;
+
+  if (priv->startup_frame_clock) {
+    g_clear_signal_handler (&priv->startup_after_paint_id, priv->startup_frame_clock);
+    g_clear_object (&priv->startup_frame_clock);
+  }
+}
+
+
+/*
+ * Signal the compositor once the top panel painted its first frame.
+ * When locked it's shown on the overlay layer along the lock screen
+ * so the user can unlock right away.
+ */
+static void
+startup_watch_first_frame (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  startup_unwatch_first_frame (self);
+  if (!priv->startup_frame_pending || priv->top_panel == NULL)
+    return;
+
+  priv->startup_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (priv->top_panel),
+                                                        on_startup_first_tick,
+                                                        self,
+                                                        NULL);
+}
+
+
 static void
 panels_create (PhoshShell *self)
 {
@@ -432,6 +575,9 @@ panels_create (PhoshShell *self)
                           app_grid,
                           "filter-adaptive",
                           G_BINDING_SYNC_CREATE | G_BINDING_INVERT_BOOLEAN);
+
+  /* Panels got recreated before startup finished */
+  startup_watch_first_frame (self);
 }
 
 
@@ -440,6 +586,7 @@ panels_dispose (PhoshShell *self)
 {
   PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
 
+  startup_unwatch_first_frame (self);
   g_clear_pointer (&priv->top_panel, phosh_cp_widget_destroy);
   g_clear_pointer (&priv->home, phosh_cp_widget_destroy);
 }
@@ -539,13 +686,18 @@ phosh_shell_dispose (GObject *object)
   PhoshShell *self = PHOSH_SHELL (object);
   PhoshShellPrivate *priv = phosh_shell_get_instance_private(self);
 
-  g_clear_handle_id (&priv->startup_finished_id, g_source_remove);
+  g_clear_handle_id (&priv->startup_stages_id, g_source_remove);
+  g_clear_handle_id (&priv->startup_frame_timeout_id, g_source_remove);
+  /* Don't set up anything on first use while tearing down */
+  priv->startup_stages_done = G_MAXUINT;
 
   panels_dispose (self);
   g_clear_pointer (&priv->faders, g_ptr_array_unref);
 
   g_clear_pointer (&priv->notification_banner, phosh_cp_widget_destroy);
 
+  g_clear_object (&priv->memory_monitor);
+
   /* dispose managers in opposite order of declaration */
   g_clear_object (&priv->mpris_manager);
   g_clear_object (&priv->connectivity_manager);
@@ -553,6 +705,7 @@ phosh_shell_dispose (GObject *object)
   g_clear_object (&priv->launcher_entry_manager);
   g_clear_object (&priv->power_menu_manager);
   g_clear_object (&priv->emergency_calls_manager);
+  g_clear_object (&priv->debug_manager);
   g_clear_object (&priv->portal_access_manager);
   g_clear_object (&priv->vpn_manager);
   g_clear_object (&priv->network_auth_manager);
@@ -696,48 +849,23 @@ static gboolean
 on_fade_out_timeout (PhoshShell *self)
 {
   PhoshShellPrivate *priv;
+  g_autofree PhoshFader **faders = NULL;
+  gsize n_faders;
 
   g_return_val_if_fail (PHOSH_IS_SHELL (self), G_SOURCE_REMOVE);
 
   priv = phosh_shell_get_instance_private (self);
 
-  /* kill all faders if we time out */
-  priv->faders = g_ptr_array_remove_range (priv->faders, 0, priv->faders->len);
+  /* Fade out all faders together if we time out, they destroy themselves */
+  faders = (PhoshFader **) g_ptr_array_steal (priv->faders, &n_faders);
+  phosh_fader_hide_group (faders, n_faders);
 
   return G_SOURCE_REMOVE;
 }
 
 
 static void
-notify_compositor_up_state (PhoshShell *self, enum phosh_private_shell_state state)
-{
-  struct phosh_private *phosh_private;
-
-  g_debug ("Notify compositor state: %d", state);
-
-  phosh_private = phosh_wayland_get_phosh_private (phosh_wayland_get_default ());
-  if (phosh_private && phosh_private_get_version (phosh_private) >= PHOSH_PRIVATE_SET_SHELL_STATE_SINCE_VERSION)
-    phosh_private_set_shell_state (phosh_private, state);
-}
-
-
-static void
-on_startup_finished (gpointer data)
-{
-  PhoshShell *self = PHOSH_SHELL (data);
-  PhoshShellPrivate *priv;
-
-  g_return_if_fail (PHOSH_IS_SHELL (self));
-  priv = phosh_shell_get_instance_private (self);
-
-  notify_compositor_up_state (self, PHOSH_PRIVATE_SHELL_STATE_UP);
-
-  priv->startup_finished_id = 0;
-}
-
-
-static gboolean
-setup_idle_cb (PhoshShell *self)
+setup_stage_core (PhoshShell *self)
 {
   g_autoptr (GError) err = NULL;
   PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
@@ -749,6 +877,7 @@ setup_idle_cb (PhoshShell *self)
   /* Connecivity manager needs Wi-Fi manager: */
   priv->connectivity_manager = phosh_connectivity_manager_new ();
 
+  /* Rotation manager needs the sensor proxy */
   priv->sensor_proxy_manager = phosh_sensor_proxy_manager_new (&err);
   if (!priv->sensor_proxy_manager)
     g_message ("Failed to connect to sensor-proxy: %s", err->message);
@@ -756,6 +885,14 @@ setup_idle_cb (PhoshShell *self)
   priv->layout_manager = phosh_layout_manager_new ();
   /* PhoshHome needs the background manager */
   priv->background_manager = phosh_background_manager_new ();
+}
+
+
+static void
+setup_stage_panels (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
   panels_create (self);
 
   g_signal_connect_object (priv->toplevel_manager,
@@ -770,6 +907,13 @@ setup_idle_cb (PhoshShell *self)
                            G_CALLBACK (on_toplevel_added),
                            self,
                            G_CONNECT_SWAPPED);
+}
+
+
+static void
+setup_stage_screen_saver (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
 
   /* Screen saver manager needs lock screen manager */
   priv->screen_saver_manager = phosh_screen_saver_manager_new (priv->lockscreen_manager);
@@ -777,6 +921,13 @@ setup_idle_cb (PhoshShell *self)
                             "pb-long-press",
                             G_CALLBACK (on_pb_long_press),
                             self);
+}
+
+
+static void
+setup_stage_notifications (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
 
   priv->notify_manager = phosh_notify_manager_get_default ();
   g_signal_connect_object (priv->notify_manager,
@@ -789,6 +940,32 @@ setup_idle_cb (PhoshShell *self)
                            G_CALLBACK (on_notification_activated),
                            self,
                            G_CONNECT_SWAPPED);
+}
+
+
+static void
+setup_stage_monitors (PhoshShell *self)
+{
+  setup_primary_monitor_signal_handlers (self);
+}
+
+
+static void
+setup_stage_session (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  phosh_session_manager_register (priv->session_manager,
+                                  PHOSH_APP_ID,
+                                  g_getenv ("DESKTOP_AUTOSTART_ID"));
+  g_unsetenv ("DESKTOP_AUTOSTART_ID");
+}
+
+
+static void
+setup_stage_sensors (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
 
   phosh_shell_get_location_manager (self);
   if (priv->sensor_proxy_manager) {
@@ -800,14 +977,34 @@ setup_idle_cb (PhoshShell *self)
                               G_CALLBACK (on_proximity_fader_changed), self);
     priv->ambient = phosh_ambient_new (priv->sensor_proxy_manager);
   }
+}
 
-  priv->mount_manager = phosh_mount_manager_new ();
-  priv->gtk_mount_manager = phosh_gtk_mount_manager_new ();
 
-  phosh_session_manager_register (priv->session_manager,
-                                  PHOSH_APP_ID,
-                                  g_getenv ("DESKTOP_AUTOSTART_ID"));
-  g_unsetenv ("DESKTOP_AUTOSTART_ID");
+static void
+setup_stage_power (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  priv->suspend_manager = phosh_suspend_manager_new ();
+  priv->emergency_calls_manager = phosh_emergency_calls_manager_new ();
+  priv->power_menu_manager = phosh_power_menu_manager_new ();
+  priv->cell_broadcast_manager = phosh_cell_broadcast_manager_new ();
+}
+
+
+static void
+on_low_memory_warning (PhoshShell                 *self,
+                       GMemoryMonitorWarningLevel  level,
+                       GMemoryMonitor             *monitor)
+{
+  phosh_memory_registry_handle_warning (phosh_memory_registry_get_default (), level);
+}
+
+
+static void
+setup_stage_services (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
 
   priv->gnome_shell_manager = phosh_gnome_shell_manager_get_default ();
   priv->screenshot_manager = phosh_screenshot_manager_new ();
@@ -815,19 +1012,152 @@ setup_idle_cb (PhoshShell *self)
   priv->run_command_manager = phosh_run_command_manager_new ();
   priv->network_auth_manager = phosh_network_auth_manager_new ();
   priv->portal_access_manager = phosh_portal_access_manager_new ();
-  priv->suspend_manager = phosh_suspend_manager_new ();
-  priv->emergency_calls_manager = phosh_emergency_calls_manager_new ();
-  priv->power_menu_manager = phosh_power_menu_manager_new ();
-  priv->cell_broadcast_manager = phosh_cell_broadcast_manager_new ();
+  priv->debug_manager = phosh_debug_manager_new (priv->sensor_proxy_manager);
+
+  priv->memory_monitor = g_memory_monitor_dup_default ();
+  g_signal_connect_object (priv->memory_monitor,
+                           "low-memory-warning",
+                           G_CALLBACK (on_low_memory_warning),
+                           self,
+                           G_CONNECT_SWAPPED);
+}
+
+
+static void
+setup_stage_mount (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  priv->mount_manager = phosh_mount_manager_new ();
+  priv->gtk_mount_manager = phosh_gtk_mount_manager_new ();
+}
+
+
+static void
+setup_stage_feedback (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
 
-  setup_primary_monitor_signal_handlers (self);
   /* Setup event hooks late so state changes in UI files don't trigger feedback */
   phosh_feedback_manager_setup_event_hooks (priv->feedback_manager);
+}
+
+
+static const struct {
+  const char *name;
+  void      (*setup) (PhoshShell *self);
+  /* Needed to show the lock screen and let the user unlock */
+  gboolean    critical;
+  guint       deps;
+} startup_stages[PHOSH_SHELL_STAGE_LAST] = {
+  [PHOSH_SHELL_STAGE_CORE] = {
+    "core", setup_stage_core, TRUE, 0,
+  },
+  [PHOSH_SHELL_STAGE_PANELS] = {
+    "panels", setup_stage_panels, TRUE, STAGE_BIT (PHOSH_SHELL_STAGE_CORE),
+  },
+  [PHOSH_SHELL_STAGE_SCREEN_SAVER] = {
+    "screen-saver", setup_stage_screen_saver, TRUE, 0,
+  },
+  [PHOSH_SHELL_STAGE_NOTIFICATIONS] = {
+    "notifications", setup_stage_notifications, TRUE, STAGE_BIT (PHOSH_SHELL_STAGE_PANELS),
+  },
+  [PHOSH_SHELL_STAGE_MONITORS] = {
+    "monitors", setup_stage_monitors, TRUE, STAGE_BIT (PHOSH_SHELL_STAGE_PANELS),
+  },
+  [PHOSH_SHELL_STAGE_SESSION] = {
+    "session", setup_stage_session, FALSE, STAGE_BIT (PHOSH_SHELL_STAGE_CORE),
+  },
+  [PHOSH_SHELL_STAGE_SENSORS] = {
+    "sensors", setup_stage_sensors, FALSE, STAGE_BIT (PHOSH_SHELL_STAGE_CORE),
+  },
+  [PHOSH_SHELL_STAGE_POWER] = {
+    "power", setup_stage_power, FALSE, 0,
+  },
+  [PHOSH_SHELL_STAGE_SERVICES] = {
+    "services", setup_stage_services, FALSE, STAGE_BIT (PHOSH_SHELL_STAGE_CORE),
+  },
+  [PHOSH_SHELL_STAGE_MOUNT] = {
+    "mount", setup_stage_mount, FALSE, 0,
+  },
+  [PHOSH_SHELL_STAGE_FEEDBACK] = {
+    "feedback", setup_stage_feedback, FALSE, STAGE_BIT (PHOSH_SHELL_STAGE_PANELS),
+  },
+};
+
 
-  /* Delay signaling to the compositor a bit so that idle handlers get a chance to run and
-     the user can unlock right away. Ideally we'd not need this */
-  priv->startup_finished_id = g_timeout_add_seconds_once (1, on_startup_finished, self);
-  g_source_set_name_by_id (priv->startup_finished_id, "[PhoshShell] startup finished");
+static void
+run_stage (PhoshShell *self, PhoshShellStage stage)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+  gint64 start, trace;
+
+  if (priv->startup_stages_done & STAGE_BIT (stage))
+    return;
+
+  for (PhoshShellStage dep = 0; dep < PHOSH_SHELL_STAGE_LAST; dep++) {
+    if (startup_stages[stage].deps & STAGE_BIT (dep))
+      run_stage (self, dep);
+  }
+
+  /* Mark as done first so lazy getters don't recurse */
+  priv->startup_stages_done |= STAGE_BIT (stage);
+
+  trace = PHOSH_TRACE_BEGIN ();
+  start = g_get_monotonic_time ();
+  startup_stages[stage].setup (self);
+  priv->startup_stage_times[stage] = g_get_monotonic_time () - start;
+  PHOSH_TRACE_END (trace, "startup-stage", "%s", startup_stages[stage].name);
+
+  g_debug ("Startup stage '%s' took %.1fms", startup_stages[stage].name,
+           priv->startup_stage_times[stage] / 1000.0);
+}
+
+
+static gboolean
+on_startup_stages_idle (gpointer data)
+{
+  PhoshShell *self = PHOSH_SHELL (data);
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+  gint64 start = g_get_monotonic_time ();
+
+  for (PhoshShellStage stage = 0; stage < PHOSH_SHELL_STAGE_LAST; stage++) {
+    if (priv->startup_stages_done & STAGE_BIT (stage))
+      continue;
+
+    /* Yield to the main loop, the budget is only checked between stages */
+    if (g_get_monotonic_time () - start > STARTUP_STAGES_BUDGET_US)
+      return G_SOURCE_CONTINUE;
+
+    run_stage (self, stage);
+  }
+
+  g_debug ("All startup stages done");
+  priv->startup_stages_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+
+static gboolean
+setup_idle_cb (PhoshShell *self)
+{
+  PhoshShellPrivate *priv = phosh_shell_get_instance_private (self);
+
+  for (PhoshShellStage stage = 0; stage < PHOSH_SHELL_STAGE_LAST; stage++) {
+    if (startup_stages[stage].critical)
+      run_stage (self, stage);
+  }
+
+  priv->startup_frame_pending = TRUE;
+  startup_watch_first_frame (self);
+  priv->startup_frame_timeout_id = g_timeout_add (STARTUP_FIRST_FRAME_TIMEOUT_MS,
+                                                  on_startup_first_frame_timeout,
+                                                  self);
+  g_source_set_name_by_id (priv->startup_frame_timeout_id, "[PhoshShell] first frame timeout");
+
+  /* Everything else gets set up in time sliced chunks or on first use */
+  priv->startup_stages_id = g_idle_add (on_startup_stages_idle, self);
+  g_source_set_name_by_id (priv->startup_stages_id, "[PhoshShell] startup stages");
 
   priv->startup_finished = TRUE;
   g_signal_emit (self, signals[READY], 0);
@@ -1330,6 +1660,9 @@ static GDebugKey debug_keys[] =
  { .key = "fake-builtin",
    .value = PHOSH_SHELL_DEBUG_FLAG_FAKE_BUILTIN,
  },
+ { .key = "frame-stats",
+   .value = PHOSH_SHELL_DEBUG_FLAG_FRAME_STATS,
+ },
 };
 
 
@@ -1348,6 +1681,7 @@ phosh_shell_init (PhoshShell *self)
   debug_flags = g_parse_debug_string (g_getenv ("PHOSH_DEBUG"),
                                       debug_keys,
                                       G_N_ELEMENTS (debug_keys));
+  phosh_layer_surface_set_frame_stats_overlay (debug_flags & PHOSH_SHELL_DEBUG_FLAG_FRAME_STATS);
 
   priv->style_manager = phosh_style_manager_new ();
   priv->shell_state = PHOSH_STATE_SETTINGS;
@@ -1572,6 +1906,8 @@ phosh_shell_get_emergency_calls_manager (PhoshShell *self)
 
   g_return_val_if_fail (PHOSH_IS_SHELL (self), NULL);
   priv = phosh_shell_get_instance_private (self);
+
+  run_stage (self, PHOSH_SHELL_STAGE_POWER);
   g_return_val_if_fail (PHOSH_IS_EMERGENCY_CALLS_MANAGER (priv->emergency_calls_manager), NULL);
 
   return priv->emergency_calls_manager;
@@ -1612,6 +1948,8 @@ phosh_shell_get_gtk_mount_manager (PhoshShell *self)
 
   g_return_val_if_fail (PHOSH_IS_SHELL (self), NULL);
   priv = phosh_shell_get_instance_private (self);
+
+  run_stage (self, PHOSH_SHELL_STAGE_MOUNT);
   g_return_val_if_fail (PHOSH_IS_GTK_MOUNT_MANAGER (priv->gtk_mount_manager), NULL);
 
   return priv->gtk_mount_manager;
@@ -1793,6 +2131,7 @@ phosh_shell_get_screenshot_manager (PhoshShell *self)
   g_return_val_if_fail (PHOSH_IS_SHELL (self), NULL);
   priv = phosh_shell_get_instance_private (self);
 
+  run_stage (self, PHOSH_SHELL_STAGE_SERVICES);
   g_return_val_if_fail (PHOSH_IS_SCREENSHOT_MANAGER (priv->screenshot_manager), NULL);
   return priv->screenshot_manager;
 }
@@ -2226,7 +2565,10 @@ phosh_shell_fade_out (PhoshShell *self, guint timeout)
     PhoshFader *fader;
     PhoshMonitor *monitor = phosh_monitor_manager_get_monitor (monitor_manager, i);
 
-    fader = phosh_fader_new (monitor);
+    fader = g_object_new (PHOSH_TYPE_FADER,
+                          "monitor", monitor,
+                          "fade-out-time", 250,
+                          NULL);
     g_ptr_array_add (priv->faders, fader);
     gtk_widget_set_visible (GTK_WIDGET (fader), TRUE);
     if (timeout > 0) {
@@ -2277,6 +2619,60 @@ phosh_shell_started_by_display_manager(PhoshShell *self)
   return FALSE;
 }
 
+/**
+ * phosh_shell_get_startup_stages:
+ * @self: The shell singleton
+ *
+ * Gets the names of the startup stages in the order they're set up in
+ * when nothing is requested early.
+ *
+ * Returns:(transfer full): The stage names
+ */
+GStrv
+phosh_shell_get_startup_stages (PhoshShell *self)
+{
+  g_autoptr (GStrvBuilder) builder = g_strv_builder_new ();
+
+  g_return_val_if_fail (PHOSH_IS_SHELL (self), NULL);
+
+  for (PhoshShellStage i = 0; i < PHOSH_SHELL_STAGE_LAST; i++)
+    g_strv_builder_add (builder, startup_stages[i].name);
+
+  return g_strv_builder_end (builder);
+}
+
+/**
+ * phosh_shell_get_startup_stage_time:
+ * @self: The shell singleton
+ * @stage: The name of the startup stage
+ *
+ * Gets the time it took to set up the given startup stage.
+ *
+ * Returns: The time in microseconds or `-1` if the stage isn't set up
+ *   yet or doesn't exist.
+ */
+gint64
+phosh_shell_get_startup_stage_time (PhoshShell *self, const char *stage)
+{
+  PhoshShellPrivate *priv;
+
+  g_return_val_if_fail (PHOSH_IS_SHELL (self), -1);
+  g_return_val_if_fail (stage, -1);
+  priv = phosh_shell_get_instance_private (self);
+
+  for (PhoshShellStage i = 0; i < PHOSH_SHELL_STAGE_LAST; i++) {
+    if (!g_str_equal (startup_stages[i].name, stage))
+      continue;
+
+    if (!(priv->startup_stages_done & STAGE_BIT (i)))
+      return -1;
+
+    return priv->startup_stage_times[i];
+  }
+
+  return -1;
+}
+
 /**
  * phosh_shell_is_startup_finished:
  * @self: The shell
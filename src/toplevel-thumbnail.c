@@ -11,6 +11,7 @@
 #include "phosh-wayland.h"
 #include "shell-priv.h"
 #include "toplevel-thumbnail.h"
+#include "trace.h"
 #include "util.h"
 #include "wl-buffer.h"
 
@@ -37,6 +38,7 @@ struct _PhoshToplevelThumbnail {
   struct zwlr_screencopy_frame_v1 *handle;
   PhoshWlBuffer                   *buffer;
   gboolean                         ready;
+  gint64                           trace;
 };
 
 G_DEFINE_TYPE (PhoshToplevelThumbnail, phosh_toplevel_thumbnail, PHOSH_TYPE_THUMBNAIL);
@@ -87,6 +89,11 @@ screencopy_handle_ready(void *data,
                         uint32_t tv_sec_lo,
                         uint32_t tv_nsec)
 {
+  PhoshToplevelThumbnail *self = PHOSH_TOPLEVEL_THUMBNAIL (data);
+
+  PHOSH_TRACE_END (self->trace, "thumbnail", "%ux%u",
+                   self->buffer ? self->buffer->width : 0,
+                   self->buffer ? self->buffer->height : 0);
   phosh_toplevel_thumbnail_set_ready (PHOSH_THUMBNAIL (data), TRUE);
 }
 
@@ -94,6 +101,9 @@ static void
 screencopy_handle_failed (void *data,
                           struct zwlr_screencopy_frame_v1 *zwlr_screencopy_frame_v1)
 {
+  PhoshToplevelThumbnail *self = PHOSH_TOPLEVEL_THUMBNAIL (data);
+
+  PHOSH_TRACE_END (self->trace, "thumbnail", "failed");
   g_warning ("screencopy failed! %p", data);
 }
 
@@ -265,6 +275,8 @@ phosh_toplevel_thumbnail_new_from_toplevel (PhoshToplevel *toplevel, guint32 max
   struct zwlr_foreign_toplevel_handle_v1 *handle = phosh_toplevel_get_handle (PHOSH_TOPLEVEL (toplevel));
   struct phosh_private *phosh = phosh_wayland_get_phosh_private (phosh_wayland_get_default ());
   struct zwlr_screencopy_frame_v1 *frame;
+  PhoshToplevelThumbnail *self;
+  gint64 trace = PHOSH_TRACE_BEGIN ();
 
   if (!phosh || phosh_private_get_version (phosh) < PHOSH_PRIVATE_GET_THUMBNAIL_SINCE_VERSION)
     return NULL;
@@ -278,5 +290,8 @@ phosh_toplevel_thumbnail_new_from_toplevel (PhoshToplevel *toplevel, guint32 max
     max_width, max_height
    );
 
-  return phosh_toplevel_thumbnail_new_from_handle (frame);
+  self = phosh_toplevel_thumbnail_new_from_handle (frame);
+  self->trace = trace;
+
+  return self;
 }
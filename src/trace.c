@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-trace"
+
+#include "phosh-config.h"
+
+#include "trace.h"
+
+#ifdef PHOSH_HAVE_TRACING
+
+#include <sysprof-capture.h>
+
+#define TRACE_GROUP "phosh"
+
+/*
+ * Begin/end marks for sysprof so we can attribute jank on devices
+ * without rebuilding with debug logging. When phosh doesn't run under
+ * sysprof `phosh_trace_begin()` returns 0 and the matching
+ * `phosh_trace_end()` does nothing, so the only cost is a function
+ * call and a check.
+ */
+
+/**
+ * phosh_trace_begin:
+ *
+ * Start a mark. Use `PHOSH_TRACE_BEGIN()` instead so tracing compiles
+ * away when disabled.
+ *
+ * Returns: The begin time to pass to `phosh_trace_end()` or `0` if no
+ *   trace is being recorded.
+ */
+gint64
+phosh_trace_begin (void)
+{
+  if (!sysprof_collector_is_active ())
+    return 0;
+
+  return SYSPROF_CAPTURE_CURRENT_TIME;
+}
+
+/**
+ * phosh_trace_end:
+ * @begin: The time returned by `phosh_trace_begin()`
+ * @name: The name of the mark
+ * @format: printf style format for the mark's message
+ * @...: The arguments for @format
+ *
+ * End a mark started with `phosh_trace_begin()`. Use `PHOSH_TRACE_END()`
+ * instead so tracing compiles away when disabled.
+ */
+void
+phosh_trace_end (gint64 begin, const char *name, const char *format, ...)
+{
+  va_list args;
+
+  if (begin == 0)
+    return;
+
+  va_start (args, format);
+  sysprof_collector_mark_vprintf (begin,
+                                  SYSPROF_CAPTURE_CURRENT_TIME - begin,
+                                  TRACE_GROUP,
+                                  name,
+                                  format,
+                                  args);
+  va_end (args);
+}
+
+#endif /* PHOSH_HAVE_TRACING */
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#pragma once
+
+#include "phosh-config.h"
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#ifdef PHOSH_HAVE_TRACING
+
+gint64           phosh_trace_begin (void);
+void             phosh_trace_end   (gint64      begin,
+                                    const char *name,
+                                    const char *format,
+                                    ...) G_GNUC_PRINTF (3, 4);
+
+# define PHOSH_TRACE_BEGIN()            phosh_trace_begin ()
+# define PHOSH_TRACE_END(begin, ...)    phosh_trace_end ((begin), __VA_ARGS__)
+
+#else
+
+# define PHOSH_TRACE_BEGIN()            ((gint64) 0)
+# define PHOSH_TRACE_END(begin, ...)    G_STMT_START { (void) (begin); } G_STMT_END
+
+#endif
+
+G_END_DECLS
@@ -23,8 +23,15 @@
  *
  * The widget box is displayed on the lock screen
  * and displays a list of loadable widgets.
+ *
+ * Plugins are loaded lazily: Each carousel page starts out as a
+ * placeholder that gets filled with the plugin's widget once the page
+ * is about to become visible. The remaining plugins are loaded in
+ * idle time once the widget box is mapped.
  */
 
+#define PLUGIN_NAME_KEY "phosh-widget-box-plugin"
+
 enum {
   PROP_0,
   PROP_PLUGIN_DIRS,
@@ -41,6 +48,9 @@ struct _PhoshWidgetBox {
 
   GStrv                 plugin_dirs;
   GStrv                 plugins;
+
+  guint                 load_near_id;
+  guint                 load_idle_id;
 };
 G_DEFINE_TYPE (PhoshWidgetBox, phosh_widget_box, GTK_TYPE_BOX)
 
@@ -61,6 +71,100 @@ missing_plugin_widget_new (const char *plugin)
 }
 
 
+/* Returns %TRUE if a plugin was loaded, %FALSE if it was already loaded */
+static gboolean
+load_placeholder (PhoshWidgetBox *self, GtkWidget *placeholder)
+{
+  const char *name = g_object_get_data (G_OBJECT (placeholder), PLUGIN_NAME_KEY);
+  GtkWidget *widget;
+
+  if (name == NULL)
+    return FALSE;
+
+  widget = phosh_plugin_loader_load_plugin (self->plugin_loader, name);
+  if (widget == NULL) {
+    g_warning ("Plugin '%s' not found", name);
+    widget = missing_plugin_widget_new (name);
+  }
+
+  gtk_widget_set_visible (widget, TRUE);
+  gtk_box_pack_start (GTK_BOX (placeholder), widget, TRUE, TRUE, 0);
+
+  g_object_set_data (G_OBJECT (placeholder), PLUGIN_NAME_KEY, NULL);
+  return TRUE;
+}
+
+
+/* Load the plugins of the current page and its neighbours */
+static void
+load_near (PhoshWidgetBox *self)
+{
+  g_autoptr (GList) children = NULL;
+  double position;
+  int i = 0;
+
+  position = hdy_carousel_get_position (HDY_CAROUSEL (self->carousel));
+  children = gtk_container_get_children (GTK_CONTAINER (self->carousel));
+
+  for (GList *elem = children; elem; elem = elem->next, i++) {
+    if (ABS (i - position) <= 1.0)
+      load_placeholder (self, GTK_WIDGET (elem->data));
+  }
+}
+
+
+static gboolean
+on_load_near_idle (gpointer data)
+{
+  PhoshWidgetBox *self = PHOSH_WIDGET_BOX (data);
+
+  self->load_near_id = 0;
+  load_near (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static gboolean
+on_placeholder_draw (GtkWidget *placeholder, cairo_t *cr, PhoshWidgetBox *self)
+{
+  if (self->load_near_id || g_object_get_data (G_OBJECT (placeholder), PLUGIN_NAME_KEY) == NULL)
+    return GDK_EVENT_PROPAGATE;
+
+  /* Can't add widgets while drawing, load right after */
+  self->load_near_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE, on_load_near_idle, self, NULL);
+  g_source_set_name_by_id (self->load_near_id, "[phosh] widget box load near");
+
+  return GDK_EVENT_PROPAGATE;
+}
+
+
+static gboolean
+on_load_idle (gpointer data)
+{
+  PhoshWidgetBox *self = PHOSH_WIDGET_BOX (data);
+  g_autoptr (GList) children = NULL;
+
+  children = gtk_container_get_children (GTK_CONTAINER (self->carousel));
+
+  /* Load at most one plugin per main loop iteration */
+  for (GList *elem = children; elem; elem = elem->next) {
+    if (load_placeholder (self, GTK_WIDGET (elem->data)))
+      return G_SOURCE_CONTINUE;
+  }
+
+  self->load_idle_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+on_carousel_position_changed (PhoshWidgetBox *self)
+{
+  load_near (self);
+}
+
+
 static void
 phosh_widget_box_load_widgets (PhoshWidgetBox *self)
 {
@@ -74,17 +178,36 @@ phosh_widget_box_load_widgets (PhoshWidgetBox *self)
     gtk_container_remove (GTK_CONTAINER (self->carousel), GTK_WIDGET (elem->data));
 
   for (int i = 0; i < g_strv_length (self->plugins); i++) {
-    GtkWidget *widget = phosh_plugin_loader_load_plugin (self->plugin_loader, self->plugins[i]);
+    GtkWidget *placeholder = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
 
-    if (widget == NULL) {
-      g_warning ("Plugin '%s' not found", self->plugins[i]);
-      widget = missing_plugin_widget_new (self->plugins[i]);
-    }
+    g_object_set_data_full (G_OBJECT (placeholder), PLUGIN_NAME_KEY,
+                            g_strdup (self->plugins[i]), g_free);
+    g_signal_connect_object (placeholder, "draw", G_CALLBACK (on_placeholder_draw), self, 0);
 
-    gtk_widget_set_visible (widget, TRUE);
-    gtk_widget_set_hexpand (widget, TRUE);
-    hdy_carousel_insert (HDY_CAROUSEL (self->carousel), widget, -1);
+    gtk_widget_set_visible (placeholder, TRUE);
+    gtk_widget_set_hexpand (placeholder, TRUE);
+    hdy_carousel_insert (HDY_CAROUSEL (self->carousel), placeholder, -1);
   }
+
+  if (gtk_widget_get_mapped (GTK_WIDGET (self)) && !self->load_idle_id) {
+    self->load_idle_id = g_idle_add_full (G_PRIORITY_LOW, on_load_idle, self, NULL);
+    g_source_set_name_by_id (self->load_idle_id, "[phosh] widget box load");
+  }
+}
+
+
+static void
+phosh_widget_box_map (GtkWidget *widget)
+{
+  PhoshWidgetBox *self = PHOSH_WIDGET_BOX (widget);
+
+  GTK_WIDGET_CLASS (phosh_widget_box_parent_class)->map (widget);
+
+  if (self->load_idle_id)
+    return;
+
+  self->load_idle_id = g_idle_add_full (G_PRIORITY_LOW, on_load_idle, self, NULL);
+  g_source_set_name_by_id (self->load_idle_id, "[phosh] widget box load");
 }
 
 
@@ -136,11 +259,14 @@ phosh_widget_box_get_property (GObject    *object,
 static void
 phosh_widget_box_constructed (GObject *object)
 {
-  PhoshWidgetBox *self = PHOSH_WIDGET_BOX(object);
+  PhoshWidgetBox *self = PHOSH_WIDGET_BOX (object);
   const char *plugin_dirs[] = { PHOSH_PLUGINS_DIR, NULL };
 
   G_OBJECT_CLASS (phosh_widget_box_parent_class)->constructed (object);
 
+  g_signal_connect_swapped (self->carousel, "notify::position",
+                            G_CALLBACK (on_carousel_position_changed), self);
+
   if (self->plugin_dirs == NULL)
     self->plugin_dirs = g_strdupv ((GStrv)plugin_dirs);
 
@@ -150,6 +276,18 @@ phosh_widget_box_constructed (GObject *object)
 }
 
 
+static void
+phosh_widget_box_dispose (GObject *object)
+{
+  PhoshWidgetBox *self = PHOSH_WIDGET_BOX (object);
+
+  g_clear_handle_id (&self->load_near_id, g_source_remove);
+  g_clear_handle_id (&self->load_idle_id, g_source_remove);
+
+  G_OBJECT_CLASS (phosh_widget_box_parent_class)->dispose (object);
+}
+
+
 static void
 phosh_widget_box_finalize (GObject *object)
 {
@@ -172,8 +310,11 @@ phosh_widget_box_class_init (PhoshWidgetBoxClass *klass)
   object_class->get_property = phosh_widget_box_get_property;
   object_class->set_property = phosh_widget_box_set_property;
   object_class->constructed = phosh_widget_box_constructed;
+  object_class->dispose = phosh_widget_box_dispose;
   object_class->finalize = phosh_widget_box_finalize;
 
+  widget_class->map = phosh_widget_box_map;
+
   props[PROP_PLUGIN_DIRS] =
     g_param_spec_boxed ("plugin-dirs", "", "",
                         G_TYPE_STRV,
@@ -9,6 +9,7 @@
 
 #include "phosh-config.h"
 
+#include "shell-priv.h"
 #include "wifi-manager.h"
 #include "util.h"
 
@@ -23,8 +24,17 @@
  *
  * The code to create hotspot connection are based on GNOME Control Center's and NMCLI's code for
  * the same.
+ *
+ * Access points change their strength all the time while scanning so
+ * strength changes are collected and applied every
+ * [property@WifiManager:strength-update-interval] milliseconds. While
+ * a widget showing the networks is visible (see
+ * [method@WifiManager.hold_live_updates]) they're applied right before
+ * the next frame instead. Nothing is updated while the screen is off.
  */
 
+#define STRENGTH_UPDATE_INTERVAL_DEFAULT 5000 /* ms */
+
 enum {
   PROP_0,
   PROP_ICON_NAME,
@@ -35,6 +45,7 @@ enum {
   PROP_NETWORKS,
   PROP_STATE,
   PROP_SCANNING,
+  PROP_STRENGTH_UPDATE_INTERVAL,
   PROP_LAST_PROP
 };
 static GParamSpec *props[PROP_LAST_PROP];
@@ -69,8 +80,23 @@ struct _PhoshWifiManager {
   NMDeviceWifi       *conn_dev;
   /* The Wi-Fi device of the system */
   NMDeviceWifi       *dev;
-  /* The list of available Wi-Fi networks */
+  /* The list of available Wi-Fi networks, sorted by strength */
   GListStore         *networks; /* (element-type: PhoshWifiNetwork) */
+  /* Networks by (SSID, mode, security) */
+  GHashTable         *networks_by_key; /* (element-type: utf8 PhoshWifiNetwork) */
+  /* The network each access point was added to */
+  GHashTable         *networks_by_ap; /* (element-type: NMAccessPoint PhoshWifiNetwork) */
+  /* Networks that need to be moved in the list */
+  GHashTable         *resort_networks; /* (element-type: PhoshWifiNetwork) */
+  guint               resort_id;
+
+  /* Networks with access points that changed strength */
+  GHashTable         *strength_changed; /* (element-type: PhoshWifiNetwork) */
+  gboolean            active_strength_changed;
+  guint               strength_update_id;
+  guint               strength_update_interval;
+  guint               live_updates;
+  gboolean            blanked;
 };
 G_DEFINE_TYPE (PhoshWifiManager, phosh_wifi_manager, G_TYPE_OBJECT);
 
@@ -574,6 +600,25 @@ on_request_scan (GObject *object, GAsyncResult *result, gpointer data)
 }
 
 
+static void
+phosh_wifi_manager_set_property (GObject      *object,
+                                 guint         property_id,
+                                 const GValue *value,
+                                 GParamSpec   *pspec)
+{
+  PhoshWifiManager *self = PHOSH_WIFI_MANAGER (object);
+
+  switch (property_id) {
+  case PROP_STRENGTH_UPDATE_INTERVAL:
+    phosh_wifi_manager_set_strength_update_interval (self, g_value_get_uint (value));
+    break;
+  default:
+    G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
+    break;
+  }
+}
+
+
 static void
 phosh_wifi_manager_get_property (GObject    *object,
                                  guint       property_id,
@@ -604,6 +649,9 @@ phosh_wifi_manager_get_property (GObject    *object,
   case PROP_STATE:
     g_value_set_enum (value, self->state);
     break;
+  case PROP_STRENGTH_UPDATE_INTERVAL:
+    g_value_set_uint (value, self->strength_update_interval);
+    break;
   default:
     G_OBJECT_WARN_INVALID_PROPERTY_ID (object, property_id, pspec);
     break;
@@ -626,12 +674,250 @@ get_access_point_ssid (NMAccessPoint *ap)
   return ssid;
 }
 
+
+static char *
+get_network_key (const char *ssid, NM80211Mode mode, gboolean secured)
+{
+  return g_strdup_printf ("%s\n%u\n%d", ssid, mode, !!secured);
+}
+
+
+static char *
+get_access_point_network_key (NMAccessPoint *ap, const char *ssid)
+{
+  return get_network_key (ssid,
+                          nm_access_point_get_mode (ap),
+                          nm_access_point_get_flags (ap) & NM_802_11_AP_FLAGS_PRIVACY);
+}
+
+
+static int
+compare_networks (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+  PhoshWifiNetwork *network_a = PHOSH_WIFI_NETWORK ((gpointer) a);
+  PhoshWifiNetwork *network_b = PHOSH_WIFI_NETWORK ((gpointer) b);
+  guint strength_a = phosh_wifi_network_get_strength (network_a);
+  guint strength_b = phosh_wifi_network_get_strength (network_b);
+
+  /* Strongest first, ties sorted by name so the order is stable */
+  if (strength_a != strength_b)
+    return strength_a > strength_b ? -1 : 1;
+
+  return g_strcmp0 (phosh_wifi_network_get_ssid (network_a),
+                    phosh_wifi_network_get_ssid (network_b));
+}
+
+
 static gboolean
-is_valid_access_point (NMAccessPoint *ap)
+is_network_in_order (PhoshWifiManager *self, guint position)
 {
-  g_autofree char *ssid = get_access_point_ssid (ap);
+  GListModel *model = G_LIST_MODEL (self->networks);
+  g_autoptr (PhoshWifiNetwork) network = g_list_model_get_item (model, position);
+
+  if (position > 0) {
+    g_autoptr (PhoshWifiNetwork) prev = g_list_model_get_item (model, position - 1);
+
+    if (compare_networks (prev, network, NULL) > 0)
+      return FALSE;
+  }
+
+  if (position + 1 < g_list_model_get_n_items (model)) {
+    g_autoptr (PhoshWifiNetwork) next = g_list_model_get_item (model, position + 1);
+
+    if (compare_networks (network, next, NULL) > 0)
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+/*
+ * Move networks whose strength changed to their new position. Networks
+ * that didn't change are still sorted relative to each other so we only
+ * take out the changed ones that are out of order and put them back in.
+ * Networks that stay in place don't emit items-changed so their rows
+ * are kept.
+ */
+static gboolean
+on_resort_networks (gpointer data)
+{
+  PhoshWifiManager *self = PHOSH_WIFI_MANAGER (data);
+  g_autoptr (GPtrArray) moved = g_ptr_array_new_with_free_func (g_object_unref);
+  PhoshWifiNetwork *network;
+  GHashTableIter iter;
+  gboolean removed;
+
+  do {
+    removed = FALSE;
+    g_hash_table_iter_init (&iter, self->resort_networks);
+    while (g_hash_table_iter_next (&iter, (gpointer *) &network, NULL)) {
+      guint position;
+
+      if (!g_list_store_find (self->networks, network, &position)) {
+        g_hash_table_iter_remove (&iter);
+        continue;
+      }
+
+      if (is_network_in_order (self, position))
+        continue;
+
+      g_ptr_array_add (moved, g_object_ref (network));
+      g_list_store_remove (self->networks, position);
+      g_hash_table_iter_remove (&iter);
+      removed = TRUE;
+    }
+  } while (removed);
+
+  for (guint i = 0; i < moved->len; i++) {
+    network = g_ptr_array_index (moved, i);
+    g_list_store_insert_sorted (self->networks, network, compare_networks, NULL);
+  }
+
+  g_hash_table_remove_all (self->resort_networks);
+  self->resort_id = 0;
+  return G_SOURCE_REMOVE;
+}
+
+
+static void
+on_network_strength_changed (PhoshWifiManager *self, GParamSpec *pspec, PhoshWifiNetwork *network)
+{
+  g_hash_table_add (self->resort_networks, network);
+
+  if (self->resort_id)
+    return;
+
+  /* Batch up all changes until right before the next frame */
+  self->resort_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE + 10,
+                                     on_resort_networks,
+                                     self,
+                                     NULL);
+  g_source_set_name_by_id (self->resort_id, "[phosh] wifi resort networks");
+}
+
+
+static void
+flush_strength_updates (PhoshWifiManager *self)
+{
+  GHashTableIter iter;
+  PhoshWifiNetwork *network;
+
+  g_clear_handle_id (&self->strength_update_id, g_source_remove);
+
+  g_hash_table_iter_init (&iter, self->strength_changed);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &network, NULL))
+    phosh_wifi_network_update_strength (network);
+  g_hash_table_remove_all (self->strength_changed);
+
+  if (self->active_strength_changed) {
+    self->active_strength_changed = FALSE;
+    g_debug ("Strength changed: %d", phosh_wifi_manager_get_strength (self));
+    update_properties (self);
+  }
+
+  /* We're about to draw anyway so no need to wait for another idle */
+  if (self->resort_id) {
+    g_clear_handle_id (&self->resort_id, g_source_remove);
+    on_resort_networks (self);
+  }
+}
+
+
+static gboolean
+on_strength_update (gpointer data)
+{
+  PhoshWifiManager *self = PHOSH_WIFI_MANAGER (data);
+
+  self->strength_update_id = 0;
+  flush_strength_updates (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+
+static gboolean
+has_strength_updates (PhoshWifiManager *self)
+{
+  return self->active_strength_changed || g_hash_table_size (self->strength_changed);
+}
+
+
+static void
+schedule_strength_update (PhoshWifiManager *self)
+{
+  if (self->strength_update_id || !has_strength_updates (self))
+    return;
+
+  /* Keep collecting, we update once the screen is back on */
+  if (self->blanked)
+    return;
+
+  if (self->live_updates) {
+    self->strength_update_id = g_idle_add_full (G_PRIORITY_HIGH_IDLE + 10,
+                                                on_strength_update,
+                                                self,
+                                                NULL);
+  } else {
+    self->strength_update_id = g_timeout_add (self->strength_update_interval,
+                                              on_strength_update,
+                                              self);
+  }
+  g_source_set_name_by_id (self->strength_update_id, "[phosh] wifi strength update");
+}
+
+
+static void
+reschedule_strength_update (PhoshWifiManager *self)
+{
+  g_clear_handle_id (&self->strength_update_id, g_source_remove);
+  schedule_strength_update (self);
+}
+
+
+static void
+on_access_point_strength_changed (PhoshWifiManager *self, GParamSpec *pspec, NMAccessPoint *ap)
+{
+  PhoshWifiNetwork *network = g_hash_table_lookup (self->networks_by_ap, ap);
+
+  g_return_if_fail (network);
+
+  g_hash_table_add (self->strength_changed, network);
+  schedule_strength_update (self);
+}
+
+
+static void
+on_shell_state_changed (PhoshWifiManager *self, GParamSpec *pspec, PhoshShell *shell)
+{
+  gboolean blanked = !!(phosh_shell_get_state (shell) & PHOSH_STATE_BLANKED);
+
+  if (self->blanked == blanked)
+    return;
+
+  self->blanked = blanked;
+  reschedule_strength_update (self);
+}
+
+
+static void
+remove_network (PhoshWifiManager *self, PhoshWifiNetwork *network)
+{
+  g_autofree char *key = NULL;
+  guint position;
+
+  key = get_network_key (phosh_wifi_network_get_ssid (network),
+                         phosh_wifi_network_get_mode (network),
+                         phosh_wifi_network_get_secured (network));
+
+  g_signal_handlers_disconnect_by_data (network, self);
+  g_hash_table_remove (self->resort_networks, network);
+  g_hash_table_remove (self->strength_changed, network);
+
+  if (g_list_store_find (self->networks, network, &position))
+    g_list_store_remove (self->networks, position);
 
-  return ssid != NULL;
+  g_hash_table_remove (self->networks_by_key, key);
 }
 
 
@@ -639,54 +925,57 @@ static void
 on_nm_access_point_added (PhoshWifiManager *self, NMAccessPoint *ap)
 {
   g_autoptr (PhoshWifiNetwork) n = NULL;
-  guint length = g_list_model_get_n_items (G_LIST_MODEL (self->networks));
   g_autofree char *ssid = get_access_point_ssid (ap);
+  g_autofree char *key = NULL;
+  PhoshWifiNetwork *network;
 
   g_assert (NM_IS_ACCESS_POINT (ap));
 
-  if (!is_valid_access_point (ap)) {
+  if (ssid == NULL) {
     g_debug ("Discarding access point due to no SSID");
     return;
   }
 
-  for (guint i = 0; i < length; i++) {
-    g_autoptr (PhoshWifiNetwork) network = NULL;
-    network = g_list_model_get_item (G_LIST_MODEL (self->networks), i);
+  if (g_hash_table_contains (self->networks_by_ap, ap))
+    return;
 
-    if (phosh_wifi_network_matches_access_point (network, ap)) {
-      g_debug ("Adding access point to existing network: %s", ssid);
-      phosh_wifi_network_add_access_point (network, ap, self->ap == ap);
-      return;
-    }
+  g_signal_connect_swapped (ap, "notify::strength",
+                            G_CALLBACK (on_access_point_strength_changed), self);
+
+  key = get_access_point_network_key (ap, ssid);
+  network = g_hash_table_lookup (self->networks_by_key, key);
+  if (network) {
+    g_debug ("Adding access point to existing network: %s", ssid);
+    phosh_wifi_network_add_access_point (network, ap, self->ap == ap);
+    g_hash_table_insert (self->networks_by_ap, g_object_ref (ap), network);
+    return;
   }
+
   g_debug ("Creating network: %s", ssid);
   n = phosh_wifi_network_new_from_access_point (ap, self->ap == ap);
-  g_list_store_append (self->networks, n);
+  g_hash_table_insert (self->networks_by_key, g_steal_pointer (&key), g_object_ref (n));
+  g_hash_table_insert (self->networks_by_ap, g_object_ref (ap), n);
+  g_signal_connect_swapped (n, "notify::strength", G_CALLBACK (on_network_strength_changed), self);
+  g_list_store_insert_sorted (self->networks, n, compare_networks, NULL);
 }
 
 
 static void
 on_nm_access_point_removed (PhoshWifiManager *self, NMAccessPoint *ap)
 {
-  guint length = g_list_model_get_n_items (G_LIST_MODEL (self->networks));
-  g_autofree char *ssid = get_access_point_ssid (ap);
+  g_autoptr (NMAccessPoint) ref = NULL;
+  PhoshWifiNetwork *network;
 
-  if (!is_valid_access_point (ap))
+  /* Keep the AP around until it's removed from the network */
+  if (!g_hash_table_steal_extended (self->networks_by_ap, ap, (gpointer *) &ref, (gpointer *) &network))
     return;
 
-  g_debug ("Removing AP: %s", ssid);
+  g_debug ("Removing AP: %s", phosh_wifi_network_get_ssid (network));
+  g_signal_handlers_disconnect_by_func (ap, on_access_point_strength_changed, self);
 
-  for (guint i = 0; i < length; i++) {
-    g_autoptr (PhoshWifiNetwork) network = NULL;
-    network = g_list_model_get_item (G_LIST_MODEL (self->networks), i);
-
-    if (phosh_wifi_network_matches_access_point (network, ap)) {
-      if (phosh_wifi_network_remove_access_point (network, ap)) {
-        g_debug ("Removing network: %s", ssid);
-        g_list_store_remove (self->networks, i);
-      }
-      return;
-    }
+  if (phosh_wifi_network_remove_access_point (network, ap)) {
+    g_debug ("Removing network: %s", phosh_wifi_network_get_ssid (network));
+    remove_network (self, network);
   }
 }
 
@@ -704,22 +993,63 @@ reset_active_wifi_network (PhoshWifiManager *self)
 }
 
 
+static void
+clear_networks (PhoshWifiManager *self)
+{
+  GHashTableIter iter;
+  PhoshWifiNetwork *network;
+  NMAccessPoint *ap;
+
+  g_hash_table_iter_init (&iter, self->networks_by_key);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &network))
+    g_signal_handlers_disconnect_by_data (network, self);
+
+  g_hash_table_iter_init (&iter, self->networks_by_ap);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &ap, NULL))
+    g_signal_handlers_disconnect_by_func (ap, on_access_point_strength_changed, self);
+
+  g_clear_handle_id (&self->resort_id, g_source_remove);
+  g_hash_table_remove_all (self->resort_networks);
+  g_hash_table_remove_all (self->strength_changed);
+  g_hash_table_remove_all (self->networks_by_ap);
+  g_hash_table_remove_all (self->networks_by_key);
+  g_list_store_remove_all (self->networks);
+}
+
+
+/*
+ * Sync networks with the device's access points. We only touch what
+ * changed so rows of networks that are still around are kept.
+ */
 static void
 refresh_access_points (PhoshWifiManager *self)
 {
+  g_autoptr (GHashTable) current = NULL;
+  g_autoptr (GPtrArray) gone = NULL;
   const GPtrArray *aps;
+  GHashTableIter iter;
   NMAccessPoint *ap;
 
   if (self->dev == NULL)
     return;
 
-  g_list_store_remove_all (G_LIST_STORE (self->networks));
   aps = nm_device_wifi_get_access_points (self->dev);
 
-  if (aps == NULL)
-    return;
+  current = g_hash_table_new (g_direct_hash, g_direct_equal);
+  for (guint i = 0; aps && i < aps->len; i++)
+    g_hash_table_add (current, g_ptr_array_index (aps, i));
+
+  gone = g_ptr_array_new ();
+  g_hash_table_iter_init (&iter, self->networks_by_ap);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &ap, NULL)) {
+    if (!g_hash_table_contains (current, ap))
+      g_ptr_array_add (gone, ap);
+  }
 
-  for (int i = 0; i < aps->len; i++) {
+  for (guint i = 0; i < gone->len; i++)
+    on_nm_access_point_removed (self, g_ptr_array_index (gone, i));
+
+  for (guint i = 0; aps && i < aps->len; i++) {
     ap = g_ptr_array_index (aps, i);
     on_nm_access_point_added (self, ap);
   }
@@ -729,15 +1059,11 @@ refresh_access_points (PhoshWifiManager *self)
 static void
 on_nm_access_point_strength_changed (PhoshWifiManager *self, GParamSpec *pspec, NMAccessPoint *ap)
 {
-  guint8 strength;
-
   g_return_if_fail (PHOSH_IS_WIFI_MANAGER (self));
   g_return_if_fail (NM_IS_ACCESS_POINT (ap));
 
-  strength = phosh_wifi_manager_get_strength (self);
-  g_debug ("Strength changed: %d", strength);
-
-  update_properties (self);
+  self->active_strength_changed = TRUE;
+  schedule_strength_update (self);
 }
 
 
@@ -769,7 +1095,7 @@ on_nm_device_wifi_active_access_point_changed (PhoshWifiManager *self,
   if (self->ap)
     g_object_ref (self->ap);
   if (old_ap) {
-    g_signal_handlers_disconnect_by_data (old_ap, self);
+    g_signal_handlers_disconnect_by_func (old_ap, on_nm_access_point_strength_changed, self);
     g_object_unref (old_ap);
   }
 
@@ -779,7 +1105,7 @@ on_nm_device_wifi_active_access_point_changed (PhoshWifiManager *self,
   if (self->ap) {
     g_signal_connect_swapped (self->ap, "notify::strength",
                               G_CALLBACK (on_nm_access_point_strength_changed), self);
-    on_nm_access_point_strength_changed (self, NULL, self->ap);
+    update_properties (self);
 
     ssid = nm_access_point_get_ssid (self->ap);
     self->ssid = nm_utils_ssid_to_utf8 (g_bytes_get_data (ssid, NULL), g_bytes_get_size (ssid));
@@ -828,7 +1154,7 @@ static void
 cleanup_connection_device (PhoshWifiManager *self)
 {
   if (self->ap) {
-    g_signal_handlers_disconnect_by_data (self->ap, self);
+    g_signal_handlers_disconnect_by_func (self->ap, on_nm_access_point_strength_changed, self);
     g_clear_object (&self->ap);
     g_clear_pointer (&self->ssid, g_free);
     g_object_notify_by_pspec (G_OBJECT (self), props[PROP_SSID]);
@@ -969,7 +1295,7 @@ cleanup_wifi_device (PhoshWifiManager *self)
   if (self->dev == NULL)
     return;
 
-  g_list_store_remove_all (G_LIST_STORE (self->networks));
+  clear_networks (self);
 
   g_signal_handlers_disconnect_by_data (self->dev, self);
   g_clear_object (&self->dev);
@@ -1062,10 +1388,20 @@ phosh_wifi_manager_constructed (GObject *object)
   PhoshWifiManager *self = PHOSH_WIFI_MANAGER (object);
 
   self->networks = g_list_store_new (PHOSH_TYPE_WIFI_NETWORK);
+  self->networks_by_key = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+  self->networks_by_ap = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
+  self->resort_networks = g_hash_table_new (g_direct_hash, g_direct_equal);
 
   self->cancel = g_cancellable_new ();
   nm_client_new_async (self->cancel, on_nm_client_ready, self);
 
+  g_signal_connect_object (phosh_shell_get_default (),
+                           "notify::shell-state",
+                           G_CALLBACK (on_shell_state_changed),
+                           self,
+                           G_CONNECT_SWAPPED);
+  on_shell_state_changed (self, NULL, phosh_shell_get_default ());
+
   G_OBJECT_CLASS (phosh_wifi_manager_parent_class)->constructed (object);
 }
 
@@ -1079,7 +1415,7 @@ phosh_wifi_manager_dispose (GObject *object)
   g_clear_object (&self->cancel);
 
   if (self->ap) {
-    g_signal_handlers_disconnect_by_data (self->ap, self);
+    g_signal_handlers_disconnect_by_func (self->ap, on_nm_access_point_strength_changed, self);
     g_clear_object (&self->ap);
   }
 
@@ -1089,6 +1425,7 @@ phosh_wifi_manager_dispose (GObject *object)
   }
 
   g_clear_handle_id (&self->scanning_id, g_source_remove);
+  g_clear_handle_id (&self->strength_update_id, g_source_remove);
   cleanup_connection_device (self);
   cleanup_wifi_device (self);
 
@@ -1099,6 +1436,10 @@ phosh_wifi_manager_dispose (GObject *object)
 
   g_clear_pointer (&self->ssid, g_free);
 
+  g_clear_pointer (&self->strength_changed, g_hash_table_destroy);
+  g_clear_pointer (&self->resort_networks, g_hash_table_destroy);
+  g_clear_pointer (&self->networks_by_ap, g_hash_table_destroy);
+  g_clear_pointer (&self->networks_by_key, g_hash_table_destroy);
   g_clear_object (&self->networks);
 
   G_OBJECT_CLASS (phosh_wifi_manager_parent_class)->dispose (object);
@@ -1113,6 +1454,7 @@ phosh_wifi_manager_class_init (PhoshWifiManagerClass *klass)
   object_class->constructed = phosh_wifi_manager_constructed;
   object_class->dispose = phosh_wifi_manager_dispose;
 
+  object_class->set_property = phosh_wifi_manager_set_property;
   object_class->get_property = phosh_wifi_manager_get_property;
 
   /**
@@ -1187,6 +1529,16 @@ phosh_wifi_manager_class_init (PhoshWifiManagerClass *klass)
     g_param_spec_boolean ("scanning", "", "",
                           FALSE,
                           G_PARAM_READABLE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+  /**
+   * PhoshWifiManager:strength-update-interval:
+   *
+   * How often (in milliseconds) to apply access point strength changes
+   * when no live updates are requested.
+   */
+  props[PROP_STRENGTH_UPDATE_INTERVAL] =
+    g_param_spec_uint ("strength-update-interval", "", "",
+                       0, G_MAXUINT, STRENGTH_UPDATE_INTERVAL_DEFAULT,
+                       G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
 
   g_object_class_install_properties (object_class, PROP_LAST_PROP, props);
 }
@@ -1196,6 +1548,8 @@ static void
 phosh_wifi_manager_init (PhoshWifiManager *self)
 {
   self->icon_name = "network-wireless-disabled-symbolic";
+  self->strength_update_interval = STRENGTH_UPDATE_INTERVAL_DEFAULT;
+  self->strength_changed = g_hash_table_new (g_direct_hash, g_direct_equal);
 }
 
 
@@ -1404,3 +1758,63 @@ phosh_wifi_manager_get_state (PhoshWifiManager *self)
 
   return self->state;
 }
+
+/**
+ * phosh_wifi_manager_set_strength_update_interval:
+ * @self: The WiFi manager
+ * @interval: The interval in milliseconds
+ *
+ * Set how often access point strength changes are applied when no
+ * live updates are requested.
+ */
+void
+phosh_wifi_manager_set_strength_update_interval (PhoshWifiManager *self, guint interval)
+{
+  g_return_if_fail (PHOSH_IS_WIFI_MANAGER (self));
+
+  if (self->strength_update_interval == interval)
+    return;
+
+  self->strength_update_interval = interval;
+  if (!self->live_updates)
+    reschedule_strength_update (self);
+
+  g_object_notify_by_pspec (G_OBJECT (self), props[PROP_STRENGTH_UPDATE_INTERVAL]);
+}
+
+/**
+ * phosh_wifi_manager_hold_live_updates:
+ * @self: The WiFi manager
+ *
+ * Request strength changes to be applied before the next frame rather
+ * than every [property@WifiManager:strength-update-interval]
+ * milliseconds. Widgets showing networks should hold live updates
+ * while they're mapped. Balance with
+ * [method@WifiManager.release_live_updates].
+ */
+void
+phosh_wifi_manager_hold_live_updates (PhoshWifiManager *self)
+{
+  g_return_if_fail (PHOSH_IS_WIFI_MANAGER (self));
+
+  self->live_updates++;
+  if (self->live_updates == 1)
+    reschedule_strength_update (self);
+}
+
+/**
+ * phosh_wifi_manager_release_live_updates:
+ * @self: The WiFi manager
+ *
+ * Release a hold taken via [method@WifiManager.hold_live_updates].
+ */
+void
+phosh_wifi_manager_release_live_updates (PhoshWifiManager *self)
+{
+  g_return_if_fail (PHOSH_IS_WIFI_MANAGER (self));
+  g_return_if_fail (self->live_updates > 0);
+
+  self->live_updates--;
+  if (self->live_updates == 0)
+    reschedule_strength_update (self);
+}
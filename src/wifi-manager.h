@@ -32,5 +32,9 @@ void               phosh_wifi_manager_connect_network (PhoshWifiManager *self,
 void               phosh_wifi_manager_request_scan (PhoshWifiManager *self);
 gboolean           phosh_wifi_manager_get_scanning (PhoshWifiManager *self);
 NMActiveConnectionState phosh_wifi_manager_get_state (PhoshWifiManager *self);
+void               phosh_wifi_manager_set_strength_update_interval (PhoshWifiManager *self,
+                                                                    guint             interval);
+void               phosh_wifi_manager_hold_live_updates (PhoshWifiManager *self);
+void               phosh_wifi_manager_release_live_updates (PhoshWifiManager *self);
 
 G_END_DECLS
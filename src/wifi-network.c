@@ -153,7 +153,10 @@ find_set_best_access_point (PhoshWifiNetwork *self)
     }
   }
 
-  self->best_ap = best_ap;
+  if (self->best_ap != best_ap) {
+    self->best_ap = best_ap;
+    g_object_notify_by_pspec (G_OBJECT (self), props[PROP_BEST_ACCESS_POINT]);
+  }
 
   if (new_strength == self->strength)
     return;
@@ -168,6 +171,12 @@ update_best_access_point (PhoshWifiNetwork *self, GParamSpec *pspec, NMAccessPoi
 {
   guint strength = nm_access_point_get_strength (ap);
 
+  /* Our best AP got weaker, another one might be better now */
+  if (ap == self->best_ap && strength < self->strength) {
+    find_set_best_access_point (self);
+    return;
+  }
+
   if (strength <= self->strength)
     return;
 
@@ -178,21 +187,6 @@ update_best_access_point (PhoshWifiNetwork *self, GParamSpec *pspec, NMAccessPoi
 }
 
 
-static void
-phosh_wifi_network_dispose (GObject *object)
-{
-  PhoshWifiNetwork *self = PHOSH_WIFI_NETWORK (object);
-  NMAccessPoint *ap;
-
-  for (int i = 0; i < self->access_points->len; i++) {
-    ap = g_ptr_array_index (self->access_points, i);
-    g_signal_handlers_disconnect_by_data (ap, self);
-  }
-
-  G_OBJECT_CLASS (phosh_wifi_network_parent_class)->dispose (object);
-}
-
-
 static void
 phosh_wifi_network_finalize (GObject *object)
 {
@@ -210,7 +204,6 @@ phosh_wifi_network_class_init (PhoshWifiNetworkClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
-  object_class->dispose = phosh_wifi_network_dispose;
   object_class->finalize = phosh_wifi_network_finalize;
   object_class->set_property = phosh_wifi_network_set_property;
   object_class->get_property = phosh_wifi_network_get_property;
@@ -359,7 +352,6 @@ phosh_wifi_network_add_access_point (PhoshWifiNetwork *self, NMAccessPoint *ap,
   g_ptr_array_add (self->access_points, g_object_ref (ap));
   if (active)
     update_active (self, TRUE);
-  g_signal_connect_swapped (ap, "notify::strength", G_CALLBACK (update_best_access_point), self);
   update_best_access_point (self, NULL, ap);
 }
 
@@ -367,12 +359,27 @@ phosh_wifi_network_add_access_point (PhoshWifiNetwork *self, NMAccessPoint *ap,
 gboolean
 phosh_wifi_network_remove_access_point (PhoshWifiNetwork *self, NMAccessPoint *ap)
 {
-  g_signal_handlers_disconnect_by_data (ap, self);
   g_ptr_array_remove (self->access_points, ap);
   find_set_best_access_point (self);
   return self->access_points->len == 0;
 }
 
+/**
+ * phosh_wifi_network_update_strength:
+ * @self: A wifi network
+ *
+ * Update the network's strength and best access point from its access
+ * points. The network doesn't track the access points' strength itself
+ * so the caller can batch up updates.
+ */
+void
+phosh_wifi_network_update_strength (PhoshWifiNetwork *self)
+{
+  g_return_if_fail (PHOSH_IS_WIFI_NETWORK (self));
+
+  find_set_best_access_point (self);
+}
+
 
 const char *
 phosh_wifi_network_get_ssid (PhoshWifiNetwork *self)
@@ -25,6 +25,7 @@ void           phosh_wifi_network_add_access_point (PhoshWifiNetwork *self,
                                                     NMAccessPoint    *ap,
                                                     gboolean          active);
 gboolean       phosh_wifi_network_remove_access_point (PhoshWifiNetwork *self, NMAccessPoint *ap);
+void           phosh_wifi_network_update_strength (PhoshWifiNetwork *self);
 
 const char    *phosh_wifi_network_get_ssid (PhoshWifiNetwork *self);
 gboolean       phosh_wifi_network_get_secured (PhoshWifiNetwork *self);
@@ -31,6 +31,8 @@ struct _PhoshWifiStatusPage {
   GtkButton                  *empty_state_btn;
 
   PhoshWifiManager           *wifi;
+  /* Manager we hold live updates on while mapped */
+  PhoshWifiManager           *held_wifi;
   char                       *connecting_network;
 };
 
@@ -170,11 +172,51 @@ create_network_row (gpointer item, gpointer user_data)
 }
 
 
+static void
+release_live_updates (PhoshWifiStatusPage *self)
+{
+  if (self->held_wifi == NULL)
+    return;
+
+  phosh_wifi_manager_release_live_updates (self->held_wifi);
+  g_clear_object (&self->held_wifi);
+}
+
+
+static void
+phosh_wifi_status_page_map (GtkWidget *widget)
+{
+  PhoshWifiStatusPage *self = PHOSH_WIFI_STATUS_PAGE (widget);
+
+  /* Keep the network list's strength and order current while visible */
+  if (self->wifi && self->held_wifi == NULL) {
+    self->held_wifi = g_object_ref (self->wifi);
+    phosh_wifi_manager_hold_live_updates (self->held_wifi);
+  }
+
+  GTK_WIDGET_CLASS (phosh_wifi_status_page_parent_class)->map (widget);
+}
+
+
+static void
+phosh_wifi_status_page_unmap (GtkWidget *widget)
+{
+  PhoshWifiStatusPage *self = PHOSH_WIFI_STATUS_PAGE (widget);
+
+  release_live_updates (self);
+
+  GTK_WIDGET_CLASS (phosh_wifi_status_page_parent_class)->unmap (widget);
+}
+
+
 static void
 phosh_wifi_status_page_dispose (GObject *object)
 {
   PhoshWifiStatusPage *self = PHOSH_WIFI_STATUS_PAGE (object);
 
+  /* Dispose can run before unmap */
+  release_live_updates (self);
+
   if (self->wifi) {
     g_signal_handlers_disconnect_by_data (self->wifi, self);
     g_clear_object (&self->wifi);
@@ -194,6 +236,9 @@ phosh_wifi_status_page_class_init (PhoshWifiStatusPageClass *klass)
 
   object_class->dispose = phosh_wifi_status_page_dispose;
 
+  widget_class->map = phosh_wifi_status_page_map;
+  widget_class->unmap = phosh_wifi_status_page_unmap;
+
   gtk_widget_class_set_template_from_resource (widget_class,
                                                "/mobi/phosh/ui/wifi-status-page.ui");
 
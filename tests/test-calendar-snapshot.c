@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "calendar-snapshot.h"
+
+#include <glib/gstdio.h>
+
+#include <string.h>
+
+#define SINCE 1700000000
+#define UNTIL 1700604800
+
+
+typedef struct {
+  char *dir;
+  char *path;
+} Fixture;
+
+
+static void
+fixture_setup (Fixture *fixture, gconstpointer unused)
+{
+  g_autoptr (GError) err = NULL;
+
+  fixture->dir = g_dir_make_tmp ("phosh-test-calendar-snapshot.XXXXXX", &err);
+  g_assert_no_error (err);
+  fixture->path = g_build_filename (fixture->dir, "events.snapshot", NULL);
+}
+
+
+static void
+fixture_teardown (Fixture *fixture, gconstpointer unused)
+{
+  g_unlink (fixture->path);
+  g_rmdir (fixture->dir);
+  g_free (fixture->path);
+  g_free (fixture->dir);
+}
+
+
+static void
+save_snapshot (Fixture *fixture)
+{
+  g_autoptr (GArray) events = g_array_new (FALSE, FALSE, sizeof (CalendarSnapshotEvent));
+  g_autoptr (GError) err = NULL;
+  CalendarSnapshotEvent event;
+  gboolean success;
+
+  event = (CalendarSnapshotEvent) {
+    .id = "source\nuid1\n",
+    .summary = "Lunch",
+    .color = "#ff0000",
+    .start_time = SINCE + 3600,
+    .end_time = SINCE + 7200,
+  };
+  g_array_append_val (events, event);
+  event = (CalendarSnapshotEvent) {
+    .id = "source\nuid2\n",
+    .summary = "Lunch",
+    .color = NULL,
+    .start_time = SINCE + 86400,
+    .end_time = SINCE + 90000,
+  };
+  g_array_append_val (events, event);
+
+  success = calendar_snapshot_save (fixture->path, SINCE, UNTIL, events, &err);
+  g_assert_no_error (err);
+  g_assert_true (success);
+}
+
+
+static void
+patch_snapshot (Fixture *fixture, gsize offset, gconstpointer data, gsize len)
+{
+  g_autoptr (GError) err = NULL;
+  g_autofree char *contents = NULL;
+  gsize size;
+
+  g_file_get_contents (fixture->path, &contents, &size, &err);
+  g_assert_no_error (err);
+  g_assert_cmpint (size, >, offset + len);
+
+  memcpy (contents + offset, data, len);
+  g_file_set_contents (fixture->path, contents, size, &err);
+  g_assert_no_error (err);
+}
+
+
+static void
+test_calendar_snapshot_roundtrip (Fixture *fixture, gconstpointer unused)
+{
+  g_autoptr (CalendarSnapshot) snapshot = NULL;
+  g_autoptr (GError) err = NULL;
+  CalendarSnapshotEvent event;
+
+  save_snapshot (fixture);
+
+  snapshot = calendar_snapshot_load (fixture->path, &err);
+  g_assert_no_error (err);
+  g_assert_nonnull (snapshot);
+
+  g_assert_cmpint (calendar_snapshot_get_since (snapshot), ==, SINCE);
+  g_assert_cmpint (calendar_snapshot_get_until (snapshot), ==, UNTIL);
+  g_assert_cmpint (calendar_snapshot_get_n_events (snapshot), ==, 2);
+
+  calendar_snapshot_get_event (snapshot, 0, &event);
+  g_assert_cmpstr (event.id, ==, "source\nuid1\n");
+  g_assert_cmpstr (event.summary, ==, "Lunch");
+  g_assert_cmpstr (event.color, ==, "#ff0000");
+  g_assert_cmpint (event.start_time, ==, SINCE + 3600);
+  g_assert_cmpint (event.end_time, ==, SINCE + 7200);
+
+  calendar_snapshot_get_event (snapshot, 1, &event);
+  g_assert_cmpstr (event.id, ==, "source\nuid2\n");
+  /* Strings are shared */
+  g_assert_cmpstr (event.summary, ==, "Lunch");
+  g_assert_null (event.color);
+  g_assert_cmpint (event.start_time, ==, SINCE + 86400);
+  g_assert_cmpint (event.end_time, ==, SINCE + 90000);
+}
+
+
+static void
+test_calendar_snapshot_reject_version (Fixture *fixture, gconstpointer unused)
+{
+  g_autoptr (CalendarSnapshot) snapshot = NULL;
+  g_autoptr (GError) err = NULL;
+  guint32 version = G_MAXUINT32;
+
+  save_snapshot (fixture);
+  /* The version follows the magic */
+  patch_snapshot (fixture, sizeof (guint32), &version, sizeof (version));
+
+  snapshot = calendar_snapshot_load (fixture->path, &err);
+  g_assert_error (err, G_FILE_ERROR, G_FILE_ERROR_INVAL);
+  g_assert_null (snapshot);
+}
+
+
+static void
+test_calendar_snapshot_reject_range (Fixture *fixture, gconstpointer unused)
+{
+  g_autoptr (CalendarSnapshot) snapshot = NULL;
+  g_autoptr (GError) err = NULL;
+  gint64 since = UNTIL + 1;
+
+  save_snapshot (fixture);
+  /* The start of the range follows magic and version */
+  patch_snapshot (fixture, 2 * sizeof (guint32), &since, sizeof (since));
+
+  snapshot = calendar_snapshot_load (fixture->path, &err);
+  g_assert_error (err, G_FILE_ERROR, G_FILE_ERROR_INVAL);
+  g_assert_null (snapshot);
+}
+
+
+static void
+test_calendar_snapshot_reject_missing (Fixture *fixture, gconstpointer unused)
+{
+  g_autoptr (CalendarSnapshot) snapshot = NULL;
+  g_autoptr (GError) err = NULL;
+
+  snapshot = calendar_snapshot_load (fixture->path, &err);
+  g_assert_error (err, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+  g_assert_null (snapshot);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add ("/phosh/calendar-snapshot/roundtrip", Fixture, NULL,
+              fixture_setup, test_calendar_snapshot_roundtrip, fixture_teardown);
+  g_test_add ("/phosh/calendar-snapshot/reject-version", Fixture, NULL,
+              fixture_setup, test_calendar_snapshot_reject_version, fixture_teardown);
+  g_test_add ("/phosh/calendar-snapshot/reject-range", Fixture, NULL,
+              fixture_setup, test_calendar_snapshot_reject_range, fixture_teardown);
+  g_test_add ("/phosh/calendar-snapshot/reject-missing", Fixture, NULL,
+              fixture_setup, test_calendar_snapshot_reject_missing, fixture_teardown);
+
+  return g_test_run ();
+}
@@ -8,6 +8,8 @@
 
 #include "monitor/gamma-table.h"
 
+#include <unistd.h>
+
 #define RAMP_SIZE 2
 
 static void
@@ -27,11 +29,48 @@ test_phosh_gamma_table_fill (void)
 }
 
 
+static void
+test_phosh_gamma_table_get_fd (void)
+{
+  guint16 expected[256 * 3];
+  guint16 table[256 * 3];
+  int fd, fd2;
+
+  phosh_gamma_table_fill (expected, 256, 4000);
+  /* Warm colors dim blue */
+  g_assert_cmpint (expected[255], >, expected[255 + 2 * 256]);
+
+  fd = phosh_gamma_table_get_fd (256, 4000);
+  g_assert_cmpint (fd, >=, 0);
+  g_assert_cmpint (read (fd, table, sizeof (table)), ==, sizeof (table));
+  g_assert_cmpmem (table, sizeof (table), expected, sizeof (expected));
+
+  /* From the cache but with its own file offset */
+  fd2 = phosh_gamma_table_get_fd (256, 4000);
+  g_assert_cmpint (fd2, >=, 0);
+  g_assert_cmpint (lseek (fd2, 0, SEEK_CUR), ==, 0);
+  g_assert_cmpint (read (fd2, table, sizeof (table)), ==, sizeof (table));
+  g_assert_cmpmem (table, sizeof (table), expected, sizeof (expected));
+  g_assert_cmpint (lseek (fd, 0, SEEK_CUR), ==, sizeof (table));
+  close (fd2);
+
+  fd2 = phosh_gamma_table_get_fd (256, 4100);
+  g_assert_cmpint (fd2, >=, 0);
+  g_assert_cmpint (read (fd2, table, sizeof (table)), ==, sizeof (table));
+  g_assert_cmpint (table[255 + 2 * 256], >, expected[255 + 2 * 256]);
+  close (fd2);
+  close (fd);
+
+  phosh_gamma_table_clear_cache ();
+}
+
+
 int
 main (int argc, char *argv[])
 {
   g_test_init (&argc, &argv, NULL);
 
   g_test_add_func("/phosh/gamma-table/fill", test_phosh_gamma_table_fill);
+  g_test_add_func("/phosh/gamma-table/get-fd", test_phosh_gamma_table_get_fd);
   return g_test_run();
 }
@@ -163,6 +163,48 @@ test_layer_surface_set_kbd_interactivity (PhoshTestCompositorFixture *fixture, g
 }
 
 
+static void
+test_layer_surface_frame_stats (PhoshTestCompositorFixture *fixture, gconstpointer unused)
+{
+  g_autofree char *namespace = g_strdup_printf ("phosh test %s", __func__);
+  PhoshMonitor *monitor = phosh_test_get_monitor (fixture->state);
+  PhoshLayerSurfaceFrameStats stats;
+  GtkWidget *surface = g_object_new (PHOSH_TYPE_LAYER_SURFACE,
+                                     "layer-shell", phosh_wayland_get_zwlr_layer_shell_v1(
+                                       fixture->state->wl),
+                                     "wl-output", monitor->wl_output,
+                                     "width", 10,
+                                     "height", 10,
+                                     "layer", ZWLR_LAYER_SHELL_V1_LAYER_OVERLAY,
+                                     "kbd-interactivity", FALSE,
+                                     "exclusive-zone", -1,
+                                     "namespace", namespace,
+                                     NULL);
+
+  phosh_layer_surface_get_frame_stats (PHOSH_LAYER_SURFACE (surface), &stats);
+  g_assert_cmpuint (stats.frames, ==, 0);
+  g_assert_cmpuint (stats.commits, ==, 0);
+
+  gtk_widget_set_visible (surface, TRUE);
+  do {
+    g_main_context_iteration (NULL, TRUE);
+    phosh_layer_surface_get_frame_stats (PHOSH_LAYER_SURFACE (surface), &stats);
+  } while (stats.commits == 0);
+
+  g_assert_cmpuint (stats.frames, >=, stats.commits);
+  g_assert_cmpint (stats.layout_time, >=, stats.layout_time_max);
+  g_assert_cmpint (stats.paint_time, >=, stats.paint_time_max);
+
+  phosh_layer_surface_reset_frame_stats (PHOSH_LAYER_SURFACE (surface));
+  phosh_layer_surface_get_frame_stats (PHOSH_LAYER_SURFACE (surface), &stats);
+  g_assert_cmpuint (stats.frames, ==, 0);
+  g_assert_cmpuint (stats.commits, ==, 0);
+  g_assert_cmpint (stats.paint_time_max, ==, 0);
+
+  gtk_widget_destroy (surface);
+}
+
+
 int
 main (int   argc,
       char *argv[])
@@ -174,6 +216,7 @@ main (int   argc,
   PHOSH_COMPOSITOR_TEST_ADD ("/phosh/layer-surface/set_size", test_layer_surface_set_size);
   PHOSH_COMPOSITOR_TEST_ADD ("/phosh/layer-surface/set_kbd_interactivity",
                              test_layer_surface_set_kbd_interactivity);
+  PHOSH_COMPOSITOR_TEST_ADD ("/phosh/layer-surface/frame_stats", test_layer_surface_frame_stats);
 
   return g_test_run ();
 }
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#define G_LOG_DOMAIN "phosh-test-log"
+
+#include "log.h"
+
+#include <glib/gstdio.h>
+#include <unistd.h>
+
+
+static char *
+dump_ring (void)
+{
+  g_autofree char *path = NULL;
+  g_autoptr (GError) err = NULL;
+  char *contents;
+  int fd;
+
+  fd = g_file_open_tmp ("phosh-log-XXXXXX", &path, &err);
+  g_assert_no_error (err);
+  phosh_log_dump_ring (fd);
+  close (fd);
+
+  g_file_get_contents (path, &contents, NULL, &err);
+  g_assert_no_error (err);
+  g_unlink (path);
+
+  return contents;
+}
+
+
+static void
+test_phosh_log_ring (void)
+{
+  g_autofree char *contents = NULL;
+  g_auto (GStrv) lines = NULL;
+
+  /* Debug messages of disabled domains end up in the ring too */
+  phosh_log_set_log_domains ("phosh-other");
+  phosh_log_set_ring_size (3);
+
+  for (int i = 0; i < 5; i++)
+    g_debug ("message %d", i);
+
+  contents = dump_ring ();
+  lines = g_strsplit (contents, "\n", -1);
+
+  g_assert_cmpint (g_strv_length (lines), ==, 4);
+  g_assert_true (g_str_has_suffix (lines[0], "phosh-test-log-DEBUG: message 2"));
+  g_assert_true (g_str_has_suffix (lines[1], "phosh-test-log-DEBUG: message 3"));
+  g_assert_true (g_str_has_suffix (lines[2], "phosh-test-log-DEBUG: message 4"));
+  g_assert_cmpstr (lines[3], ==, "");
+
+  phosh_log_set_log_domains (NULL);
+}
+
+
+/* Depending on the level GLib writes to stdout or stderr, check a single stream */
+static void
+redirect_stdout_to_stderr (void)
+{
+  g_assert_cmpint (dup2 (STDERR_FILENO, STDOUT_FILENO), ==, STDOUT_FILENO);
+}
+
+
+static void
+test_phosh_log_domains_exact (void)
+{
+  /* Each test needs its own process as the log writer can only be set once */
+  if (g_test_subprocess ()) {
+    redirect_stdout_to_stderr ();
+    /* Neither prefixes nor extensions of a domain enable it */
+    phosh_log_set_log_domains ("phosh-test,phosh-test-log-other");
+    g_debug ("partial match");
+
+    phosh_log_set_log_domains ("phosh-test, phosh-test-log");
+    g_debug ("exact match");
+    return;
+  }
+  g_test_trap_subprocess (NULL, 0, 0);
+  g_test_trap_assert_passed ();
+  g_test_trap_assert_stderr ("*phosh-test-log-DEBUG*exact match*");
+  g_test_trap_assert_stderr_unmatched ("*partial match*");
+}
+
+
+static void
+test_phosh_log_domains_all (void)
+{
+  if (g_test_subprocess ()) {
+    redirect_stdout_to_stderr ();
+    phosh_log_set_log_domains ("all");
+    g_debug ("own domain");
+    g_log ("phosh-test-never-set", G_LOG_LEVEL_DEBUG, "other domain");
+    return;
+  }
+  g_test_trap_subprocess (NULL, 0, 0);
+  g_test_trap_assert_passed ();
+  g_test_trap_assert_stderr ("*phosh-test-log-DEBUG*own domain*");
+  g_test_trap_assert_stderr ("*phosh-test-never-set-DEBUG*other domain*");
+}
+
+
+static void
+test_phosh_log_domains_unknown (void)
+{
+  if (g_test_subprocess ()) {
+    redirect_stdout_to_stderr ();
+    phosh_log_set_log_domains ("phosh-test-other");
+    g_debug ("not enabled");
+    g_log ("phosh-test-never-set", G_LOG_LEVEL_DEBUG, "never set");
+    g_log (NULL, G_LOG_LEVEL_DEBUG, "no domain");
+
+    /* Domains stay known but get disabled again */
+    phosh_log_set_log_domains ("phosh-test-log");
+    phosh_log_set_log_domains ("phosh-test-other");
+    g_debug ("disabled again");
+
+    /* Other levels aren't filtered */
+    g_message ("a message");
+    return;
+  }
+  g_test_trap_subprocess (NULL, 0, 0);
+  g_test_trap_assert_passed ();
+  g_test_trap_assert_stderr_unmatched ("*DEBUG*");
+  g_test_trap_assert_stderr ("*phosh-test-log-Message*a message*");
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phosh/log/ring", test_phosh_log_ring);
+  g_test_add_func ("/phosh/log/domains/exact", test_phosh_log_domains_exact);
+  g_test_add_func ("/phosh/log/domains/all", test_phosh_log_domains_all);
+  g_test_add_func ("/phosh/log/domains/unknown", test_phosh_log_domains_unknown);
+
+  return g_test_run ();
+}
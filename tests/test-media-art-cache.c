@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "media-art-cache.h"
+
+#include <glib/gstdio.h>
+#include <unistd.h>
+
+
+typedef struct {
+  GMainLoop       *loop;
+  cairo_surface_t *surface;
+} FetchResult;
+
+
+static void
+on_fetch_ready (GObject *source_object, GAsyncResult *res, gpointer user_data)
+{
+  FetchResult *result = user_data;
+  g_autoptr (GError) err = NULL;
+
+  result->surface = phosh_media_art_cache_fetch_finish (PHOSH_MEDIA_ART_CACHE (source_object),
+                                                        res,
+                                                        &err);
+  g_assert_no_error (err);
+  g_main_loop_quit (result->loop);
+}
+
+
+static cairo_surface_t *
+fetch (const char *url, int scale)
+{
+  g_autoptr (GMainLoop) loop = g_main_loop_new (NULL, FALSE);
+  FetchResult result = { .loop = loop };
+
+  phosh_media_art_cache_fetch_async (phosh_media_art_cache_get_default (),
+                                     url,
+                                     48,
+                                     scale,
+                                     NULL,
+                                     on_fetch_ready,
+                                     &result);
+  g_main_loop_run (loop);
+
+  g_assert_nonnull (result.surface);
+  return result.surface;
+}
+
+
+static char *
+create_png (gsize *len)
+{
+  g_autoptr (GdkPixbuf) pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, FALSE, 8, 64, 32);
+  g_autoptr (GError) err = NULL;
+  char *buffer;
+
+  gdk_pixbuf_fill (pixbuf, 0xff0000ff);
+  gdk_pixbuf_save_to_buffer (pixbuf, &buffer, len, "png", &err, NULL);
+  g_assert_no_error (err);
+
+  return buffer;
+}
+
+
+static void
+test_phosh_media_art_cache_fetch (void)
+{
+  PhoshMediaArtCache *cache = phosh_media_art_cache_get_default ();
+  g_autofree char *png = NULL;
+  g_autofree char *base64 = NULL;
+  g_autofree char *url = NULL;
+  g_autofree char *path = NULL;
+  g_autofree char *file_url = NULL;
+  g_autoptr (GError) err = NULL;
+  cairo_surface_t *surface, *again, *scaled;
+  double x_scale, y_scale;
+  gsize len;
+  int fd;
+
+  png = create_png (&len);
+  base64 = g_base64_encode ((guchar *) png, len);
+  url = g_strdup_printf ("data:image/png;base64,%s", base64);
+
+  surface = fetch (url, 1);
+  g_assert_cmpint (cairo_image_surface_get_width (surface), ==, 48);
+  g_assert_cmpint (cairo_image_surface_get_height (surface), ==, 48);
+
+  /* Cached */
+  again = fetch (url, 1);
+  g_assert_true (again == surface);
+  cairo_surface_destroy (again);
+
+  /* Same content under a different URL */
+  fd = g_file_open_tmp ("phosh-art-XXXXXX.png", &path, &err);
+  g_assert_no_error (err);
+  close (fd);
+  g_file_set_contents (path, png, len, &err);
+  g_assert_no_error (err);
+  file_url = g_filename_to_uri (path, NULL, &err);
+  g_assert_no_error (err);
+  again = fetch (file_url, 1);
+  g_assert_true (again == surface);
+  cairo_surface_destroy (again);
+  g_unlink (path);
+
+  /* Different scale is a separate entry */
+  scaled = fetch (url, 2);
+  g_assert_true (scaled != surface);
+  g_assert_cmpint (cairo_image_surface_get_width (scaled), ==, 96);
+  cairo_surface_get_device_scale (scaled, &x_scale, &y_scale);
+  g_assert_cmpfloat (x_scale, ==, 2.0);
+  cairo_surface_destroy (scaled);
+
+  cairo_surface_destroy (surface);
+  phosh_media_art_cache_clear_all (cache);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phosh/media-art-cache/fetch", test_phosh_media_art_cache_fetch);
+
+  return g_test_run ();
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "memory-registry.h"
+
+
+typedef struct {
+  gsize  bytes;
+  guint  n_entries;
+  guint  shrink_order;
+} FakeCache;
+
+static guint shrink_count;
+
+
+static void
+get_memory_usage (gpointer owner, gsize *bytes, guint *n_entries)
+{
+  FakeCache *cache = owner;
+
+  *bytes = cache->bytes;
+  *n_entries = cache->n_entries;
+}
+
+
+static void
+shrink_memory (gpointer owner)
+{
+  FakeCache *cache = owner;
+
+  cache->bytes = 0;
+  cache->n_entries = 0;
+  cache->shrink_order = ++shrink_count;
+}
+
+
+static PhoshMemoryUsage *
+find_usage (GArray *usages, const char *name)
+{
+  for (guint i = 0; i < usages->len; i++) {
+    PhoshMemoryUsage *usage = &g_array_index (usages, PhoshMemoryUsage, i);
+
+    if (g_str_equal (usage->name, name))
+      return usage;
+  }
+
+  return NULL;
+}
+
+
+static void
+test_phosh_memory_registry_usage (void)
+{
+  g_autoptr (PhoshMemoryRegistry) registry = g_object_new (PHOSH_TYPE_MEMORY_REGISTRY, NULL);
+  FakeCache cache = { 1000, 2 };
+  FakeCache image1 = { 100, 1 };
+  FakeCache image2 = { 200, 1 };
+  g_autoptr (GArray) usages = NULL;
+  PhoshMemoryUsage *usage;
+
+  phosh_memory_registry_add (registry, "cache", PHOSH_MEMORY_PRIORITY_CACHE,
+                             &cache, get_memory_usage, shrink_memory);
+  phosh_memory_registry_add (registry, "images", PHOSH_MEMORY_PRIORITY_ACTIVE,
+                             &image1, get_memory_usage, NULL);
+  phosh_memory_registry_add (registry, "images", PHOSH_MEMORY_PRIORITY_ACTIVE,
+                             &image2, get_memory_usage, NULL);
+
+  usages = phosh_memory_registry_get_usage (registry);
+  g_assert_cmpint (usages->len, ==, 2);
+
+  usage = find_usage (usages, "cache");
+  g_assert_nonnull (usage);
+  g_assert_cmpint (usage->bytes, ==, 1000);
+  g_assert_cmpint (usage->n_entries, ==, 2);
+  g_assert_cmpint (usage->n_owners, ==, 1);
+  g_assert_cmpint (usage->priority, ==, PHOSH_MEMORY_PRIORITY_CACHE);
+
+  /* Owners with the same name are summed up */
+  usage = find_usage (usages, "images");
+  g_assert_nonnull (usage);
+  g_assert_cmpint (usage->bytes, ==, 300);
+  g_assert_cmpint (usage->n_entries, ==, 2);
+  g_assert_cmpint (usage->n_owners, ==, 2);
+  g_clear_pointer (&usages, g_array_unref);
+
+  phosh_memory_registry_remove (registry, &image1);
+  usages = phosh_memory_registry_get_usage (registry);
+  usage = find_usage (usages, "images");
+  g_assert_cmpint (usage->bytes, ==, 200);
+  g_assert_cmpint (usage->n_owners, ==, 1);
+}
+
+
+static void
+test_phosh_memory_registry_shrink (void)
+{
+  g_autoptr (PhoshMemoryRegistry) registry = g_object_new (PHOSH_TYPE_MEMORY_REGISTRY, NULL);
+  FakeCache active = { 10, 1 };
+  FakeCache inactive = { 20, 1 };
+  FakeCache cache = { 30, 1 };
+
+  shrink_count = 0;
+  /* Register in reverse order to check we shrink by priority */
+  phosh_memory_registry_add (registry, "active", PHOSH_MEMORY_PRIORITY_ACTIVE,
+                             &active, get_memory_usage, shrink_memory);
+  phosh_memory_registry_add (registry, "inactive", PHOSH_MEMORY_PRIORITY_INACTIVE,
+                             &inactive, get_memory_usage, shrink_memory);
+  phosh_memory_registry_add (registry, "cache", PHOSH_MEMORY_PRIORITY_CACHE,
+                             &cache, get_memory_usage, shrink_memory);
+
+  phosh_memory_registry_handle_warning (registry, G_MEMORY_MONITOR_WARNING_LEVEL_LOW);
+  g_assert_cmpint (cache.shrink_order, ==, 1);
+  g_assert_cmpint (cache.bytes, ==, 0);
+  g_assert_cmpint (inactive.shrink_order, ==, 0);
+  g_assert_cmpint (active.shrink_order, ==, 0);
+
+  phosh_memory_registry_handle_warning (registry, G_MEMORY_MONITOR_WARNING_LEVEL_MEDIUM);
+  g_assert_cmpint (cache.shrink_order, ==, 2);
+  g_assert_cmpint (inactive.shrink_order, ==, 3);
+  g_assert_cmpint (inactive.bytes, ==, 0);
+  g_assert_cmpint (active.shrink_order, ==, 0);
+  g_assert_cmpint (active.bytes, ==, 10);
+
+  phosh_memory_registry_handle_warning (registry, G_MEMORY_MONITOR_WARNING_LEVEL_CRITICAL);
+  g_assert_cmpint (cache.shrink_order, ==, 4);
+  g_assert_cmpint (inactive.shrink_order, ==, 5);
+  g_assert_cmpint (active.shrink_order, ==, 6);
+  g_assert_cmpint (active.bytes, ==, 0);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phosh/memory-registry/usage", test_phosh_memory_registry_usage);
+  g_test_add_func ("/phosh/memory-registry/shrink", test_phosh_memory_registry_shrink);
+
+  return g_test_run ();
+}
@@ -9,6 +9,66 @@
 #include "phosh-config.h"
 #include "plugin-loader.h"
 
+#include <glib/gstdio.h>
+
+#include <utime.h>
+
+
+#define CALENDAR_MODULE TEST_BUILD_DIR "/plugins/calendar/libphosh-plugin-calendar.so"
+
+/* A plugin info that doesn't match the manifest's Types */
+static const char *calendar_info =
+  "[Plugin]\n"
+  "Id=calendar\n"
+  "Types=quick-setting;\n"
+  "Plugin=" CALENDAR_MODULE "\n";
+
+
+static char *
+setup_manifest_dir (void)
+{
+  g_autoptr (GError) err = NULL;
+  g_autofree char *info_path = NULL;
+  g_autofree char *manifest_path = NULL;
+  g_autofree char *manifest = NULL;
+  GStatBuf st;
+  char *dir;
+
+  dir = g_dir_make_tmp ("phosh-test-plugin-loader.XXXXXX", &err);
+  g_assert_no_error (err);
+
+  info_path = g_build_filename (dir, "calendar.plugin", NULL);
+  g_file_set_contents (info_path, calendar_info, -1, &err);
+  g_assert_no_error (err);
+  g_assert_cmpint (g_stat (info_path, &st), ==, 0);
+
+  manifest = g_strdup_printf ("[calendar]\n"
+                              "Types=lockscreen;\n"
+                              "Plugin=" CALENDAR_MODULE "\n"
+                              "Info=calendar.plugin\n"
+                              "InfoSize=%" G_GSIZE_FORMAT "\n"
+                              "InfoMTime=%" G_GINT64_FORMAT "\n",
+                              strlen (calendar_info),
+                              (gint64) st.st_mtime);
+  manifest_path = g_build_filename (dir, "phosh-plugins.manifest", NULL);
+  g_file_set_contents (manifest_path, manifest, -1, &err);
+  g_assert_no_error (err);
+
+  return dir;
+}
+
+
+static void
+teardown_manifest_dir (const char *dir)
+{
+  g_autofree char *info_path = g_build_filename (dir, "calendar.plugin", NULL);
+  g_autofree char *manifest_path = g_build_filename (dir, "phosh-plugins.manifest", NULL);
+
+  g_assert_cmpint (g_unlink (info_path), ==, 0);
+  g_assert_cmpint (g_unlink (manifest_path), ==, 0);
+  g_assert_cmpint (g_rmdir (dir), ==, 0);
+}
+
 static void
 test_plugin_loader_new (void)
 {
@@ -50,11 +110,17 @@ test_plugin_loader_load (void)
 
   plugin_loader = phosh_plugin_loader_new ((GStrv)dirs, PHOSH_EXTENSION_POINT_LOCKSCREEN_WIDGET);
   g_assert_true (PHOSH_IS_PLUGIN_LOADER (plugin_loader));
+  g_assert_cmpint (phosh_plugin_loader_get_load_time (plugin_loader, "calendar"), ==, -1);
+
+  /* Unknown plugins are remembered, looking them up again is cheap */
+  g_assert_null (phosh_plugin_loader_load_plugin (plugin_loader, "doesnotexist"));
+  g_assert_null (phosh_plugin_loader_load_plugin (plugin_loader, "doesnotexist"));
 
 #ifndef PHOSH_USES_ASAN
   widget = phosh_plugin_loader_load_plugin (plugin_loader, "calendar");
   g_assert_true (GTK_IS_WIDGET (widget));
   g_object_ref_sink (widget);
+  g_assert_cmpint (phosh_plugin_loader_get_load_time (plugin_loader, "calendar"), >=, 0);
 
   gtk_widget_destroy (widget);
 #endif
@@ -62,6 +128,101 @@ test_plugin_loader_load (void)
 }
 
 
+static void
+test_plugin_loader_manifest (void)
+{
+  /* Loaded modules can't go away so use a fresh process */
+  if (g_test_subprocess ()) {
+    g_autofree char *dir = setup_manifest_dir ();
+    const char *dirs[] = { dir, NULL };
+    PhoshPluginLoader *plugin_loader;
+    GtkWidget *widget;
+
+    /* The manifest lists calendar as lockscreen plugin, the plugin info doesn't */
+    plugin_loader = phosh_plugin_loader_new ((GStrv)dirs, PHOSH_EXTENSION_POINT_LOCKSCREEN_WIDGET);
+    widget = phosh_plugin_loader_load_plugin (plugin_loader, "calendar");
+    g_assert_true (GTK_IS_WIDGET (widget));
+    g_object_ref_sink (widget);
+    gtk_widget_destroy (widget);
+    g_object_unref (widget);
+
+    g_assert_finalize_object (plugin_loader);
+    teardown_manifest_dir (dir);
+    return;
+  }
+#ifdef PHOSH_USES_ASAN
+  g_test_skip ("Modules can't be loaded with ASAN");
+  return;
+#endif
+  g_test_trap_subprocess (NULL, 0, G_TEST_SUBPROCESS_INHERIT_STDERR);
+  g_test_trap_assert_passed ();
+}
+
+
+static void
+test_plugin_loader_manifest_stale (void)
+{
+  /* Use a fresh process so no plugin info is cached */
+  if (g_test_subprocess ()) {
+    g_autofree char *dir = setup_manifest_dir ();
+    g_autofree char *info_path = g_build_filename (dir, "calendar.plugin", NULL);
+    g_autofree char *info = g_strconcat (calendar_info, "Name=Calendar\n", NULL);
+    const char *dirs[] = { dir, NULL };
+    g_autoptr (GError) err = NULL;
+    PhoshPluginLoader *plugin_loader;
+    GtkWidget *widget;
+
+    /* Plugin info changed after the manifest was generated */
+    g_file_set_contents (info_path, info, -1, &err);
+    g_assert_no_error (err);
+
+    /* So the plugin info is used which doesn't list calendar as lockscreen plugin */
+    plugin_loader = phosh_plugin_loader_new ((GStrv)dirs, PHOSH_EXTENSION_POINT_LOCKSCREEN_WIDGET);
+    widget = phosh_plugin_loader_load_plugin (plugin_loader, "calendar");
+    g_assert_null (widget);
+
+    g_assert_finalize_object (plugin_loader);
+    teardown_manifest_dir (dir);
+    return;
+  }
+  g_test_trap_subprocess (NULL, 0, G_TEST_SUBPROCESS_INHERIT_STDERR);
+  g_test_trap_assert_passed ();
+}
+
+
+static void
+test_plugin_loader_manifest_stale_mtime (void)
+{
+  /* Use a fresh process so no plugin info is cached */
+  if (g_test_subprocess ()) {
+    g_autofree char *dir = setup_manifest_dir ();
+    g_autofree char *info_path = g_build_filename (dir, "calendar.plugin", NULL);
+    const char *dirs[] = { dir, NULL };
+    struct utimbuf times;
+    PhoshPluginLoader *plugin_loader;
+    GStatBuf st;
+    GtkWidget *widget;
+
+    /* Plugin info got replaced by one of the same size after the manifest was generated */
+    g_assert_cmpint (g_stat (info_path, &st), ==, 0);
+    times.actime = st.st_atime;
+    times.modtime = st.st_mtime + 1;
+    g_assert_cmpint (g_utime (info_path, &times), ==, 0);
+
+    /* So the plugin info is used which doesn't list calendar as lockscreen plugin */
+    plugin_loader = phosh_plugin_loader_new ((GStrv)dirs, PHOSH_EXTENSION_POINT_LOCKSCREEN_WIDGET);
+    widget = phosh_plugin_loader_load_plugin (plugin_loader, "calendar");
+    g_assert_null (widget);
+
+    g_assert_finalize_object (plugin_loader);
+    teardown_manifest_dir (dir);
+    return;
+  }
+  g_test_trap_subprocess (NULL, 0, G_TEST_SUBPROCESS_INHERIT_STDERR);
+  g_test_trap_assert_passed ();
+}
+
+
 int
 main (int   argc,
       char *argv[])
@@ -70,6 +231,9 @@ main (int   argc,
 
   g_test_add_func("/phosh/plugin-loader/new", test_plugin_loader_new);
   g_test_add_func("/phosh/plugin-loader/load", test_plugin_loader_load);
+  g_test_add_func("/phosh/plugin-loader/manifest", test_plugin_loader_manifest);
+  g_test_add_func("/phosh/plugin-loader/manifest-stale", test_plugin_loader_manifest_stale);
+  g_test_add_func("/phosh/plugin-loader/manifest-stale-mtime", test_plugin_loader_manifest_stale_mtime);
 
   return g_test_run();
 }
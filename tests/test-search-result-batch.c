@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 The Phosh Developers
+ *
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include "search/search-result-batch.c"
+
+
+static GPtrArray *
+make_results (guint n, const char *prefix)
+{
+  GPtrArray *results = g_ptr_array_new_with_free_func ((GDestroyNotify) phosh_search_result_meta_unref);
+  g_autoptr (GIcon) icon = g_themed_icon_new ("start-here");
+
+  for (guint i = 0; i < n; i++) {
+    g_autofree char *id = g_strdup_printf ("%s-%u", prefix, i);
+    g_autofree char *title = g_strdup_printf ("Title %u", i);
+
+    g_ptr_array_add (results, phosh_search_result_meta_new (id, title, NULL, icon, NULL));
+  }
+
+  return results;
+}
+
+
+static void
+assert_results_equal (GPtrArray *a, GPtrArray *b)
+{
+  g_assert_cmpint (a->len, ==, b->len);
+
+  for (guint i = 0; i < a->len; i++)
+    g_assert_true (meta_equal (g_ptr_array_index (a, i), g_ptr_array_index (b, i)));
+}
+
+
+static void
+test_phosh_search_result_batch_full (void)
+{
+  g_autoptr (GPtrArray) results = make_results (5, "full");
+  g_autoptr (GPtrArray) decoded = NULL;
+  g_autoptr (GBytes) batch = NULL;
+  g_autoptr (GError) err = NULL;
+  guint serial = 0, base_serial = 1;
+
+  batch = phosh_search_result_batch_encode (NULL, 0, results, 3);
+  g_assert_true (phosh_search_result_batch_get_serials (batch, &serial, &base_serial));
+  g_assert_cmpuint (serial, ==, 3);
+  g_assert_cmpuint (base_serial, ==, 0);
+
+  serial = 0;
+  decoded = phosh_search_result_batch_decode (batch, NULL, 0, &serial, &err);
+  g_assert_no_error (err);
+  g_assert_cmpuint (serial, ==, 3);
+  assert_results_equal (results, decoded);
+  /* Icon is interned and parsed once */
+  g_assert_true (phosh_search_result_meta_get_icon (g_ptr_array_index (decoded, 0)) ==
+                 phosh_search_result_meta_get_icon (g_ptr_array_index (decoded, 4)));
+}
+
+
+static void
+test_phosh_search_result_batch_diff (void)
+{
+  g_autoptr (GPtrArray) base = make_results (4, "diff");
+  g_autoptr (GPtrArray) results = NULL;
+  g_autoptr (GPtrArray) decoded = NULL;
+  g_autoptr (GBytes) full = NULL;
+  g_autoptr (GBytes) batch = NULL;
+  g_autoptr (GError) err = NULL;
+
+  /* Drop the first row, keep two unchanged and add a new one */
+  results = g_ptr_array_new_with_free_func ((GDestroyNotify) phosh_search_result_meta_unref);
+  g_ptr_array_add (results, phosh_search_result_meta_ref (g_ptr_array_index (base, 1)));
+  g_ptr_array_add (results, phosh_search_result_meta_ref (g_ptr_array_index (base, 2)));
+  g_ptr_array_add (results, phosh_search_result_meta_new ("new", "New", "Desc", NULL, "copy"));
+
+  full = phosh_search_result_batch_encode (NULL, 0, results, 2);
+  batch = phosh_search_result_batch_encode (base, 1, results, 2);
+  g_assert_cmpuint (g_bytes_get_size (batch), <, g_bytes_get_size (full));
+
+  decoded = phosh_search_result_batch_decode (batch, base, 1, NULL, &err);
+  g_assert_no_error (err);
+  assert_results_equal (results, decoded);
+  /* Moved rows are shared with the base */
+  g_assert_true (g_ptr_array_index (decoded, 0) == g_ptr_array_index (base, 1));
+
+  /* Unchanged rows aren't sent at all */
+  g_clear_pointer (&batch, g_bytes_unref);
+  batch = phosh_search_result_batch_encode (base, 1, base, 2);
+  g_assert_cmpuint (g_bytes_get_size (batch), ==, sizeof (BatchHeader));
+}
+
+
+static void
+test_phosh_search_result_batch_stale (void)
+{
+  g_autoptr (GPtrArray) base = make_results (2, "stale");
+  g_autoptr (GPtrArray) results = make_results (3, "stale");
+  g_autoptr (GPtrArray) decoded = NULL;
+  g_autoptr (GBytes) batch = NULL;
+  g_autoptr (GError) err = NULL;
+
+  batch = phosh_search_result_batch_encode (base, 1, results, 2);
+
+  decoded = phosh_search_result_batch_decode (batch, base, 5, NULL, &err);
+  g_assert_error (err, PHOSH_SEARCH_RESULT_BATCH_ERROR, PHOSH_SEARCH_RESULT_BATCH_ERROR_STALE);
+  g_assert_null (decoded);
+  g_clear_error (&err);
+
+  decoded = phosh_search_result_batch_decode (batch, NULL, 0, NULL, &err);
+  g_assert_error (err, PHOSH_SEARCH_RESULT_BATCH_ERROR, PHOSH_SEARCH_RESULT_BATCH_ERROR_STALE);
+  g_assert_null (decoded);
+}
+
+
+static void
+test_phosh_search_result_batch_invalid (void)
+{
+  g_autoptr (GPtrArray) results = make_results (2, "invalid");
+  g_autoptr (GPtrArray) decoded = NULL;
+  g_autoptr (GBytes) batch = NULL;
+  g_autoptr (GBytes) truncated = NULL;
+  g_autoptr (GError) err = NULL;
+
+  batch = phosh_search_result_batch_encode (NULL, 0, results, 1);
+  truncated = g_bytes_new_from_bytes (batch, 0, g_bytes_get_size (batch) - 1);
+
+  g_assert_false (phosh_search_result_batch_get_serials (truncated, NULL, NULL));
+  decoded = phosh_search_result_batch_decode (truncated, NULL, 0, NULL, &err);
+  g_assert_error (err, PHOSH_SEARCH_RESULT_BATCH_ERROR, PHOSH_SEARCH_RESULT_BATCH_ERROR_INVALID);
+  g_assert_null (decoded);
+}
+
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/phosh/search-result-batch/full",
+                   test_phosh_search_result_batch_full);
+  g_test_add_func ("/phosh/search-result-batch/diff",
+                   test_phosh_search_result_batch_diff);
+  g_test_add_func ("/phosh/search-result-batch/stale",
+                   test_phosh_search_result_batch_stale);
+  g_test_add_func ("/phosh/search-result-batch/invalid",
+                   test_phosh_search_result_batch_invalid);
+
+  return g_test_run ();
+}
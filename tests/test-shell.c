@@ -150,6 +150,54 @@ test_shell_new (PhoshTestCompositorFixture *fixture, gconstpointer unused)
 }
 
 
+static gboolean
+all_startup_stages_done (PhoshShell *shell)
+{
+  g_auto (GStrv) stages = phosh_shell_get_startup_stages (shell);
+
+  for (int i = 0; stages[i]; i++) {
+    if (phosh_shell_get_startup_stage_time (shell, stages[i]) < 0)
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+static void
+test_shell_startup_stages (PhoshTestCompositorFixture *fixture, gconstpointer unused)
+{
+  PhoshShell *shell;
+  GLogLevelFlags flags;
+  g_auto (GStrv) stages = NULL;
+  gboolean ready = FALSE;
+
+  shell = phosh_test_get_shell (&flags);
+  phosh_shell_set_default (shell);
+
+  stages = phosh_shell_get_startup_stages (shell);
+  g_assert_cmpstr (stages[0], ==, "core");
+  g_assert_cmpint (phosh_shell_get_startup_stage_time (shell, "does-not-exist"), ==, -1);
+
+  g_signal_connect (shell, "ready", G_CALLBACK (on_shell_ready), &ready);
+  while (!ready)
+    g_main_context_iteration (NULL, TRUE);
+
+  /* Stages needed for the lock screen are set up right away */
+  g_assert_cmpint (phosh_shell_get_startup_stage_time (shell, "core"), >=, 0);
+  g_assert_cmpint (phosh_shell_get_startup_stage_time (shell, "panels"), >=, 0);
+
+  /* The rest gets set up in idle */
+  while (!all_startup_stages_done (shell))
+    g_main_context_iteration (NULL, TRUE);
+
+  g_log_set_always_fatal (flags);
+  g_assert_finalize_object (shell);
+
+  phosh_test_drain_events ();
+}
+
+
 static void
 test_shell_new_two_outputs (PhoshTestCompositorFixture *fixture, gconstpointer unused)
 {
@@ -196,6 +244,8 @@ main (int argc, char *argv[])
 
   g_test_add ("/phosh/shell/new", PhoshTestCompositorFixture, NULL,
               compositor_setup, test_shell_new, compositor_teardown);
+  g_test_add ("/phosh/shell/startup-stages", PhoshTestCompositorFixture, NULL,
+              compositor_setup, test_shell_startup_stages, compositor_teardown);
   g_test_add ("/phosh/shell/dualhead", PhoshTestCompositorFixture, NULL,
               compositor_setup_dualhead, test_shell_new_two_outputs, compositor_teardown);
 